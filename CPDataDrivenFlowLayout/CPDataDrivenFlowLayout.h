@@ -9,10 +9,21 @@
 #ifndef CPDataDrivenFlowLayout_h
 #define CPDataDrivenFlowLayout_h
 
+#import "CPCollectionViewCellDescriptor.h"
+#import "CPCollectionViewSupplementaryViewDescriptor.h"
 #import "CPCollectionViewCellInfo.h"
 #import "CPCollectionViewSectionInfo.h"
+#import "CPCollectionViewLazySectionInfo.h"
+#import "CPCollectionViewSnapshot.h"
 #import "UICollectionView+CPDataDrivenFlowLayout.h"
 
+#import "CPReusableViewPrewarmer.h"
 #import "UICollectionView+CPTemplateLayoutCell.h"
 
+#import "CPFlowLayoutEngine.h"
+#import "CPDataDrivenLayout.h"
+
+#import "CPCollectionViewMetrics.h"
+#import "UICollectionView+CPMetrics.h"
+
 #endif /* CPDataDrivenFlowLayout_h */
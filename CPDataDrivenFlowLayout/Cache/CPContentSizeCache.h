@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+#import "CPIndexPathSizeCache.h"
+#import "CPPersistentSizeStore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ 按内容缓存的尺寸，key由reuseIdentifier、调用方提供的内容指纹、preferredLayoutDimension及preferredLayoutValue组成
+ 相同内容的cell无论位于哪个indexPath、是否被reload，都只计算一次；超出countLimit或costLimit时按LRU淘汰 (线程安全)
+ */
+@interface CPContentSizeCache : NSObject
+
+@property (nonatomic) NSUInteger countLimit;//The default value of this property is 2000, 0 means no limit
+@property (nonatomic) NSUInteger costLimit;//approximate memory cap in bytes. The default value of this property is 512KB, 0 means no limit
+
+@property (nonatomic, strong, nullable) CPPersistentSizeStore *persistentStore;//optional second level, looked up on miss and written on cache. removeAllSizes and memory warnings do not clear it
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) NSUInteger totalCost;
+
+#pragma mark - Statistics
+
+@property (nonatomic, readonly) NSUInteger hitCount;
+@property (nonatomic, readonly) NSUInteger missCount;
+@property (nonatomic, readonly) NSUInteger evictionCount;
+
+- (void)resetStatistics;
+
+#pragma mark - Get And Set Size
+
+- (BOOL)getSize:(CGSize *)size
+forReuseIdentifier:(NSString *)reuseIdentifier
+contentFingerprint:(NSString *)contentFingerprint
+preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+preferredLayoutValue:(CGFloat)preferredLayoutValue;//return NO if not exists
+
+- (void)cacheSize:(CGSize)size
+forReuseIdentifier:(NSString *)reuseIdentifier
+contentFingerprint:(NSString *)contentFingerprint
+preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+preferredLayoutValue:(CGFloat)preferredLayoutValue;
+
+#pragma mark - Invalidate
+
+- (void)removeAllSizes;
+
+@end
+
+NS_ASSUME_NONNULL_END
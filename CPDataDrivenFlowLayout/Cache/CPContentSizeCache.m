@@ -0,0 +1,250 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPContentSizeCache.h"
+#import <pthread.h>
+
+static const NSUInteger _CPContentSizeCacheEntryOverhead = 64;//node, dictionary slot and NSValue
+
+@interface _CPContentSizeCacheNode : NSObject {
+    @package
+    __unsafe_unretained _CPContentSizeCacheNode *_prev;
+    _CPContentSizeCacheNode *_next;
+    NSString *_key;
+    CGSize _size;
+    NSUInteger _cost;
+}
+@end
+
+@implementation _CPContentSizeCacheNode
+@end
+
+
+@interface CPContentSizeCache () {
+    pthread_mutex_t _lock;
+    NSMutableDictionary<NSString *, _CPContentSizeCacheNode *> *_nodesByKey;
+    _CPContentSizeCacheNode *_head;//most recently used
+    _CPContentSizeCacheNode *_tail;//least recently used
+    NSUInteger _totalCost;
+}
+
+@end
+
+@implementation CPContentSizeCache
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        pthread_mutex_init(&_lock, NULL);
+        _nodesByKey = [NSMutableDictionary new];
+        _countLimit = 2000;
+        _costLimit = 512 * 1024;
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(removeAllSizes) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    pthread_mutex_destroy(&_lock);
+}
+
+#pragma mark - Getter And Setter
+
+- (CPPersistentSizeStore *)persistentStore {
+    pthread_mutex_lock(&_lock);
+    CPPersistentSizeStore *persistentStore = _persistentStore;
+    pthread_mutex_unlock(&_lock);
+    
+    return persistentStore;
+}
+
+- (void)setPersistentStore:(CPPersistentSizeStore *)persistentStore {
+    pthread_mutex_lock(&_lock);
+    _persistentStore = persistentStore;
+    pthread_mutex_unlock(&_lock);
+}
+
+- (NSUInteger)count {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _nodesByKey.count;
+    pthread_mutex_unlock(&_lock);
+    
+    return count;
+}
+
+- (NSUInteger)totalCost {
+    pthread_mutex_lock(&_lock);
+    NSUInteger totalCost = _totalCost;
+    pthread_mutex_unlock(&_lock);
+    
+    return totalCost;
+}
+
+- (void)setCountLimit:(NSUInteger)countLimit {
+    pthread_mutex_lock(&_lock);
+    _countLimit = countLimit;
+    [self trimToLimits];
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)setCostLimit:(NSUInteger)costLimit {
+    pthread_mutex_lock(&_lock);
+    _costLimit = costLimit;
+    [self trimToLimits];
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark - Statistics
+
+- (void)resetStatistics {
+    pthread_mutex_lock(&_lock);
+    _hitCount = 0;
+    _missCount = 0;
+    _evictionCount = 0;
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark - Get And Set Size
+
+- (BOOL)getSize:(CGSize *)size forReuseIdentifier:(NSString *)reuseIdentifier contentFingerprint:(NSString *)contentFingerprint preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    NSString *key = [self keyForReuseIdentifier:reuseIdentifier contentFingerprint:contentFingerprint preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+    
+    pthread_mutex_lock(&_lock);
+    _CPContentSizeCacheNode *node = _nodesByKey[key];
+    CGSize persistentSize;
+    if (node) {
+        _hitCount++;
+        [self bringNodeToHead:node];
+        if (size) {
+            *size = node->_size;
+        }
+    } else if ([_persistentStore getSize:&persistentSize forReuseIdentifier:reuseIdentifier contentFingerprint:contentFingerprint preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue]) {
+        //measured in an earlier launch
+        _hitCount++;
+        node = [self insertNodeWithKey:key size:persistentSize];
+        if (size) {
+            *size = persistentSize;
+        }
+    } else {
+        _missCount++;
+    }
+    pthread_mutex_unlock(&_lock);
+    
+    return node != nil;
+}
+
+- (void)cacheSize:(CGSize)size forReuseIdentifier:(NSString *)reuseIdentifier contentFingerprint:(NSString *)contentFingerprint preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    NSString *key = [self keyForReuseIdentifier:reuseIdentifier contentFingerprint:contentFingerprint preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+    
+    pthread_mutex_lock(&_lock);
+    _CPContentSizeCacheNode *node = _nodesByKey[key];
+    if (node) {
+        node->_size = size;
+        [self bringNodeToHead:node];
+    } else {
+        [self insertNodeWithKey:key size:size];
+    }
+    CPPersistentSizeStore *persistentStore = _persistentStore;
+    pthread_mutex_unlock(&_lock);
+    
+    [persistentStore storeSize:size forReuseIdentifier:reuseIdentifier contentFingerprint:contentFingerprint preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+}
+
+#pragma mark - Invalidate
+
+- (void)removeAllSizes {
+    pthread_mutex_lock(&_lock);
+    [_nodesByKey removeAllObjects];
+    _head = nil;
+    _tail = nil;
+    _totalCost = 0;
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark - Private
+
+- (NSString *)keyForReuseIdentifier:(NSString *)reuseIdentifier contentFingerprint:(NSString *)contentFingerprint preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    return [NSString stringWithFormat:@"%@/%@/%ld/%.3f", reuseIdentifier, contentFingerprint, (long)preferredLayoutDimension, preferredLayoutValue];
+}
+
+- (_CPContentSizeCacheNode *)insertNodeWithKey:(NSString *)key size:(CGSize)size {//must be called with lock held
+    _CPContentSizeCacheNode *node = [_CPContentSizeCacheNode new];
+    node->_key = key;
+    node->_size = size;
+    node->_cost = key.length * sizeof(unichar) + sizeof(CGSize) + _CPContentSizeCacheEntryOverhead;
+    _nodesByKey[key] = node;
+    _totalCost += node->_cost;
+    [self insertNodeAtHead:node];
+    [self trimToLimits];
+    
+    return node;
+}
+
+- (void)trimToLimits {//must be called with lock held
+    while (_tail && ((_countLimit > 0 && _nodesByKey.count > _countLimit) || (_costLimit > 0 && _totalCost > _costLimit))) {
+        _CPContentSizeCacheNode *node = _tail;
+        [self removeNode:node];
+        [_nodesByKey removeObjectForKey:node->_key];
+        _totalCost -= node->_cost;
+        _evictionCount++;
+    }
+}
+
+- (void)insertNodeAtHead:(_CPContentSizeCacheNode *)node {
+    node->_prev = nil;
+    node->_next = _head;
+    if (_head) {
+        _head->_prev = node;
+    }
+    _head = node;
+    if (!_tail) {
+        _tail = node;
+    }
+}
+
+- (void)bringNodeToHead:(_CPContentSizeCacheNode *)node {
+    if (_head == node) {
+        return;
+    }
+    [self removeNode:node];
+    [self insertNodeAtHead:node];
+}
+
+- (void)removeNode:(_CPContentSizeCacheNode *)node {
+    if (node->_prev) {
+        node->_prev->_next = node->_next;
+    } else {
+        _head = node->_next;
+    }
+    if (node->_next) {
+        node->_next->_prev = node->_prev;
+    } else {
+        _tail = node->_prev;
+    }
+    node->_prev = nil;
+    node->_next = nil;
+}
+
+@end
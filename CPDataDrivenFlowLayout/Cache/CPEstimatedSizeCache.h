@@ -0,0 +1,48 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+#import "CPIndexPathSizeCache.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ 预估尺寸，按reuseIdentifier、preferredLayoutDimension及preferredLayoutValue保存已精确计算尺寸的平均值 (仅限主线程)
+ */
+@interface CPEstimatedSizeCache : NSObject
+
+- (BOOL)getEstimatedSize:(CGSize *)size
+      forReuseIdentifier:(NSString *)reuseIdentifier
+preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+    preferredLayoutValue:(CGFloat)preferredLayoutValue;//return NO if no size has been measured
+
+- (void)addMeasuredSize:(CGSize)size
+     forReuseIdentifier:(NSString *)reuseIdentifier
+preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+   preferredLayoutValue:(CGFloat)preferredLayoutValue;
+
+- (void)removeAllSizes;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,92 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPEstimatedSizeCache.h"
+
+@interface _CPEstimatedSizeSample : NSObject {
+    @package
+    double _totalWidth;
+    double _totalHeight;
+    NSUInteger _count;
+}
+@end
+
+@implementation _CPEstimatedSizeSample
+@end
+
+
+@interface CPEstimatedSizeCache () {
+    NSMutableDictionary<NSString *, _CPEstimatedSizeSample *> *_samplesByKey;
+}
+
+@end
+
+@implementation CPEstimatedSizeCache
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _samplesByKey = [NSMutableDictionary new];
+    }
+    
+    return self;
+}
+
+#pragma mark - Get And Add Size
+
+- (BOOL)getEstimatedSize:(CGSize *)size forReuseIdentifier:(NSString *)reuseIdentifier preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    _CPEstimatedSizeSample *sample = _samplesByKey[[self keyForReuseIdentifier:reuseIdentifier preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue]];
+    if (!sample) {
+        return NO;
+    }
+    
+    if (size) {
+        *size = CGSizeMake(sample->_totalWidth / sample->_count, sample->_totalHeight / sample->_count);
+    }
+    
+    return YES;
+}
+
+- (void)addMeasuredSize:(CGSize)size forReuseIdentifier:(NSString *)reuseIdentifier preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    NSString *key = [self keyForReuseIdentifier:reuseIdentifier preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+    _CPEstimatedSizeSample *sample = _samplesByKey[key];
+    if (!sample) {
+        sample = [_CPEstimatedSizeSample new];
+        _samplesByKey[key] = sample;
+    }
+    
+    sample->_totalWidth += size.width;
+    sample->_totalHeight += size.height;
+    sample->_count++;
+}
+
+- (void)removeAllSizes {
+    [_samplesByKey removeAllObjects];
+}
+
+#pragma mark - Private
+
+- (NSString *)keyForReuseIdentifier:(NSString *)reuseIdentifier preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    return [NSString stringWithFormat:@"%@/%ld/%.3f", reuseIdentifier, (long)preferredLayoutDimension, preferredLayoutValue];
+}
+
+@end
@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+typedef NS_ENUM(NSInteger, CPPreferredLayoutDimension) {
+    CPPreferredLayoutDimensionWidth = 0,
+    CPPreferredLayoutDimensionHeight
+};
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ 按indexPath缓存cell尺寸，每个indexPath按preferredLayoutDimension及preferredLayoutValue分别缓存
+ */
+@interface CPIndexPathSizeCache : NSObject
+
+#pragma mark - Get And Set Size
+
+- (BOOL)existsSizeAtIndexPath:(NSIndexPath *)indexPath
+     preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+         preferredLayoutValue:(CGFloat)preferredLayoutValue;
+
+- (CGSize)sizeForIndexPath:(NSIndexPath *)indexPath
+  preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+      preferredLayoutValue:(CGFloat)preferredLayoutValue;//return CGSizeZero if not exists
+
+- (void)cacheSize:(CGSize)size
+      byIndexPath:(NSIndexPath *)indexPath
+preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+preferredLayoutValue:(CGFloat)preferredLayoutValue;
+
+#pragma mark - Invalidate
+
+- (void)invalidateSizeAtIndexPath:(NSIndexPath *)indexPath;
+- (void)invalidateAllSizeCache;
+
+#pragma mark - Sections
+
+- (void)insertSections:(NSIndexSet *)sections;
+- (void)deleteSections:(NSIndexSet *)sections;
+- (void)reloadSections:(NSIndexSet *)sections;
+
+#pragma mark - Items
+
+- (void)insertItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+- (void)deleteItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+- (void)reloadItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+
+@end
+
+NS_ASSUME_NONNULL_END
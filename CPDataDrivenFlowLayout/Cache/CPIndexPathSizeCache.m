@@ -0,0 +1,218 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPIndexPathSizeCache.h"
+
+typedef NSMutableDictionary<NSNumber *, NSValue *> CPSizesByPreferredLayoutValue;
+typedef NSMutableArray<NSMutableArray<id> *> CPSizesBySection;//item slot is CPSizesByPreferredLayoutValue or NSNull
+
+@interface CPIndexPathSizeCache ()
+
+@property (nonatomic) CPSizesBySection *sizesBySectionForPreferredWidth;
+@property (nonatomic) CPSizesBySection *sizesBySectionForPreferredHeight;
+
+@end
+
+@implementation CPIndexPathSizeCache
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _sizesBySectionForPreferredWidth = [NSMutableArray new];
+        _sizesBySectionForPreferredHeight = [NSMutableArray new];
+    }
+    
+    return self;
+}
+
+#pragma mark - Get And Set Size
+
+- (BOOL)existsSizeAtIndexPath:(NSIndexPath *)indexPath preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    return [self sizeValueForIndexPath:indexPath preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue] != nil;
+}
+
+- (CGSize)sizeForIndexPath:(NSIndexPath *)indexPath preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    NSValue *sizeValue = [self sizeValueForIndexPath:indexPath preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+    if (sizeValue) {
+        return [sizeValue CGSizeValue];
+    }
+    
+    return CGSizeZero;
+}
+
+- (void)cacheSize:(CGSize)size byIndexPath:(NSIndexPath *)indexPath preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    if (!indexPath) {
+        return;
+    }
+    
+    CPSizesBySection *sizesBySection = [self sizesBySectionForPreferredLayoutDimension:preferredLayoutDimension];
+    [self buildCachesAtIndexPathIfNeeded:indexPath inSizesBySection:sizesBySection];
+    
+    NSMutableArray *sizesByItem = sizesBySection[indexPath.section];
+    id slot = sizesByItem[indexPath.item];
+    if (slot == [NSNull null]) {
+        slot = [CPSizesByPreferredLayoutValue new];
+        sizesByItem[indexPath.item] = slot;
+    }
+    ((CPSizesByPreferredLayoutValue *)slot)[@(preferredLayoutValue)] = [NSValue valueWithCGSize:size];
+}
+
+- (nullable NSValue *)sizeValueForIndexPath:(NSIndexPath *)indexPath preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    if (!indexPath) {
+        return nil;
+    }
+    
+    CPSizesBySection *sizesBySection = [self sizesBySectionForPreferredLayoutDimension:preferredLayoutDimension];
+    if (indexPath.section >= sizesBySection.count) {
+        return nil;
+    }
+    
+    NSMutableArray *sizesByItem = sizesBySection[indexPath.section];
+    if (indexPath.item >= sizesByItem.count) {
+        return nil;
+    }
+    
+    id slot = sizesByItem[indexPath.item];
+    if (slot == [NSNull null]) {
+        return nil;
+    }
+    
+    return ((CPSizesByPreferredLayoutValue *)slot)[@(preferredLayoutValue)];
+}
+
+#pragma mark - Invalidate
+
+- (void)invalidateSizeAtIndexPath:(NSIndexPath *)indexPath {
+    [self enumerateAllSizesBySectionUsingBlock:^(CPSizesBySection *sizesBySection) {
+        if (indexPath.section < sizesBySection.count) {
+            NSMutableArray *sizesByItem = sizesBySection[indexPath.section];
+            if (indexPath.item < sizesByItem.count) {
+                sizesByItem[indexPath.item] = [NSNull null];
+            }
+        }
+    }];
+}
+
+- (void)invalidateAllSizeCache {
+    [self enumerateAllSizesBySectionUsingBlock:^(CPSizesBySection *sizesBySection) {
+        [sizesBySection removeAllObjects];
+    }];
+}
+
+#pragma mark - Sections
+
+- (void)insertSections:(NSIndexSet *)sections {
+    [self enumerateAllSizesBySectionUsingBlock:^(CPSizesBySection *sizesBySection) {
+        //indexes refer to the positions after insertion, so insert in ascending order
+        [sections enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+            if (section > sizesBySection.count) {
+                //nothing cached beyond this section, no need to shift
+                *stop = YES;
+                return;
+            }
+            [sizesBySection insertObject:[NSMutableArray new] atIndex:section];
+        }];
+    }];
+}
+
+- (void)deleteSections:(NSIndexSet *)sections {
+    [self enumerateAllSizesBySectionUsingBlock:^(CPSizesBySection *sizesBySection) {
+        //indexes refer to the positions before deletion, so delete in descending order
+        [sections enumerateIndexesWithOptions:NSEnumerationReverse usingBlock:^(NSUInteger section, BOOL *stop) {
+            if (section < sizesBySection.count) {
+                [sizesBySection removeObjectAtIndex:section];
+            }
+        }];
+    }];
+}
+
+- (void)reloadSections:(NSIndexSet *)sections {
+    [self enumerateAllSizesBySectionUsingBlock:^(CPSizesBySection *sizesBySection) {
+        [sections enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+            if (section < sizesBySection.count) {
+                [sizesBySection[section] removeAllObjects];
+            }
+        }];
+    }];
+}
+
+#pragma mark - Items
+
+- (void)insertItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    NSArray *sortedIndexPaths = [indexPaths sortedArrayUsingSelector:@selector(compare:)];
+    [self enumerateAllSizesBySectionUsingBlock:^(CPSizesBySection *sizesBySection) {
+        for (NSIndexPath *indexPath in sortedIndexPaths) {
+            if (indexPath.section >= sizesBySection.count) {
+                continue;
+            }
+            NSMutableArray *sizesByItem = sizesBySection[indexPath.section];
+            if (indexPath.item <= sizesByItem.count) {
+                [sizesByItem insertObject:[NSNull null] atIndex:indexPath.item];
+            }
+        }
+    }];
+}
+
+- (void)deleteItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    NSArray *sortedIndexPaths = [indexPaths sortedArrayUsingSelector:@selector(compare:)];
+    [self enumerateAllSizesBySectionUsingBlock:^(CPSizesBySection *sizesBySection) {
+        for (NSIndexPath *indexPath in [sortedIndexPaths reverseObjectEnumerator]) {
+            if (indexPath.section >= sizesBySection.count) {
+                continue;
+            }
+            NSMutableArray *sizesByItem = sizesBySection[indexPath.section];
+            if (indexPath.item < sizesByItem.count) {
+                [sizesByItem removeObjectAtIndex:indexPath.item];
+            }
+        }
+    }];
+}
+
+- (void)reloadItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    for (NSIndexPath *indexPath in indexPaths) {
+        [self invalidateSizeAtIndexPath:indexPath];
+    }
+}
+
+#pragma mark - Private
+
+- (CPSizesBySection *)sizesBySectionForPreferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension {
+    return preferredLayoutDimension == CPPreferredLayoutDimensionWidth ? self.sizesBySectionForPreferredWidth : self.sizesBySectionForPreferredHeight;
+}
+
+- (void)enumerateAllSizesBySectionUsingBlock:(void (^)(CPSizesBySection *sizesBySection))block {
+    block(self.sizesBySectionForPreferredWidth);
+    block(self.sizesBySectionForPreferredHeight);
+}
+
+- (void)buildCachesAtIndexPathIfNeeded:(NSIndexPath *)indexPath inSizesBySection:(CPSizesBySection *)sizesBySection {
+    for (NSInteger section = sizesBySection.count; section <= indexPath.section; section++) {
+        [sizesBySection addObject:[NSMutableArray new]];
+    }
+    
+    NSMutableArray *sizesByItem = sizesBySection[indexPath.section];
+    for (NSInteger item = sizesByItem.count; item <= indexPath.item; item++) {
+        [sizesByItem addObject:[NSNull null]];
+    }
+}
+
+@end
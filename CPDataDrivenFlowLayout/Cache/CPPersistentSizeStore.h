@@ -0,0 +1,65 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ 持久化到磁盘的尺寸存储，key由reuseIdentifier、内容指纹、preferredLayoutDimension及preferredLayoutValue组成，可作为CPContentSizeCache的二级缓存使冷启动时不必重新计算
+ 文件由版本头、哈希表区及追加日志区组成：启动时mmap映射，哈希表区直接在映射内存中查找；新尺寸在后台串行队列中追加写入，日志区过大时重写整个文件 (线程安全，仅依赖Foundation)
+ reuseIdentifier及内容指纹以64位哈希保存，cell的布局变化时请修改reuseIdentifier或调用removeAllSizes
+ */
+@interface CPPersistentSizeStore : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+- (nullable instancetype)initWithPath:(NSString *)path NS_DESIGNATED_INITIALIZER;//return nil if the file can not be opened or created
+
+@property (nonatomic, readonly, copy) NSString *path;
+@property (nonatomic) NSUInteger countLimit;//entries kept when the file is compacted. The default value of this property is 20000, 0 means no limit
+@property (nonatomic) NSUInteger compactionThreshold;//appended entries that trigger a compaction. The default value of this property is 1024
+
+#pragma mark - Get And Set Size
+
+- (BOOL)getSize:(CGSize *)size
+forReuseIdentifier:(NSString *)reuseIdentifier
+contentFingerprint:(NSString *)contentFingerprint
+preferredLayoutDimension:(NSInteger)preferredLayoutDimension
+preferredLayoutValue:(CGFloat)preferredLayoutValue;//return NO if not exists
+
+- (void)storeSize:(CGSize)size
+forReuseIdentifier:(NSString *)reuseIdentifier
+contentFingerprint:(NSString *)contentFingerprint
+preferredLayoutDimension:(NSInteger)preferredLayoutDimension
+preferredLayoutValue:(CGFloat)preferredLayoutValue;//appended asynchronously
+
+#pragma mark - Synchronize
+
+- (void)synchronize;//blocks until pending writes are on disk
+
+#pragma mark - Invalidate
+
+- (void)removeAllSizes;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,422 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPPersistentSizeStore.h"
+#import <pthread.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+
+static const uint32_t _CPPersistentSizeStoreMagic = 0x5A535043;//"CPSZ"
+static const uint32_t _CPPersistentSizeStoreVersion = 1;
+
+typedef struct {
+    uint64_t reuseIdentifierHash;//0 marks an empty slot in the table
+    uint64_t contentHash;
+    int64_t preferredLayoutDimension;
+    double preferredLayoutValue;
+} _CPPersistentSizeKey;
+
+typedef struct {
+    _CPPersistentSizeKey key;
+    double width;
+    double height;
+} _CPPersistentSizeEntry;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entrySize;//guards against layout changes of _CPPersistentSizeEntry
+    uint32_t reserved;
+    uint64_t tableCapacity;//power of two, 0 when the table is empty
+    uint64_t reserved2;
+} _CPPersistentSizeHeader;
+
+//header | table (tableCapacity entries, open addressing) | log (appended entries, newer than the table)
+typedef struct {
+    int fd;
+    void *bytes;
+    size_t length;
+    const _CPPersistentSizeEntry *table;
+    uint64_t tableCapacity;
+    const _CPPersistentSizeEntry *log;
+    NSUInteger logCount;
+} _CPPersistentSizeFile;
+
+#pragma mark - Hash Table
+
+static uint64_t _CPPersistentSizeStringHash(NSString *string) {
+    //FNV-1a, stable across launches unlike -hash
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char *c = string.UTF8String; c && *c; c++) {
+        hash ^= (uint8_t)*c;
+        hash *= 0x100000001b3ULL;
+    }
+    
+    return hash ?: 1;
+}
+
+static _CPPersistentSizeKey _CPPersistentSizeKeyMake(NSString *reuseIdentifier, NSString *contentFingerprint, NSInteger preferredLayoutDimension, CGFloat preferredLayoutValue) {
+    _CPPersistentSizeKey key;
+    memset(&key, 0, sizeof(key));
+    key.reuseIdentifierHash = _CPPersistentSizeStringHash(reuseIdentifier);
+    key.contentHash = _CPPersistentSizeStringHash(contentFingerprint);
+    key.preferredLayoutDimension = preferredLayoutDimension;
+    key.preferredLayoutValue = round(preferredLayoutValue * 1000) / 1000;//same precision as CPContentSizeCache
+    
+    return key;
+}
+
+static uint64_t _CPPersistentSizeSlotHash(const _CPPersistentSizeKey *key) {
+    uint64_t valueBits;
+    memcpy(&valueBits, &key->preferredLayoutValue, sizeof(valueBits));
+    uint64_t hash = key->contentHash ^ (key->reuseIdentifierHash * 0x9e3779b97f4a7c15ULL) ^ (valueBits + (uint64_t)key->preferredLayoutDimension);
+    hash ^= hash >> 31;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 29;
+    
+    return hash;
+}
+
+static const _CPPersistentSizeEntry *_CPPersistentSizeTableFind(const _CPPersistentSizeEntry *table, uint64_t capacity, const _CPPersistentSizeKey *key) {
+    uint64_t mask = capacity - 1;
+    uint64_t index = _CPPersistentSizeSlotHash(key) & mask;
+    for (uint64_t probe = 0; probe < capacity; probe++, index = (index + 1) & mask) {
+        if (table[index].key.reuseIdentifierHash == 0) {
+            return NULL;
+        }
+        if (memcmp(&table[index].key, key, sizeof(*key)) == 0) {
+            return &table[index];
+        }
+    }
+    
+    return NULL;
+}
+
+static void _CPPersistentSizeTableInsert(_CPPersistentSizeEntry *table, uint64_t capacity, const _CPPersistentSizeEntry *entry) {
+    uint64_t mask = capacity - 1;
+    uint64_t index = _CPPersistentSizeSlotHash(&entry->key) & mask;
+    for (uint64_t probe = 0; probe < capacity; probe++, index = (index + 1) & mask) {
+        if (table[index].key.reuseIdentifierHash == 0 || memcmp(&table[index].key, &entry->key, sizeof(entry->key)) == 0) {
+            table[index] = *entry;
+            return;
+        }
+    }
+}
+
+#pragma mark - File
+
+static BOOL _CPPersistentSizeFileOpen(NSString *path, _CPPersistentSizeFile *file) {
+    memset(file, 0, sizeof(*file));
+    int fd = open(path.fileSystemRepresentation, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return NO;
+    }
+    
+    struct stat st;
+    _CPPersistentSizeHeader header;
+    BOOL valid = fstat(fd, &st) == 0 &&
+                 (size_t)st.st_size >= sizeof(header) &&
+                 pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+                 header.magic == _CPPersistentSizeStoreMagic &&
+                 header.version == _CPPersistentSizeStoreVersion &&
+                 header.entrySize == sizeof(_CPPersistentSizeEntry) &&
+                 (header.tableCapacity & (header.tableCapacity - 1)) == 0 &&
+                 header.tableCapacity <= ((uint64_t)st.st_size - sizeof(header)) / sizeof(_CPPersistentSizeEntry);
+    if (!valid) {
+        //new, damaged or written by another format version, start over
+        header = (_CPPersistentSizeHeader){_CPPersistentSizeStoreMagic, _CPPersistentSizeStoreVersion, sizeof(_CPPersistentSizeEntry), 0, 0, 0};
+        if (ftruncate(fd, 0) != 0 || pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+            close(fd);
+            return NO;
+        }
+        st.st_size = sizeof(header);
+    }
+    
+    size_t tableLength = (size_t)header.tableCapacity * sizeof(_CPPersistentSizeEntry);
+    NSUInteger logCount = ((size_t)st.st_size - sizeof(header) - tableLength) / sizeof(_CPPersistentSizeEntry);
+    size_t length = sizeof(header) + tableLength + logCount * sizeof(_CPPersistentSizeEntry);
+    if ((size_t)st.st_size != length && ftruncate(fd, length) != 0) {//drops a partial entry left by an interrupted write
+        close(fd);
+        return NO;
+    }
+    
+    void *bytes = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (bytes == MAP_FAILED) {
+        close(fd);
+        return NO;
+    }
+    
+    file->fd = fd;
+    file->bytes = bytes;
+    file->length = length;
+    file->table = (const _CPPersistentSizeEntry *)((const uint8_t *)bytes + sizeof(header));
+    file->tableCapacity = header.tableCapacity;
+    file->log = file->table + header.tableCapacity;
+    file->logCount = logCount;
+    
+    return YES;
+}
+
+static void _CPPersistentSizeFileClose(_CPPersistentSizeFile *file) {
+    if (file->bytes) {
+        munmap(file->bytes, file->length);
+        close(file->fd);
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+static BOOL _CPPersistentSizeFileWrite(NSString *path, const _CPPersistentSizeEntry *entries, NSUInteger count) {
+    uint64_t capacity = 0;
+    if (count > 0) {
+        //load factor <= 0.5 keeps probe sequences short
+        capacity = 64;
+        while (capacity < count * 2) {
+            capacity <<= 1;
+        }
+    }
+    
+    size_t length = sizeof(_CPPersistentSizeHeader) + (size_t)capacity * sizeof(_CPPersistentSizeEntry);
+    uint8_t *bytes = calloc(1, length);
+    if (!bytes) {
+        return NO;
+    }
+    
+    _CPPersistentSizeHeader header = {_CPPersistentSizeStoreMagic, _CPPersistentSizeStoreVersion, sizeof(_CPPersistentSizeEntry), 0, capacity, 0};
+    memcpy(bytes, &header, sizeof(header));
+    _CPPersistentSizeEntry *table = (_CPPersistentSizeEntry *)(bytes + sizeof(header));
+    for (NSUInteger i = 0; i < count; i++) {
+        _CPPersistentSizeTableInsert(table, capacity, &entries[i]);
+    }
+    
+    NSData *data = [NSData dataWithBytesNoCopy:bytes length:length freeWhenDone:YES];
+    return [data writeToFile:path atomically:YES];
+}
+
+
+@interface CPPersistentSizeStore () {
+    pthread_mutex_t _lock;
+    dispatch_queue_t _queue;
+    _CPPersistentSizeFile _file;
+    const _CPPersistentSizeEntry *_table;//mapped, guarded by _lock
+    uint64_t _tableCapacity;
+    NSMutableDictionary<NSData *, NSData *> *_entriesByKey;//log and unwritten entries, newer than the table
+    NSMutableData *_pendingEntries;
+    BOOL _flushScheduled;
+    size_t _appendOffset;//accessed on _queue only
+    NSUInteger _logCount;//accessed on _queue only
+}
+
+@end
+
+@implementation CPPersistentSizeStore
+
+- (instancetype)initWithPath:(NSString *)path {
+    self = [super init];
+    if (self) {
+        _path = [path copy];
+        _countLimit = 20000;
+        _compactionThreshold = 1024;
+        pthread_mutex_init(&_lock, NULL);
+        
+        if (!_CPPersistentSizeFileOpen(_path, &_file)) {
+            return nil;
+        }
+        
+        _queue = dispatch_queue_create("com.caoping.CPPersistentSizeStore", DISPATCH_QUEUE_SERIAL);
+        _pendingEntries = [NSMutableData new];
+        _entriesByKey = [NSMutableDictionary new];
+        [self useFile];
+        
+        //the log is scanned once, the table is used in place
+        for (NSUInteger i = 0; i < _file.logCount; i++) {
+            [self setEntry:&_file.log[i]];
+        }
+        
+        if (_logCount >= _compactionThreshold) {
+            dispatch_async(_queue, ^{
+                [self compact];
+            });
+        }
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    _CPPersistentSizeFileClose(&_file);
+    pthread_mutex_destroy(&_lock);
+}
+
+#pragma mark - Get And Set Size
+
+- (BOOL)getSize:(CGSize *)size forReuseIdentifier:(NSString *)reuseIdentifier contentFingerprint:(NSString *)contentFingerprint preferredLayoutDimension:(NSInteger)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    _CPPersistentSizeKey key = _CPPersistentSizeKeyMake(reuseIdentifier, contentFingerprint, preferredLayoutDimension, preferredLayoutValue);
+    
+    pthread_mutex_lock(&_lock);
+    const _CPPersistentSizeEntry *entry = [self entryForKey:&key];
+    if (entry && size) {
+        *size = CGSizeMake(entry->width, entry->height);
+    }
+    pthread_mutex_unlock(&_lock);
+    
+    return entry != NULL;
+}
+
+- (void)storeSize:(CGSize)size forReuseIdentifier:(NSString *)reuseIdentifier contentFingerprint:(NSString *)contentFingerprint preferredLayoutDimension:(NSInteger)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    _CPPersistentSizeEntry entry;
+    entry.key = _CPPersistentSizeKeyMake(reuseIdentifier, contentFingerprint, preferredLayoutDimension, preferredLayoutValue);
+    entry.width = size.width;
+    entry.height = size.height;
+    
+    pthread_mutex_lock(&_lock);
+    const _CPPersistentSizeEntry *existingEntry = [self entryForKey:&entry.key];
+    if (!existingEntry || existingEntry->width != entry.width || existingEntry->height != entry.height) {
+        [self setEntry:&entry];
+        [_pendingEntries appendBytes:&entry length:sizeof(entry)];
+        if (!_flushScheduled) {
+            _flushScheduled = YES;
+            dispatch_async(_queue, ^{
+                [self flushPendingEntries];
+            });
+        }
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark - Synchronize
+
+- (void)synchronize {
+    dispatch_sync(_queue, ^{
+        [self flushPendingEntries];
+    });
+}
+
+#pragma mark - Invalidate
+
+- (void)removeAllSizes {
+    pthread_mutex_lock(&_lock);
+    [_entriesByKey removeAllObjects];
+    _pendingEntries.length = 0;
+    _table = NULL;
+    _tableCapacity = 0;
+    pthread_mutex_unlock(&_lock);
+    
+    dispatch_async(_queue, ^{
+        [self replaceFileWithEntries:NULL count:0 writtenEntriesByKey:nil];
+    });
+}
+
+#pragma mark - Private
+
+- (nullable const _CPPersistentSizeEntry *)entryForKey:(const _CPPersistentSizeKey *)key {//must be called with lock held
+    NSData *entryData = _entriesByKey[[NSData dataWithBytesNoCopy:(void *)key length:sizeof(*key) freeWhenDone:NO]];
+    if (entryData) {
+        return entryData.bytes;
+    }
+    
+    return _tableCapacity > 0 ? _CPPersistentSizeTableFind(_table, _tableCapacity, key) : NULL;
+}
+
+- (void)setEntry:(const _CPPersistentSizeEntry *)entry {//must be called with lock held, or before the store is shared
+    NSData *keyData = [NSData dataWithBytes:&entry->key length:sizeof(entry->key)];
+    _entriesByKey[keyData] = [NSData dataWithBytes:entry length:sizeof(*entry)];
+}
+
+- (void)useFile {//must be called with lock held, or before the store is shared
+    _table = _file.table;
+    _tableCapacity = _file.tableCapacity;
+    _appendOffset = _file.length;
+    _logCount = _file.logCount;
+}
+
+- (void)flushPendingEntries {//on _queue
+    pthread_mutex_lock(&_lock);
+    NSData *data = [_pendingEntries copy];
+    _pendingEntries.length = 0;
+    _flushScheduled = NO;
+    pthread_mutex_unlock(&_lock);
+    
+    if (data.length == 0) {
+        return;
+    }
+    
+    if (pwrite(_file.fd, data.bytes, data.length, _appendOffset) == (ssize_t)data.length) {
+        _appendOffset += data.length;
+        _logCount += data.length / sizeof(_CPPersistentSizeEntry);
+    }
+    
+    if (_logCount >= MAX(_compactionThreshold, 1)) {
+        [self compact];
+    }
+}
+
+- (void)compact {//on _queue, merges the log into a new table
+    pthread_mutex_lock(&_lock);
+    NSDictionary<NSData *, NSData *> *entriesByKey = [_entriesByKey copy];
+    const _CPPersistentSizeEntry *table = _table;
+    uint64_t tableCapacity = _tableCapacity;
+    pthread_mutex_unlock(&_lock);
+    
+    //the mapping is only replaced on _queue, so the table can be read without the lock
+    NSUInteger countLimit = _countLimit;
+    NSUInteger tableLimit = countLimit == 0 ? NSUIntegerMax : (countLimit > entriesByKey.count ? countLimit - entriesByKey.count : 0);
+    NSMutableData *entries = [NSMutableData new];
+    for (uint64_t i = 0; i < tableCapacity && entries.length / sizeof(_CPPersistentSizeEntry) < tableLimit; i++) {
+        if (table[i].key.reuseIdentifierHash == 0) {
+            continue;
+        }
+        NSData *keyData = [NSData dataWithBytesNoCopy:(void *)&table[i].key length:sizeof(table[i].key) freeWhenDone:NO];
+        if (!entriesByKey[keyData]) {
+            [entries appendBytes:&table[i] length:sizeof(table[i])];
+        }
+    }
+    for (NSData *entryData in entriesByKey.objectEnumerator) {
+        [entries appendData:entryData];
+    }
+    
+    [self replaceFileWithEntries:entries.bytes count:entries.length / sizeof(_CPPersistentSizeEntry) writtenEntriesByKey:entriesByKey];
+}
+
+- (void)replaceFileWithEntries:(nullable const _CPPersistentSizeEntry *)entries count:(NSUInteger)count writtenEntriesByKey:(nullable NSDictionary<NSData *, NSData *> *)writtenEntriesByKey {//on _queue
+    _CPPersistentSizeFile file;
+    if (!_CPPersistentSizeFileWrite(_path, entries, count) || !_CPPersistentSizeFileOpen(_path, &file)) {
+        return;
+    }
+    
+    pthread_mutex_lock(&_lock);
+    _CPPersistentSizeFile oldFile = _file;
+    _file = file;
+    [self useFile];
+    [writtenEntriesByKey enumerateKeysAndObjectsUsingBlock:^(NSData * _Nonnull keyData, NSData * _Nonnull entryData, BOOL * _Nonnull stop) {
+        //entries changed while the file was written stay in memory
+        if ([self->_entriesByKey[keyData] isEqualToData:entryData]) {
+            [self->_entriesByKey removeObjectForKey:keyData];
+        }
+    }];
+    pthread_mutex_unlock(&_lock);
+    
+    _CPPersistentSizeFileClose(&oldFile);
+}
+
+@end
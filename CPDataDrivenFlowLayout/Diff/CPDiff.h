@@ -0,0 +1,77 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef id<NSObject> _Nonnull (^CPDiffKeyBlock)(id object);
+typedef BOOL (^CPDiffEqualBlock)(id oldObject, id newObject);
+
+@interface CPDiffMove : NSObject
+
+@property (nonatomic, readonly) NSUInteger from;//index in old array
+@property (nonatomic, readonly) NSUInteger to;//index in new array
+
+- (instancetype)initWithFrom:(NSUInteger)from to:(NSUInteger)to NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+@interface CPDiffResult : NSObject
+
+@property (nonatomic, readonly) NSIndexSet *inserts;//indexes in new array
+@property (nonatomic, readonly) NSIndexSet *deletes;//indexes in old array
+@property (nonatomic, readonly) NSIndexSet *updates;//indexes in old array whose matched object is not equal, including moved ones
+@property (nonatomic, readonly) NSArray<CPDiffMove *> *moves;//minimal moves, matched objects outside the longest subsequence which keeps its relative order
+
+@property (nonatomic, readonly) BOOL hasChanges;
+
+- (NSUInteger)newIndexForOldIndex:(NSUInteger)oldIndex;//return NSNotFound if deleted
+- (NSUInteger)oldIndexForNewIndex:(NSUInteger)newIndex;//return NSNotFound if inserted
+
+@end
+
+/**
+ 基于Heckel算法的diff，仅依赖Foundation
+ 匹配为线性时间，move由匹配元素的最长递增子序列求出，时间复杂度O(n log n)
+ */
+@interface CPDiff : NSObject
+
+/**
+ 计算oldArray到newArray的差异
+
+ @param oldArray   旧数组
+ @param newArray   新数组
+ @param keyBlock   返回元素唯一标识的block，key需实现isEqual:及hash
+ @param equalBlock 判断key相同的两个元素内容是否相同的block，为nil时视为相同
+
+ @return diff结果
+ */
++ (CPDiffResult *)diffWithOldArray:(NSArray *)oldArray
+                          newArray:(NSArray *)newArray
+                          keyBlock:(CPDiffKeyBlock)keyBlock
+                        equalBlock:(nullable CPDiffEqualBlock)equalBlock;
+
+@end
+
+NS_ASSUME_NONNULL_END
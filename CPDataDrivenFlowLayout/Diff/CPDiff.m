@@ -0,0 +1,235 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPDiff.h"
+
+@implementation CPDiffMove
+
+- (instancetype)initWithFrom:(NSUInteger)from to:(NSUInteger)to {
+    self = [super init];
+    if (self) {
+        _from = from;
+        _to = to;
+    }
+
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; from = %lu; to = %lu>", NSStringFromClass([self class]), self, (unsigned long)_from, (unsigned long)_to];
+}
+
+@end
+
+
+@interface CPDiffResult () {
+    NSUInteger *_newIndexesForOld;
+    NSUInteger *_oldIndexesForNew;
+    NSUInteger _oldCount;
+    NSUInteger _newCount;
+}
+
+@end
+
+@implementation CPDiffResult
+
+- (instancetype)initWithInserts:(NSIndexSet *)inserts
+                        deletes:(NSIndexSet *)deletes
+                        updates:(NSIndexSet *)updates
+                          moves:(NSArray<CPDiffMove *> *)moves
+               newIndexesForOld:(NSUInteger *)newIndexesForOld
+                       oldCount:(NSUInteger)oldCount
+               oldIndexesForNew:(NSUInteger *)oldIndexesForNew
+                       newCount:(NSUInteger)newCount {
+    self = [super init];
+    if (self) {
+        _inserts = [inserts copy];
+        _deletes = [deletes copy];
+        _updates = [updates copy];
+        _moves = [moves copy];
+        _newIndexesForOld = newIndexesForOld;//take ownership
+        _oldIndexesForNew = oldIndexesForNew;//take ownership
+        _oldCount = oldCount;
+        _newCount = newCount;
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    free(_newIndexesForOld);
+    free(_oldIndexesForNew);
+}
+
+- (BOOL)hasChanges {
+    return _inserts.count > 0 || _deletes.count > 0 || _updates.count > 0 || _moves.count > 0;
+}
+
+- (NSUInteger)newIndexForOldIndex:(NSUInteger)oldIndex {
+    return oldIndex < _oldCount ? _newIndexesForOld[oldIndex] : NSNotFound;
+}
+
+- (NSUInteger)oldIndexForNewIndex:(NSUInteger)newIndex {
+    return newIndex < _newCount ? _oldIndexesForNew[newIndex] : NSNotFound;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; inserts = %@; deletes = %@; updates = %@; moves = %@>", NSStringFromClass([self class]), self, _inserts, _deletes, _updates, _moves];
+}
+
+@end
+
+
+@implementation CPDiff
+
++ (CPDiffResult *)diffWithOldArray:(NSArray *)oldArray newArray:(NSArray *)newArray keyBlock:(CPDiffKeyBlock)keyBlock equalBlock:(nullable CPDiffEqualBlock)equalBlock {
+    NSParameterAssert(keyBlock);
+
+    const NSUInteger oldCount = oldArray.count;
+    const NSUInteger newCount = newArray.count;
+
+    //symbol table: key -> entry, each entry keeps a stack of old indexes chained through oldIndexStack
+    NSMutableDictionary<id, NSNumber *> *entriesByKey = [NSMutableDictionary dictionaryWithCapacity:MAX(oldCount, newCount)];
+    NSUInteger entryCount = 0;
+    NSUInteger *entryOldHeads = malloc(sizeof(NSUInteger) * MAX(oldCount + newCount, 1));
+    NSUInteger *oldIndexStack = malloc(sizeof(NSUInteger) * MAX(oldCount, 1));
+    NSUInteger *newEntries = malloc(sizeof(NSUInteger) * MAX(newCount, 1));
+    NSUInteger *newIndexesForOld = malloc(sizeof(NSUInteger) * MAX(oldCount, 1));
+    NSUInteger *oldIndexesForNew = malloc(sizeof(NSUInteger) * MAX(newCount, 1));
+
+    //pass 1: entries for new array
+    for (NSUInteger i = 0; i < newCount; i++) {
+        id<NSObject> key = keyBlock(newArray[i]);
+        NSNumber *entry = entriesByKey[key];
+        if (!entry) {
+            entry = @(entryCount);
+            entriesByKey[(id<NSCopying>)key] = entry;
+            entryOldHeads[entryCount] = NSNotFound;
+            entryCount++;
+        }
+        newEntries[i] = entry.unsignedIntegerValue;
+        oldIndexesForNew[i] = NSNotFound;
+    }
+
+    //pass 2: push old indexes in reverse, so the smallest old index is popped first
+    for (NSUInteger i = oldCount; i > 0; i--) {
+        NSUInteger oldIndex = i - 1;
+        newIndexesForOld[oldIndex] = NSNotFound;
+
+        NSNumber *entry = entriesByKey[keyBlock(oldArray[oldIndex])];
+        if (entry) {
+            NSUInteger e = entry.unsignedIntegerValue;
+            oldIndexStack[oldIndex] = entryOldHeads[e];
+            entryOldHeads[e] = oldIndex;
+        }
+    }
+
+    //pass 3: match new records with old records occurring on both sides
+    NSMutableIndexSet *updates = [NSMutableIndexSet new];
+    for (NSUInteger i = 0; i < newCount; i++) {
+        NSUInteger e = newEntries[i];
+        NSUInteger oldIndex = entryOldHeads[e];
+        if (oldIndex == NSNotFound) {
+            continue;
+        }
+        entryOldHeads[e] = oldIndexStack[oldIndex];
+
+        oldIndexesForNew[i] = oldIndex;
+        newIndexesForOld[oldIndex] = i;
+        if (equalBlock && !equalBlock(oldArray[oldIndex], newArray[i])) {
+            [updates addIndex:oldIndex];
+        }
+    }
+
+    //pass 4: deletes
+    NSMutableIndexSet *deletes = [NSMutableIndexSet new];
+    for (NSUInteger i = 0; i < oldCount; i++) {
+        if (newIndexesForOld[i] == NSNotFound) {
+            [deletes addIndex:i];
+        }
+    }
+
+    //pass 5: longest increasing subsequence of matched old indexes in new order, those records keep their relative order
+    //patience sorting: tails[k] is the position in newIndexes of the smallest tail of a subsequence with length k + 1
+    NSUInteger *newIndexes = newEntries;//reuse buffer, new indexes of matched records
+    NSUInteger *tails = oldIndexStack;//reuse buffer, at most min(oldCount, newCount) entries
+    NSUInteger *predecessors = entryOldHeads;//reuse buffer, position of the previous record in the subsequence
+    NSUInteger matchedCount = 0;
+    NSUInteger length = 0;
+    for (NSUInteger i = 0; i < newCount; i++) {
+        NSUInteger oldIndex = oldIndexesForNew[i];
+        if (oldIndex == NSNotFound) {
+            continue;
+        }
+
+        NSUInteger low = 0;
+        NSUInteger high = length;
+        while (low < high) {
+            NSUInteger mid = (low + high) / 2;
+            if (oldIndexesForNew[newIndexes[tails[mid]]] < oldIndex) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+
+        newIndexes[matchedCount] = i;
+        predecessors[matchedCount] = low > 0 ? tails[low - 1] : NSNotFound;
+        tails[low] = matchedCount;
+        if (low == length) {
+            length++;
+        }
+        matchedCount++;
+    }
+
+    NSMutableIndexSet *stableNewIndexes = [NSMutableIndexSet new];
+    for (NSUInteger position = length > 0 ? tails[length - 1] : NSNotFound; position != NSNotFound; position = predecessors[position]) {
+        [stableNewIndexes addIndex:newIndexes[position]];
+    }
+
+    //pass 6: inserts, and moves for matched records outside the subsequence
+    NSMutableIndexSet *inserts = [NSMutableIndexSet new];
+    NSMutableArray<CPDiffMove *> *moves = [NSMutableArray new];
+    for (NSUInteger i = 0; i < newCount; i++) {
+        NSUInteger oldIndex = oldIndexesForNew[i];
+        if (oldIndex == NSNotFound) {
+            [inserts addIndex:i];
+        } else if (![stableNewIndexes containsIndex:i]) {
+            [moves addObject:[[CPDiffMove alloc] initWithFrom:oldIndex to:i]];
+        }
+    }
+
+    free(entryOldHeads);
+    free(oldIndexStack);
+    free(newEntries);
+
+    return [[CPDiffResult alloc] initWithInserts:inserts
+                                         deletes:deletes
+                                         updates:updates
+                                           moves:moves
+                                newIndexesForOld:newIndexesForOld
+                                        oldCount:oldCount
+                                oldIndexesForNew:oldIndexesForNew
+                                        newCount:newCount];
+}
+
+@end
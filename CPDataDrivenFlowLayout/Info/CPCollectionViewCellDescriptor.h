@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+#import "UICollectionView+CPTemplateLayoutCell.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^CPCollectionViewCellBlock)(__kindof UICollectionView *collectionView, __kindof UICollectionViewCell *cell, NSIndexPath *indexPath, __kindof NSObject * _Nullable data);
+typedef CGSize (^CPCollectionViewPreferredLayoutBlock)(CPPreferredLayoutDimension dimension, CGFloat preferredLayoutValue);
+typedef CGSize (^CPCollectionViewCellSizeBlock)(__kindof UICollectionView *collectionView, __kindof UICollectionViewLayout *layout, CPCollectionViewPreferredLayoutBlock sizeByPreferredLayoutCalculator);
+typedef CGSize (^CPCollectionViewCellDataSizeBlock)(__kindof NSObject * _Nullable data, CPPreferredLayoutDimension dimension, CGFloat preferredLayoutValue);
+typedef void (^CPCollectionViewCellPrefetchCompletion)(id _Nullable prefetchedResult);
+typedef void (^CPCollectionViewCellPrefetchBlock)(__kindof NSObject * _Nullable data, CPCollectionViewCellPrefetchCompletion completion);
+typedef void (^CPCollectionViewCellCancelPrefetchBlock)(__kindof NSObject * _Nullable data);
+
+/**
+ 一种cell的共享描述 (class或nib、reuseIdentifier及回调)，创建一次后由同类型的多个cellInfo共享
+ cellInfo只持有descriptor引用、data及identifier；修改cellInfo上的对应属性时会为该cellInfo复制一份descriptor，不影响其他cellInfo
+ */
+@interface CPCollectionViewCellDescriptor : NSObject <NSCopying>
+
+@property (nonatomic, readonly, nullable) Class cellClass;
+@property (nonatomic, readonly, nullable) UINib *nibForCell;
+@property (nonatomic, readonly) NSString *cellReuseIdentifier;
+
+@property (nonatomic, copy, readonly) CPCollectionViewCellBlock cellDidReuseCallback;
+@property (nonatomic, copy, readonly, nullable) CPCollectionViewCellSizeBlock sizeForCellCallback;
+@property (nonatomic, copy, readonly, nullable) CPCollectionViewCellBlock cellDidSelectCallback;
+@property (nonatomic, copy, readonly, nullable) CPCollectionViewCellDataSizeBlock sizeForDataCallback;
+@property (nonatomic, copy, readonly, nullable) CPCollectionViewCellPrefetchBlock prefetchCallback;//called on the main thread before the cell appears, start the work asynchronously and call completion on any thread
+@property (nonatomic, copy, readonly, nullable) CPCollectionViewCellCancelPrefetchBlock cancelPrefetchCallback;//called on the main thread when a started prefetch is no longer needed, completion must still be called, the prefetch slot is released only then
+
+#pragma mark - Designated Initializer
+
+- (instancetype)initWithCellClass:(nullable Class)cellClass
+                       nibForCell:(nullable UINib *)nibForCell
+              cellReuseIdentifier:(nullable NSString *)cellReuseIdentifier
+             cellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback
+              sizeForCellCallback:(nullable CPCollectionViewCellSizeBlock)sizeForCellCallback
+            cellDidSelectCallback:(nullable CPCollectionViewCellBlock)cellDidSelectCallback
+              sizeForDataCallback:(nullable CPCollectionViewCellDataSizeBlock)sizeForDataCallback NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+#pragma mark - Convenience Initializers
+
+- (instancetype)initWithCellClass:(Class)cellClass
+             cellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback
+              sizeForCellCallback:(nullable CPCollectionViewCellSizeBlock)sizeForCellCallback;
+
+- (instancetype)initWithNibForCell:(UINib *)nibForCell
+               cellReuseIdentifier:(NSString *)cellReuseIdentifier
+              cellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback
+               sizeForCellCallback:(nullable CPCollectionViewCellSizeBlock)sizeForCellCallback;
+
+#pragma mark - Prefetching
+
+/**
+ 返回设置了预取回调的descriptor副本，由CPCollectionViewDataSourceInterceptor在cell出现前调用，结果保存在cellInfo的prefetchedResult
+
+ @param prefetchCallback       预取回调
+ @param cancelPrefetchCallback 取消预取回调
+ */
+- (instancetype)descriptorWithPrefetchCallback:(nullable CPCollectionViewCellPrefetchBlock)prefetchCallback
+                        cancelPrefetchCallback:(nullable CPCollectionViewCellCancelPrefetchBlock)cancelPrefetchCallback;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,142 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPCollectionViewCellDescriptor.h"
+#import <pthread.h>
+
+//default reuse identifiers are interned per class, so descriptors and cell infos of one class share a single string
+static NSString * CPDefaultCellReuseIdentifierForClass(Class cellClass) {
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    static NSMutableDictionary<NSString *, NSString *> *reuseIdentifiersByClassName;
+    
+    NSString *className = NSStringFromClass(cellClass);
+    pthread_mutex_lock(&lock);
+    if (!reuseIdentifiersByClassName) {
+        reuseIdentifiersByClassName = [NSMutableDictionary new];
+    }
+    NSString *reuseIdentifier = reuseIdentifiersByClassName[className];
+    if (!reuseIdentifier) {
+        reuseIdentifier = [className stringByAppendingString:@"_CellReuseIdentifier"];
+        reuseIdentifiersByClassName[className] = reuseIdentifier;
+    }
+    pthread_mutex_unlock(&lock);
+    
+    return reuseIdentifier;
+}
+
+@interface CPCollectionViewCellDescriptor ()
+
+@property (nonatomic, nullable) Class cellClass;
+@property (nonatomic, nullable) UINib *nibForCell;
+@property (nonatomic) NSString *cellReuseIdentifier;
+
+@property (nonatomic, copy) CPCollectionViewCellBlock cellDidReuseCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellSizeBlock sizeForCellCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellBlock cellDidSelectCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellDataSizeBlock sizeForDataCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellPrefetchBlock prefetchCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellCancelPrefetchBlock cancelPrefetchCallback;
+
+@end
+
+@implementation CPCollectionViewCellDescriptor
+
+#pragma mark - Designated Initializer
+
+- (instancetype)initWithCellClass:(Class)cellClass nibForCell:(UINib *)nibForCell cellReuseIdentifier:(NSString *)cellReuseIdentifier cellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback sizeForCellCallback:(CPCollectionViewCellSizeBlock)sizeForCellCallback cellDidSelectCallback:(CPCollectionViewCellBlock)cellDidSelectCallback sizeForDataCallback:(CPCollectionViewCellDataSizeBlock)sizeForDataCallback {
+    self = [super init];
+    if (self) {
+        NSParameterAssert(cellClass || nibForCell);
+        
+        _cellClass = cellClass;
+        _nibForCell = nibForCell;
+        _cellReuseIdentifier = [cellReuseIdentifier copy];
+        if (cellClass && !cellReuseIdentifier) {
+            _cellReuseIdentifier = CPDefaultCellReuseIdentifierForClass(cellClass);
+        }
+        
+        _cellDidReuseCallback = [cellDidReuseCallback copy];
+        _sizeForCellCallback = [sizeForCellCallback copy];
+        _cellDidSelectCallback = [cellDidSelectCallback copy];
+        _sizeForDataCallback = [sizeForDataCallback copy];
+    }
+    
+    return self;
+}
+
+#pragma mark - Convenience Initializers
+
+- (instancetype)initWithCellClass:(Class)cellClass cellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback sizeForCellCallback:(CPCollectionViewCellSizeBlock)sizeForCellCallback {
+    NSParameterAssert(cellClass);
+    NSParameterAssert(cellDidReuseCallback);
+    
+    return [self initWithCellClass:cellClass
+                        nibForCell:nil
+               cellReuseIdentifier:nil
+              cellDidReuseCallback:cellDidReuseCallback
+               sizeForCellCallback:sizeForCellCallback
+             cellDidSelectCallback:nil
+               sizeForDataCallback:nil];
+}
+
+- (instancetype)initWithNibForCell:(UINib *)nibForCell cellReuseIdentifier:(NSString *)cellReuseIdentifier cellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback sizeForCellCallback:(CPCollectionViewCellSizeBlock)sizeForCellCallback {
+    NSParameterAssert(nibForCell);
+    NSParameterAssert(cellReuseIdentifier);
+    NSParameterAssert(cellDidReuseCallback);
+    
+    return [self initWithCellClass:nil
+                        nibForCell:nibForCell
+               cellReuseIdentifier:cellReuseIdentifier
+              cellDidReuseCallback:cellDidReuseCallback
+               sizeForCellCallback:sizeForCellCallback
+             cellDidSelectCallback:nil
+               sizeForDataCallback:nil];
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    //blocks and strings are immutable, the copy shares them
+    CPCollectionViewCellDescriptor *descriptor = [[[self class] allocWithZone:zone] initWithCellClass:_cellClass
+                                                                                           nibForCell:_nibForCell
+                                                                                  cellReuseIdentifier:_cellReuseIdentifier
+                                                                                 cellDidReuseCallback:_cellDidReuseCallback
+                                                                                  sizeForCellCallback:_sizeForCellCallback
+                                                                                cellDidSelectCallback:_cellDidSelectCallback
+                                                                                  sizeForDataCallback:_sizeForDataCallback];
+    descriptor->_prefetchCallback = _prefetchCallback;
+    descriptor->_cancelPrefetchCallback = _cancelPrefetchCallback;
+    
+    return descriptor;
+}
+
+#pragma mark - Prefetching
+
+- (instancetype)descriptorWithPrefetchCallback:(CPCollectionViewCellPrefetchBlock)prefetchCallback cancelPrefetchCallback:(CPCollectionViewCellCancelPrefetchBlock)cancelPrefetchCallback {
+    CPCollectionViewCellDescriptor *descriptor = [self copy];
+    descriptor.prefetchCallback = prefetchCallback;
+    descriptor.cancelPrefetchCallback = cancelPrefetchCallback;
+    
+    return descriptor;
+}
+
+@end
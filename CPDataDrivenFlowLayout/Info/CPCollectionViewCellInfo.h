@@ -23,26 +23,49 @@
 #import <Foundation/Foundation.h>
 #import <UIKit/UIKit.h>
 #import "UICollectionView+CPTemplateLayoutCell.h"
+#import "CPCollectionViewCellDescriptor.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
-typedef void (^CPCollectionViewCellBlock)(__kindof UICollectionView *collectionView, __kindof UICollectionViewCell *cell, NSIndexPath *indexPath, __kindof NSObject * _Nullable data);
-typedef CGSize (^CPCollectionViewPreferredLayoutBlock)(CPPreferredLayoutDimension dimension, CGFloat preferredLayoutValue);
-typedef CGSize (^CPCollectionViewCellSizeBlock)(__kindof UICollectionView *collectionView, __kindof UICollectionViewLayout *layout, CPCollectionViewPreferredLayoutBlock sizeByPreferredLayoutCalculator);
+@class CPCollectionViewSectionInfo;
 
 @interface CPCollectionViewCellInfo : NSObject
 
+@property (nonatomic, readonly) CPCollectionViewCellDescriptor *descriptor;//shared by cell infos created with the same descriptor, or created in a row by the class and nib initializers with the same arguments and callbacks which capture nothing
 @property (nonatomic, readonly) NSString *cellReuseIdentifier;
 
-@property (nonatomic, nullable) NSString *identifier;//string used to identify cell info
+@property (nonatomic, unsafe_unretained, readonly, nullable) CPCollectionViewSectionInfo *sectionInfo;//section info which contains this cell info, cleared when the cell info is removed or the section info is deallocated
+
+@property (nonatomic, nullable) NSString *identifier;//string used to identify cell info, should not be changed after the cell info is added to collection view
 @property (nonatomic, nullable) __kindof NSObject *data;
+@property (nonatomic, copy, nullable) NSString *contentFingerprint;//hash or version of data, cell infos with the same cellReuseIdentifier and contentFingerprint share one measured size
+@property (nonatomic) CGSize estimatedSize;//optional hint for estimated-size mode, used instead of the average size of the reuse identifier until the cell is measured
+@property (nonatomic, readonly, getter=isSizeEstimated) BOOL sizeEstimated;//YES while laid out with an estimated size
 
+//the properties below are stored in descriptor, setting them copies the descriptor for this cell info only
 @property (nonatomic, nullable) Class cellClass;
 @property (nonatomic, nullable) UINib *nibForCell;
 
 @property (nonatomic, copy) CPCollectionViewCellBlock cellDidReuseCallback;
 @property (nonatomic, copy, nullable) CPCollectionViewCellSizeBlock sizeForCellCallback;
 @property (nonatomic, copy, nullable) CPCollectionViewCellBlock cellDidSelectCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellDataSizeBlock sizeForDataCallback;//optional view-free sizing (e.g. text metrics plus fixed paddings), must be thread-safe and data is read on a background queue (copied first if it conforms to NSCopying). when set, sizeByPreferredLayoutCalculator uses it instead of a template cell, and sizes can be precomputed on a background queue
+@property (nonatomic, copy, nullable) CPCollectionViewCellPrefetchBlock prefetchCallback;//optional, called by CPCollectionViewDataSourceInterceptor before the cell appears, e.g. to decode images
+@property (nonatomic, copy, nullable) CPCollectionViewCellCancelPrefetchBlock cancelPrefetchCallback;//optional, called when a started prefetch is no longer needed, completion must still be called
+
+@property (nonatomic, readonly, nullable) id prefetchedResult;//result passed to the completion of prefetchCallback, read it in cellDidReuseCallback. main thread only, cleared when data changes or evicted by CPCollectionViewDataSourceInterceptor
+
+#pragma mark - Initializers With Descriptor
+
+/**
+ 根据共享的descriptor创建cellInfo，大量同类型cell共享一个descriptor，每个cellInfo只持有引用、data及identifier
+
+ @param descriptor cell描述
+ @param data       数据
+ */
+- (instancetype)initWithDescriptor:(CPCollectionViewCellDescriptor *)descriptor data:(__kindof NSObject * _Nullable)data;
+
+- (instancetype)initWithDescriptor:(CPCollectionViewCellDescriptor *)descriptor data:(__kindof NSObject * _Nullable)data identifier:(nullable NSString *)identifier;
 
 #pragma mark - Initializers With Class
 
@@ -65,6 +88,18 @@ typedef CGSize (^CPCollectionViewCellSizeBlock)(__kindof UICollectionView *colle
               cellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback
                sizeForCellCallback:(CPCollectionViewCellSizeBlock)sizeForCellCallback;
 
+#pragma mark - Precomputed Size
+
+- (BOOL)cp_getPrecomputedSize:(CGSize *)size
+     preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+         preferredLayoutValue:(CGFloat)preferredLayoutValue;//return NO if not exists
+
+- (void)cp_setPrecomputedSize:(CGSize)size
+     preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+         preferredLayoutValue:(CGFloat)preferredLayoutValue;//main thread only, cleared when data or contentFingerprint changes
+
+- (void)cp_invalidatePrecomputedSize;//main thread only, called when the item is reloaded or reconfigured, data may have been mutated in place
+
 @end
 
 NS_ASSUME_NONNULL_END
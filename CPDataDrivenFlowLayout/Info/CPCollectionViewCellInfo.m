@@ -21,32 +21,123 @@
 // SOFTWARE.
 
 #import "CPCollectionViewCellInfo.h"
+#import <pthread.h>
+
+#define CP_INTERNED_DESCRIPTOR_SLOT_COUNT 16
+
+@interface CPCollectionViewCellDescriptor ()
+
+@property (nonatomic, nullable) Class cellClass;
+@property (nonatomic, nullable) UINib *nibForCell;
+
+@property (nonatomic, copy) CPCollectionViewCellBlock cellDidReuseCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellSizeBlock sizeForCellCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellBlock cellDidSelectCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellDataSizeBlock sizeForDataCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellPrefetchBlock prefetchCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewCellCancelPrefetchBlock cancelPrefetchCallback;
+
+@end
+
+@interface CPCollectionViewCellInfo () {
+    BOOL _ownsDescriptor;//NO while the descriptor may be shared, it is copied before the first change
+    BOOL _hasPrecomputedSize;
+    CGSize _precomputedSize;
+    CPPreferredLayoutDimension _precomputedLayoutDimension;
+    CGFloat _precomputedLayoutValue;
+}
+
+@property (nonatomic, unsafe_unretained, nullable) CPCollectionViewSectionInfo *sectionInfo;
+@property (nonatomic, getter=isSizeEstimated) BOOL sizeEstimated;
+@property (nonatomic, nullable) id prefetchedResult;
+@property (nonatomic) BOOL hasPrefetchedResult;//the prefetched result may be nil
+
+@end
 
 @implementation CPCollectionViewCellInfo
 
 #pragma mark - Designated Initializer
 
-- (instancetype)initWithCellClass:(nullable Class)cellClass nibForCell:(nullable UINib *)nibForCell cellReuseIdentifier:(nullable NSString *)cellReuseIdentifier data:(__kindof NSObject * _Nullable)data cellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback sizeForCellCallback:(nullable CPCollectionViewCellSizeBlock)sizeForCellCallback cellDidSelectCallback:(nullable CPCollectionViewCellBlock)cellDidSelectCallback {
+- (instancetype)initWithDescriptor:(CPCollectionViewCellDescriptor *)descriptor data:(__kindof NSObject * _Nullable)data identifier:(nullable NSString *)identifier {
     self = [super init];
     if (self) {
-        NSParameterAssert(cellClass || nibForCell);
-        
-        _cellClass = cellClass;
-        _nibForCell = nibForCell;
-        _cellReuseIdentifier = cellReuseIdentifier;
-        if (cellClass && !cellReuseIdentifier) {
-            _cellReuseIdentifier = [NSStringFromClass(cellClass) stringByAppendingString:@"_CellReuseIdentifier"];
-        }
+        NSParameterAssert(descriptor);
         
+        _descriptor = descriptor;
         _data = data;
-        _cellDidReuseCallback = [cellDidReuseCallback copy];
-        _sizeForCellCallback = [sizeForCellCallback copy];
-        _cellDidSelectCallback = [cellDidSelectCallback copy];
+        _identifier = identifier;
     }
     
     return self;
 }
 
+#pragma mark - Convenience Initializers With Descriptor
+
+- (instancetype)initWithDescriptor:(CPCollectionViewCellDescriptor *)descriptor data:(__kindof NSObject * _Nullable)data {
+    return [self initWithDescriptor:descriptor data:data identifier:nil];
+}
+
+#pragma mark - Interned Descriptor
+
+- (instancetype)initWithCellClass:(nullable Class)cellClass nibForCell:(nullable UINib *)nibForCell cellReuseIdentifier:(nullable NSString *)cellReuseIdentifier data:(__kindof NSObject * _Nullable)data cellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback sizeForCellCallback:(nullable CPCollectionViewCellSizeBlock)sizeForCellCallback cellDidSelectCallback:(nullable CPCollectionViewCellBlock)cellDidSelectCallback {
+    //the descriptor may be shared with other cell infos, it is copied before the first change
+    CPCollectionViewCellDescriptor *descriptor = [[self class] internedDescriptorWithCellClass:cellClass
+                                                                                     nibForCell:nibForCell
+                                                                            cellReuseIdentifier:cellReuseIdentifier
+                                                                           cellDidReuseCallback:cellDidReuseCallback
+                                                                            sizeForCellCallback:sizeForCellCallback
+                                                                          cellDidSelectCallback:cellDidSelectCallback];
+    return [self initWithDescriptor:descriptor data:data identifier:nil];
+}
+
++ (CPCollectionViewCellDescriptor *)internedDescriptorWithCellClass:(nullable Class)cellClass nibForCell:(nullable UINib *)nibForCell cellReuseIdentifier:(nullable NSString *)cellReuseIdentifier cellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback sizeForCellCallback:(nullable CPCollectionViewCellSizeBlock)sizeForCellCallback cellDidSelectCallback:(nullable CPCollectionViewCellBlock)cellDidSelectCallback {
+    //legacy initializers are called in loops with the same class or nib, reuse identifier and callbacks,
+    //recently created descriptors are kept in a small direct-mapped table and shared instead of allocating one per cell info
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    static NSPointerArray *descriptors;//weak, a descriptor is released with its last cell info
+    static BOOL hasReuseIdentifiers[CP_INTERNED_DESCRIPTOR_SLOT_COUNT];//NO if the descriptor was created with the default reuse identifier of its class
+    
+    //blocks which capture nothing are global and keep their address, blocks capturing variables get a new address and are not shared
+    cellDidReuseCallback = [cellDidReuseCallback copy];
+    sizeForCellCallback = [sizeForCellCallback copy];
+    cellDidSelectCallback = [cellDidSelectCallback copy];
+    
+    uintptr_t hash = (uintptr_t)(__bridge void *)cellClass ^ ((uintptr_t)(__bridge void *)nibForCell >> 3) ^ cellReuseIdentifier.hash;
+    hash ^= ((uintptr_t)(__bridge void *)cellDidReuseCallback >> 4) ^ ((uintptr_t)(__bridge void *)sizeForCellCallback >> 5) ^ ((uintptr_t)(__bridge void *)cellDidSelectCallback >> 6);
+    NSUInteger slot = (NSUInteger)((hash ^ (hash >> 16)) % CP_INTERNED_DESCRIPTOR_SLOT_COUNT);
+    
+    pthread_mutex_lock(&lock);
+    if (!descriptors) {
+        descriptors = [NSPointerArray weakObjectsPointerArray];
+        descriptors.count = CP_INTERNED_DESCRIPTOR_SLOT_COUNT;
+    }
+    
+    //a live descriptor retains what it was created with, so equal pointers are the same objects
+    CPCollectionViewCellDescriptor *descriptor = (__bridge CPCollectionViewCellDescriptor *)[descriptors pointerAtIndex:slot];
+    BOOL matches = descriptor
+    && descriptor.cellClass == cellClass
+    && descriptor.nibForCell == nibForCell
+    && descriptor.cellDidReuseCallback == cellDidReuseCallback
+    && descriptor.sizeForCellCallback == sizeForCellCallback
+    && descriptor.cellDidSelectCallback == cellDidSelectCallback
+    && (cellReuseIdentifier ? [descriptor.cellReuseIdentifier isEqualToString:cellReuseIdentifier] : !hasReuseIdentifiers[slot]);
+    
+    if (!matches) {
+        descriptor = [[CPCollectionViewCellDescriptor alloc] initWithCellClass:cellClass
+                                                                    nibForCell:nibForCell
+                                                           cellReuseIdentifier:cellReuseIdentifier
+                                                          cellDidReuseCallback:cellDidReuseCallback
+                                                           sizeForCellCallback:sizeForCellCallback
+                                                         cellDidSelectCallback:cellDidSelectCallback
+                                                           sizeForDataCallback:nil];
+        [descriptors replacePointerAtIndex:slot withPointer:(__bridge void *)descriptor];
+        hasReuseIdentifiers[slot] = cellReuseIdentifier != nil;
+    }
+    pthread_mutex_unlock(&lock);
+    
+    return descriptor;
+}
+
 #pragma mark - Convenience Initializers With Class
 
 - (instancetype)initWithCellClass:(Class)cellClass
@@ -108,6 +199,27 @@
 }
 
 - (BOOL)checkNibIdentifierInDebug:(UINib *)nib cellReuseIdentifier:(NSString *)cellReuseIdentifier {
+    //instantiating the nib is expensive, each nib and reuseIdentifier pair is checked only once
+    static NSMapTable<UINib *, NSMutableSet<NSString *> *> *checkedIdentifiersByNib;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        checkedIdentifiersByNib = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality
+                                                        valueOptions:NSPointerFunctionsStrongMemory];
+    });
+    
+    @synchronized (checkedIdentifiersByNib) {
+        NSMutableSet<NSString *> *checkedIdentifiers = [checkedIdentifiersByNib objectForKey:nib];
+        if ([checkedIdentifiers containsObject:cellReuseIdentifier]) {
+            return YES;
+        }
+        
+        if (!checkedIdentifiers) {
+            checkedIdentifiers = [NSMutableSet new];
+            [checkedIdentifiersByNib setObject:checkedIdentifiers forKey:nib];
+        }
+        [checkedIdentifiers addObject:cellReuseIdentifier];
+    }
+    
     NSArray *views = [nib instantiateWithOwner:nil options:nil];
     UICollectionReusableView *reusableView;
     for (UIView *view in views) {
@@ -123,5 +235,125 @@
     return YES;
 }
 
+#pragma mark - Descriptor
+
+- (CPCollectionViewCellDescriptor *)mutableDescriptor {
+    if (!_ownsDescriptor) {
+        _descriptor = [_descriptor copy];
+        _ownsDescriptor = YES;
+    }
+    
+    return _descriptor;
+}
+
+- (NSString *)cellReuseIdentifier {
+    return _descriptor.cellReuseIdentifier;
+}
+
+- (Class)cellClass {
+    return _descriptor.cellClass;
+}
+
+- (void)setCellClass:(Class)cellClass {
+    [self mutableDescriptor].cellClass = cellClass;
+}
+
+- (UINib *)nibForCell {
+    return _descriptor.nibForCell;
+}
+
+- (void)setNibForCell:(UINib *)nibForCell {
+    [self mutableDescriptor].nibForCell = nibForCell;
+}
+
+- (CPCollectionViewCellBlock)cellDidReuseCallback {
+    return _descriptor.cellDidReuseCallback;
+}
+
+- (void)setCellDidReuseCallback:(CPCollectionViewCellBlock)cellDidReuseCallback {
+    [self mutableDescriptor].cellDidReuseCallback = cellDidReuseCallback;
+}
+
+- (CPCollectionViewCellSizeBlock)sizeForCellCallback {
+    return _descriptor.sizeForCellCallback;
+}
+
+- (void)setSizeForCellCallback:(CPCollectionViewCellSizeBlock)sizeForCellCallback {
+    [self mutableDescriptor].sizeForCellCallback = sizeForCellCallback;
+}
+
+- (CPCollectionViewCellBlock)cellDidSelectCallback {
+    return _descriptor.cellDidSelectCallback;
+}
+
+- (void)setCellDidSelectCallback:(CPCollectionViewCellBlock)cellDidSelectCallback {
+    [self mutableDescriptor].cellDidSelectCallback = cellDidSelectCallback;
+}
+
+- (CPCollectionViewCellDataSizeBlock)sizeForDataCallback {
+    return _descriptor.sizeForDataCallback;
+}
+
+- (void)setSizeForDataCallback:(CPCollectionViewCellDataSizeBlock)sizeForDataCallback {
+    [self mutableDescriptor].sizeForDataCallback = sizeForDataCallback;
+    _hasPrecomputedSize = NO;
+}
+
+- (CPCollectionViewCellPrefetchBlock)prefetchCallback {
+    return _descriptor.prefetchCallback;
+}
+
+- (void)setPrefetchCallback:(CPCollectionViewCellPrefetchBlock)prefetchCallback {
+    [self mutableDescriptor].prefetchCallback = prefetchCallback;
+}
+
+- (CPCollectionViewCellCancelPrefetchBlock)cancelPrefetchCallback {
+    return _descriptor.cancelPrefetchCallback;
+}
+
+- (void)setCancelPrefetchCallback:(CPCollectionViewCellCancelPrefetchBlock)cancelPrefetchCallback {
+    [self mutableDescriptor].cancelPrefetchCallback = cancelPrefetchCallback;
+}
+
+#pragma mark - Setter
+
+- (void)setData:(__kindof NSObject *)data {
+    if (_data != data) {
+        _prefetchedResult = nil;
+        _hasPrefetchedResult = NO;
+    }
+    _data = data;
+    _hasPrecomputedSize = NO;
+}
+
+- (void)setContentFingerprint:(NSString *)contentFingerprint {
+    _contentFingerprint = [contentFingerprint copy];
+    _hasPrecomputedSize = NO;
+}
+
+#pragma mark - Precomputed Size
+
+- (BOOL)cp_getPrecomputedSize:(CGSize *)size preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    if (_hasPrecomputedSize && _precomputedLayoutDimension == preferredLayoutDimension && _precomputedLayoutValue == preferredLayoutValue) {
+        if (size) {
+            *size = _precomputedSize;
+        }
+        return YES;
+    }
+    
+    return NO;
+}
+
+- (void)cp_setPrecomputedSize:(CGSize)size preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    //only one preferred layout is kept, it is what a cell info is laid out with in practice
+    _precomputedSize = size;
+    _precomputedLayoutDimension = preferredLayoutDimension;
+    _precomputedLayoutValue = preferredLayoutValue;
+    _hasPrecomputedSize = YES;
+}
+
+- (void)cp_invalidatePrecomputedSize {
+    _hasPrecomputedSize = NO;
+}
 
 @end
@@ -0,0 +1,57 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPCollectionViewSectionInfo.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef CPCollectionViewCellInfo * _Nonnull (^CPCollectionViewCellInfoFactory)(NSUInteger index);
+
+/**
+ 按需构建cellInfo的section，由item数量与cellInfo工厂定义，适用于超大数据集
+ 只保留最近显示或预取的item附近windowSize个cellInfo，超出或收到内存警告时释放距离最远的cellInfo，再次访问时重新构建
+ item尺寸按index保存在section中 (每个item一个CGSize)，cellInfo释放后布局不会重新构建它，刷新或重新配置item时重新计算
+ item数量在创建后固定，不支持插入、追加、移动或删除item (调用时抛出NSInvalidArgumentException)，数据变化时请用新的lazy sectionInfo刷新该section；cp_reloadItem*接口可用
+ 注意：cellInfos会返回按需构建的数组，遍历会构建全部cellInfo，请使用cp_cellInfoAtIndex:
+ */
+@interface CPCollectionViewLazySectionInfo : CPCollectionViewSectionInfo
+
+@property (nonatomic, readonly) CPCollectionViewCellInfoFactory cellInfoFactory;
+@property (nonatomic) NSUInteger windowSize;//The default value of this property is 512
+@property (nonatomic, readonly) NSArray<CPCollectionViewCellInfo *> *loadedCellInfos;
+
+#pragma mark - Designated Initializer
+
+/**
+ @param numberOfItems   item数量
+ @param cellInfoFactory 根据index构建cellInfo的block，同一index需返回内容相同的cellInfo (在主线程调用)
+ */
+- (instancetype)initWithNumberOfItems:(NSUInteger)numberOfItems cellInfoFactory:(CPCollectionViewCellInfoFactory)cellInfoFactory NS_DESIGNATED_INITIALIZER;
+
+#pragma mark - Unloading
+
+- (void)cp_unloadCellInfosOutsideRange:(NSRange)range;//keeps cellInfos in range, e.g. the visible and prefetch range
+- (void)cp_unloadAllCellInfos;
+
+@end
+
+NS_ASSUME_NONNULL_END
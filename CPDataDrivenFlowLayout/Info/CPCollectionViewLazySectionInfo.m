@@ -0,0 +1,388 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPCollectionViewLazySectionInfo.h"
+
+@interface CPCollectionViewCellInfo ()
+
+@property (nonatomic, unsafe_unretained, nullable) CPCollectionViewSectionInfo *sectionInfo;
+
+@end
+
+@interface _CPLazyCellInfoArray : NSArray {
+    __weak CPCollectionViewLazySectionInfo *_sectionInfo;
+    NSUInteger _count;
+}
+
+- (instancetype)initWithSectionInfo:(CPCollectionViewLazySectionInfo *)sectionInfo count:(NSUInteger)count;
+
+@end
+
+@implementation _CPLazyCellInfoArray
+
+- (instancetype)initWithSectionInfo:(CPCollectionViewLazySectionInfo *)sectionInfo count:(NSUInteger)count {
+    self = [super init];
+    if (self) {
+        _sectionInfo = sectionInfo;
+        _count = count;
+    }
+    
+    return self;
+}
+
+- (NSUInteger)count {
+    return _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= _count) {
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)_count];
+    }
+    
+    return [_sectionInfo cp_cellInfoAtIndex:index];
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    //immutable, copying must not load every cellInfo
+    return self;
+}
+
+@end
+
+
+
+@interface _CPLazySectionInfoHandlers : NSObject
+
+@property (nonatomic, copy, nullable) void (^cellInfoDidLoadHandler)(CPCollectionViewCellInfo *cellInfo);
+@property (nonatomic, copy, nullable) void (^cellInfoWillUnloadHandler)(CPCollectionViewCellInfo *cellInfo);
+
+@end
+
+@implementation _CPLazySectionInfoHandlers
+
+@end
+
+
+@interface CPCollectionViewLazySectionInfo () {
+    NSUInteger _numberOfItems;
+    NSMutableDictionary<NSNumber *, CPCollectionViewCellInfo *> *_loadedCellInfosByIndex;
+    NSMapTable<CPCollectionViewCellInfo *, NSNumber *> *_indexesByLoadedCellInfo;
+    NSMutableIndexSet *_pinnedIndexes;//cellInfos replaced by cp_updateCellInfo:atIndex: can not be rebuilt by the factory, never unloaded
+    NSUInteger _anchorIndex;//last displayed or prefetched item, cellInfos farthest from it are unloaded first
+    _CPLazyCellInfoArray *_lazyCellInfos;
+    NSMapTable<id, _CPLazySectionInfoHandlers *> *_handlersByObserver;//weak keys, one entry per collection view showing the section
+    CGSize *_itemSizes;//by index, kept when cellInfos are unloaded so layout passes do not rebuild them
+    NSMutableIndexSet *_sizedIndexes;
+    CGSize _itemSizesReferenceSize;//collection view size the item sizes were computed for
+}
+
+- (BOOL)cp_hasHandlersForObserver:(id)observer;
+- (void)cp_setCellInfoDidLoadHandler:(void (^)(CPCollectionViewCellInfo *cellInfo))cellInfoDidLoadHandler
+           cellInfoWillUnloadHandler:(void (^)(CPCollectionViewCellInfo *cellInfo))cellInfoWillUnloadHandler
+                         forObserver:(id)observer;
+- (void)cp_removeHandlersForObserver:(id)observer;
+- (void)cp_setAnchorIndex:(NSUInteger)index;
+- (BOOL)cp_getItemSize:(CGSize *)size atIndex:(NSUInteger)index referenceSize:(CGSize)referenceSize;
+- (void)cp_setItemSize:(CGSize)size atIndex:(NSUInteger)index referenceSize:(CGSize)referenceSize;
+- (void)cp_invalidateItemSizes;
+
+@end
+
+@implementation CPCollectionViewLazySectionInfo
+
+#pragma mark - Designated Initializer
+
+- (instancetype)initWithNumberOfItems:(NSUInteger)numberOfItems cellInfoFactory:(CPCollectionViewCellInfoFactory)cellInfoFactory {
+    NSParameterAssert(cellInfoFactory);
+    
+    self = [super initWithCellInfos:@[]];
+    if (self) {
+        _numberOfItems = numberOfItems;
+        _cellInfoFactory = [cellInfoFactory copy];
+        _windowSize = 512;
+        _loadedCellInfosByIndex = [NSMutableDictionary new];
+        _indexesByLoadedCellInfo = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality
+                                                         valueOptions:NSPointerFunctionsStrongMemory];
+        _pinnedIndexes = [NSMutableIndexSet new];
+        _sizedIndexes = [NSMutableIndexSet new];
+        _handlersByObserver = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsWeakMemory|NSPointerFunctionsObjectPointerPersonality
+                                                    valueOptions:NSPointerFunctionsStrongMemory];
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    }
+    
+    return self;
+}
+
+- (instancetype)initWithCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos {
+    NSArray<CPCollectionViewCellInfo *> *allCellInfos = [cellInfos copy];
+    return [self initWithNumberOfItems:allCellInfos.count cellInfoFactory:^CPCollectionViewCellInfo * _Nonnull(NSUInteger index) {
+        return allCellInfos[index];
+    }];
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    for (CPCollectionViewCellInfo *cellInfo in _loadedCellInfosByIndex.allValues) {
+        if (cellInfo.sectionInfo == self) {
+            cellInfo.sectionInfo = nil;
+        }
+    }
+    free(_itemSizes);
+}
+
+#pragma mark - Getter
+
+- (NSInteger)numberOfItems {
+    return _numberOfItems;
+}
+
+- (NSArray<CPCollectionViewCellInfo *> *)cellInfos {
+    if (!_lazyCellInfos) {
+        _lazyCellInfos = [[_CPLazyCellInfoArray alloc] initWithSectionInfo:self count:_numberOfItems];
+    }
+    
+    return _lazyCellInfos;
+}
+
+- (NSArray<CPCollectionViewCellInfo *> *)loadedCellInfos {
+    return _loadedCellInfosByIndex.allValues;
+}
+
+- (nullable CPCollectionViewCellInfo *)cp_cellInfoAtIndex:(NSUInteger)index {
+    if (index >= _numberOfItems) {
+        return nil;
+    }
+    
+    CPCollectionViewCellInfo *cellInfo = _loadedCellInfosByIndex[@(index)];
+    if (!cellInfo) {
+        cellInfo = _cellInfoFactory(index);
+        NSAssert(cellInfo, @"cellInfoFactory must return a cellInfo for index - %lu", (unsigned long)index);
+        if (cellInfo) {
+            [self loadCellInfo:cellInfo atIndex:index];
+            if (_loadedCellInfosByIndex.count > MAX(_windowSize, 1)) {
+                //the window stays around the displayed items, not around the items layout asks for
+                //unload a quarter at once so the sort is amortized over many loads
+                [self unloadCellInfosFarthestFromIndex:_anchorIndex keepingCount:_windowSize - _windowSize / 4 exceptIndex:index];
+            }
+        }
+    }
+    
+    return cellInfo;
+}
+
+#pragma mark - Index
+
+- (NSUInteger)cp_indexOfCellInfo:(CPCollectionViewCellInfo *)cellInfo {
+    NSNumber *index = cellInfo ? [_indexesByLoadedCellInfo objectForKey:cellInfo] : nil;
+    return index ? index.unsignedIntegerValue : NSNotFound;
+}
+
+#pragma mark - Appending And Inserting
+
+- (void)cp_appendCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos {
+    [NSException raise:NSInvalidArgumentException format:@"items of CPCollectionViewLazySectionInfo can not be appended"];
+}
+
+- (void)cp_insertCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos atIndexSet:(NSIndexSet *)indexSet {
+    [NSException raise:NSInvalidArgumentException format:@"items of CPCollectionViewLazySectionInfo can not be inserted"];
+}
+
+#pragma mark - Update
+
+- (BOOL)cp_updateCellInfo:(CPCollectionViewCellInfo *)cellInfo atIndex:(NSUInteger)index {
+    NSAssert(index<_numberOfItems, @"index out of cellInfos bounds");
+    
+    if (index < _numberOfItems) {
+        CPCollectionViewCellInfo *oldCellInfo = _loadedCellInfosByIndex[@(index)];
+        if (oldCellInfo != cellInfo) {
+            if (oldCellInfo) {
+                [self unloadCellInfoAtIndex:index];
+            }
+            [self loadCellInfo:cellInfo atIndex:index];
+            [_pinnedIndexes addIndex:index];
+        }
+        //reloaded or reconfigured, the item is sized again
+        [_sizedIndexes removeIndex:index];
+        
+        return YES;
+    }
+    
+    return NO;
+}
+
+#pragma mark - Deleting
+
+- (void)cp_deleteCellInfosAtIndexSet:(NSIndexSet *)indexSet {
+    [NSException raise:NSInvalidArgumentException format:@"items of CPCollectionViewLazySectionInfo can not be deleted"];
+}
+
+- (void)cp_deleteCellInfo:(CPCollectionViewCellInfo *)cellInfo {
+    [NSException raise:NSInvalidArgumentException format:@"items of CPCollectionViewLazySectionInfo can not be deleted"];
+}
+
+#pragma mark - Unloading
+
+- (void)cp_unloadCellInfosOutsideRange:(NSRange)range {
+    for (NSNumber *index in _loadedCellInfosByIndex.allKeys) {
+        if (!NSLocationInRange(index.unsignedIntegerValue, range) && ![_pinnedIndexes containsIndex:index.unsignedIntegerValue]) {
+            [self unloadCellInfoAtIndex:index.unsignedIntegerValue];
+        }
+    }
+}
+
+- (void)cp_unloadAllCellInfos {
+    [self cp_unloadCellInfosOutsideRange:NSMakeRange(0, 0)];
+}
+
+- (void)didReceiveMemoryWarning:(NSNotification *)notification {
+    [self unloadCellInfosFarthestFromIndex:_anchorIndex keepingCount:_windowSize / 4 exceptIndex:NSNotFound];
+}
+
+#pragma mark - Observers
+
+- (BOOL)cp_hasHandlersForObserver:(id)observer {
+    return [_handlersByObserver objectForKey:observer] != nil;
+}
+
+- (void)cp_setCellInfoDidLoadHandler:(void (^)(CPCollectionViewCellInfo *))cellInfoDidLoadHandler cellInfoWillUnloadHandler:(void (^)(CPCollectionViewCellInfo *))cellInfoWillUnloadHandler forObserver:(id)observer {
+    _CPLazySectionInfoHandlers *handlers = [_CPLazySectionInfoHandlers new];
+    handlers.cellInfoDidLoadHandler = cellInfoDidLoadHandler;
+    handlers.cellInfoWillUnloadHandler = cellInfoWillUnloadHandler;
+    [_handlersByObserver setObject:handlers forKey:observer];
+}
+
+- (void)cp_removeHandlersForObserver:(id)observer {
+    [_handlersByObserver removeObjectForKey:observer];
+}
+
+#pragma mark - Anchor
+
+- (void)cp_setAnchorIndex:(NSUInteger)index {
+    _anchorIndex = index;
+}
+
+#pragma mark - Item Sizes
+
+- (BOOL)cp_getItemSize:(CGSize *)size atIndex:(NSUInteger)index referenceSize:(CGSize)referenceSize {
+    if (![_sizedIndexes containsIndex:index] || !CGSizeEqualToSize(referenceSize, _itemSizesReferenceSize)) {
+        return NO;
+    }
+    
+    if (size) {
+        *size = _itemSizes[index];
+    }
+    return YES;
+}
+
+- (void)cp_setItemSize:(CGSize)size atIndex:(NSUInteger)index referenceSize:(CGSize)referenceSize {
+    if (index >= _numberOfItems) {
+        return;
+    }
+    
+    if (!CGSizeEqualToSize(referenceSize, _itemSizesReferenceSize)) {
+        [_sizedIndexes removeAllIndexes];
+        _itemSizesReferenceSize = referenceSize;
+    }
+    if (!_itemSizes) {
+        _itemSizes = calloc(_numberOfItems, sizeof(CGSize));
+    }
+    _itemSizes[index] = size;
+    [_sizedIndexes addIndex:index];
+}
+
+- (void)cp_invalidateItemSizes {
+    [_sizedIndexes removeAllIndexes];
+}
+
+#pragma mark - Private
+
+- (NSArray<_CPLazySectionInfoHandlers *> *)liveHandlers {
+    //entries of deallocated collection views are skipped, handlers may change the table while they run
+    NSMutableArray *handlers = [NSMutableArray arrayWithCapacity:_handlersByObserver.count];
+    for (id observer in _handlersByObserver.keyEnumerator) {
+        _CPLazySectionInfoHandlers *observerHandlers = [_handlersByObserver objectForKey:observer];
+        if (observerHandlers) {
+            [handlers addObject:observerHandlers];
+        }
+    }
+    
+    return handlers;
+}
+
+- (void)loadCellInfo:(CPCollectionViewCellInfo *)cellInfo atIndex:(NSUInteger)index {
+    _loadedCellInfosByIndex[@(index)] = cellInfo;
+    [_indexesByLoadedCellInfo setObject:@(index) forKey:cellInfo];
+    cellInfo.sectionInfo = self;
+    for (_CPLazySectionInfoHandlers *handlers in [self liveHandlers]) {
+        if (handlers.cellInfoDidLoadHandler) {
+            handlers.cellInfoDidLoadHandler(cellInfo);
+        }
+    }
+}
+
+- (void)unloadCellInfoAtIndex:(NSUInteger)index {
+    CPCollectionViewCellInfo *cellInfo = _loadedCellInfosByIndex[@(index)];
+    if (!cellInfo) {
+        return;
+    }
+    
+    for (_CPLazySectionInfoHandlers *handlers in [self liveHandlers]) {
+        if (handlers.cellInfoWillUnloadHandler) {
+            handlers.cellInfoWillUnloadHandler(cellInfo);
+        }
+    }
+    [_loadedCellInfosByIndex removeObjectForKey:@(index)];
+    [_indexesByLoadedCellInfo removeObjectForKey:cellInfo];
+    [_pinnedIndexes removeIndex:index];
+    if (cellInfo.sectionInfo == self) {
+        cellInfo.sectionInfo = nil;
+    }
+}
+
+- (void)unloadCellInfosFarthestFromIndex:(NSUInteger)index keepingCount:(NSUInteger)keepingCount exceptIndex:(NSUInteger)exceptIndex {
+    if (_loadedCellInfosByIndex.count <= keepingCount) {
+        return;
+    }
+    
+    NSArray<NSNumber *> *sortedIndexes = [_loadedCellInfosByIndex.allKeys sortedArrayUsingComparator:^NSComparisonResult(NSNumber * _Nonnull obj1, NSNumber * _Nonnull obj2) {
+        NSUInteger distance1 = ABS((NSInteger)obj1.unsignedIntegerValue - (NSInteger)index);
+        NSUInteger distance2 = ABS((NSInteger)obj2.unsignedIntegerValue - (NSInteger)index);
+        if (distance1 == distance2) {
+            return NSOrderedSame;
+        }
+        return distance1 > distance2 ? NSOrderedAscending : NSOrderedDescending;//farthest first
+    }];
+    
+    NSUInteger unloadCount = _loadedCellInfosByIndex.count - keepingCount;
+    for (NSNumber *loadedIndex in sortedIndexes) {
+        if (unloadCount == 0) {
+            break;
+        }
+        if (loadedIndex.unsignedIntegerValue == exceptIndex || [_pinnedIndexes containsIndex:loadedIndex.unsignedIntegerValue]) {
+            continue;
+        }
+        [self unloadCellInfoAtIndex:loadedIndex.unsignedIntegerValue];
+        unloadCount--;
+    }
+}
+
+@end
@@ -0,0 +1,48 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPCollectionViewSectionInfo.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol _CPCollectionViewSectionInfoGeometryObserver <NSObject>
+
+- (void)sectionInfoGeometryDidChange:(CPCollectionViewSectionInfo *)sectionInfo;//numberOfItems, sectionInset or a spacing changed, main thread only
+
+@end
+
+/**
+ 库内共享的CPCollectionViewSectionInfo私有接口，不对外公开
+ */
+@interface CPCollectionViewSectionInfo ()
+
+@property (nonatomic, getter=isDetached) BOOL detached;//YES while owned by a snapshot, cellInfos are attached when it is applied
+@property (nonatomic, weak, nullable) CPCollectionViewSectionInfo *originalSectionInfo;//the section a snapshot copy is derived from, used to match both when applying
+@property (nonatomic, getter=isSharedWithSnapshot) BOOL sharedWithSnapshot;//YES once referenced by a snapshot, cp_* copies it before changing its items
+
+- (void)addGeometryObserver:(id<_CPCollectionViewSectionInfoGeometryObserver>)observer;//held weakly, one cp_sectionGeometry mirror per collection view showing it, copies do not inherit them
+- (instancetype)detachedCopy;//copy whose items can be changed on any queue, cellInfos are attached when applied
+- (void)attachCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -23,24 +23,27 @@
 #import <Foundation/Foundation.h>
 #import <UIKit/UIKit.h>
 #import "CPCollectionViewCellInfo.h"
+#import "CPCollectionViewSupplementaryViewDescriptor.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
-typedef void (^CPCollectionViewHeaderOrFooterBlock)(__kindof UICollectionView *collectionView, __kindof UICollectionReusableView *reusableView, NSInteger section);
-typedef CGSize (^CPCollectionViewSizeForHeaderOrFooterBlock)(__kindof UICollectionView *collectionView, __kindof UICollectionViewLayout *layout, CPCollectionViewPreferredLayoutBlock sizeByPreferredLayoutCalculator);
-
 @interface CPCollectionViewSectionInfo : NSObject
 
 @property (nonatomic, readonly) NSInteger numberOfItems;
-@property (nonatomic, readonly) NSArray<CPCollectionViewCellInfo *> *cellInfos;
+@property (nonatomic, readonly) NSArray<CPCollectionViewCellInfo *> *cellInfos;//immutable snapshot, rebuilt lazily after mutations
 
 @property (nonatomic, copy, nullable) NSString *identifier;//string used to identify section info
 @property (nonatomic) CGFloat minimumLineSpacing;//The default value of this property is 0
 @property (nonatomic) CGFloat minimumInteritemSpacing;//The default value of this property is 0
 @property (nonatomic) UIEdgeInsets sectionInset;//The default edge insets are all set to 0.
+@property (nonatomic) NSUInteger numberOfColumns;//waterfall columns used by CPDataDrivenLayout, spaced by minimumInteritemSpacing. The default value of this property is 0, which means flow layout
 
 @property (nonatomic, nullable) __kindof NSObject *data;
 
+@property (nonatomic, nullable) CPCollectionViewSupplementaryViewDescriptor *headerDescriptor;//may be shared by section infos, the header properties below are stored in it
+@property (nonatomic, nullable) CPCollectionViewSupplementaryViewDescriptor *footerDescriptor;//may be shared by section infos, the footer properties below are stored in it
+
+//setting the header or footer properties below copies the descriptor for this section info only
 @property (nonatomic, nullable) Class headerClass;
 @property (nonatomic, nullable) UINib *nibForHeader;
 @property (nonatomic, nullable) NSString *headerReuseIdentifier;
@@ -57,6 +60,12 @@ typedef CGSize (^CPCollectionViewSizeForHeaderOrFooterBlock)(__kindof UICollecti
 
 - (instancetype)initWithCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos NS_DESIGNATED_INITIALIZER;
 
+#pragma mark - Convenience Initializers With Descriptor
+
+- (instancetype)initWithCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos
+                 headerDescriptor:(nullable CPCollectionViewSupplementaryViewDescriptor *)headerDescriptor
+                 footerDescriptor:(nullable CPCollectionViewSupplementaryViewDescriptor *)footerDescriptor;
+
 #pragma mark - Convenience Initializers With Header
 
 - (instancetype)initWithCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos
@@ -83,6 +92,12 @@ typedef CGSize (^CPCollectionViewSizeForHeaderOrFooterBlock)(__kindof UICollecti
            footerDidReuseCallback:(CPCollectionViewHeaderOrFooterBlock)footerDidReuseCallback
             sizeForFooterCallback:(nullable CPCollectionViewSizeForHeaderOrFooterBlock)sizeForFooterCallback;
 
+#pragma mark - Index
+
+- (nullable CPCollectionViewCellInfo *)cp_cellInfoAtIndex:(NSUInteger)index;//return nil if out of bounds, does not build a cellInfos snapshot
+
+- (NSUInteger)cp_indexOfCellInfo:(CPCollectionViewCellInfo *)cellInfo;//return NSNotFound if not found
+
 #pragma mark - Appending And Inserting
 
 - (void)cp_appendCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos;
@@ -94,8 +109,8 @@ typedef CGSize (^CPCollectionViewSizeForHeaderOrFooterBlock)(__kindof UICollecti
 
 #pragma mark - Deleting
 
-- (void)cp_deleteCellInfosAtIndexSet:(NSIndexSet *)indexSet;
-- (void)cp_deleteCellInfo:(CPCollectionViewCellInfo *)cellInfo;
+- (void)cp_deleteCellInfosAtIndexSet:(NSIndexSet *)indexSet;//O(n + m), only the objects at indexSet are removed
+- (void)cp_deleteCellInfo:(CPCollectionViewCellInfo *)cellInfo;//removes the first occurrence
 
 @end
 
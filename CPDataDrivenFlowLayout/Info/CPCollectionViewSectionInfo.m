@@ -21,6 +21,37 @@
 // SOFTWARE.
 
 #import "CPCollectionViewSectionInfo.h"
+#import "CPCollectionViewSectionInfo+Private.h"
+#import "CPCollectionViewLazySectionInfo.h"
+
+@interface CPCollectionViewCellInfo ()
+
+@property (nonatomic, unsafe_unretained, nullable) CPCollectionViewSectionInfo *sectionInfo;
+
+@end
+
+@interface CPCollectionViewSupplementaryViewDescriptor ()
+
+@property (nonatomic, nullable) Class viewClass;
+@property (nonatomic, nullable) UINib *nib;
+@property (nonatomic, nullable) NSString *reuseIdentifier;
+
+@property (nonatomic, copy, nullable) CPCollectionViewHeaderOrFooterBlock didReuseCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewSizeForHeaderOrFooterBlock sizeCallback;
+
+@end
+
+@interface CPCollectionViewSectionInfo () {
+    NSMutableArray<CPCollectionViewCellInfo *> *_mutableCellInfos;
+    NSArray<CPCollectionViewCellInfo *> *_cellInfosSnapshot;//built lazily, nil after mutations
+    BOOL _ownsHeaderDescriptor;//NO while the descriptor may be shared, it is copied before the first change
+    BOOL _ownsFooterDescriptor;
+    NSHashTable<id<_CPCollectionViewSectionInfoGeometryObserver>> *_geometryObservers;//built lazily, a section may be shown in several collection views
+}
+
+@property (nonatomic, nullable) NSMapTable<CPCollectionViewCellInfo *, NSNumber *> *indexesByCellInfo;//built lazily, nil when invalid
+
+@end
 
 @implementation CPCollectionViewSectionInfo
 
@@ -30,8 +61,9 @@
     self = [super init];
     if (self) {
         NSParameterAssert(cellInfos);
-        _cellInfos = [cellInfos copy];
+        _mutableCellInfos = cellInfos ? [cellInfos mutableCopy] : [NSMutableArray new];
         _sectionInset = UIEdgeInsetsZero;
+        [self attachCellInfos:_mutableCellInfos];
     }
     
     return self;
@@ -44,6 +76,23 @@
     return self;
 }
 
+- (void)dealloc {
+    //the back references are not weak, a weak store per appended item is too expensive on bulk appends
+    [self detachCellInfos:_mutableCellInfos];
+}
+
+#pragma mark - Convenience Initializers With Descriptor
+
+- (instancetype)initWithCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos
+                 headerDescriptor:(nullable CPCollectionViewSupplementaryViewDescriptor *)headerDescriptor
+                 footerDescriptor:(nullable CPCollectionViewSupplementaryViewDescriptor *)footerDescriptor {
+    CPCollectionViewSectionInfo *sectionInfo = [self initWithCellInfos:cellInfos];
+    sectionInfo.headerDescriptor = headerDescriptor;
+    sectionInfo.footerDescriptor = footerDescriptor;
+    
+    return sectionInfo;
+}
+
 #pragma mark - Convenience Initializers With Header
 
 - (instancetype)initWithCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos
@@ -116,46 +165,304 @@
     return sectionInfo;
 }
 
+#pragma mark - Snapshot
+
+- (instancetype)detachedCopy {
+    NSAssert(![self isKindOfClass:[CPCollectionViewLazySectionInfo class]], @"items of a lazy section info can not be changed");
+    
+    //a section shared with snapshots is never changed in place and its immutable cellInfos are built on the main thread, so other queues only read them
+    NSAssert(_cellInfosSnapshot || _detached || [NSThread isMainThread], @"cellInfos of a section on screen must be built on the main thread before it is copied");
+    
+    CPCollectionViewSectionInfo *sectionInfo = [[CPCollectionViewSectionInfo alloc] initWithCellInfos:@[]];
+    sectionInfo->_detached = YES;
+    sectionInfo->_mutableCellInfos = [self.cellInfos mutableCopy];
+    sectionInfo->_originalSectionInfo = _originalSectionInfo ?: self;
+    sectionInfo->_identifier = [_identifier copy];
+    sectionInfo->_minimumLineSpacing = _minimumLineSpacing;
+    sectionInfo->_minimumInteritemSpacing = _minimumInteritemSpacing;
+    sectionInfo->_sectionInset = _sectionInset;
+    sectionInfo->_numberOfColumns = _numberOfColumns;
+    sectionInfo->_data = _data;
+    //the source may still own its descriptors, so the copy owns copies of them
+    sectionInfo->_headerDescriptor = [_headerDescriptor copy];
+    sectionInfo->_ownsHeaderDescriptor = YES;
+    sectionInfo->_footerDescriptor = [_footerDescriptor copy];
+    sectionInfo->_ownsFooterDescriptor = YES;
+    
+    return sectionInfo;
+}
+
+- (void)setDetached:(BOOL)detached {
+    BOOL shouldAttach = _detached && !detached;
+    _detached = detached;
+    if (shouldAttach) {
+        [self attachCellInfos:_mutableCellInfos];
+        self.indexesByCellInfo = nil;
+    }
+}
+
+#pragma mark - Header And Footer Descriptor
+
+- (void)setHeaderDescriptor:(CPCollectionViewSupplementaryViewDescriptor *)headerDescriptor {
+    _headerDescriptor = headerDescriptor;
+    _ownsHeaderDescriptor = NO;
+}
+
+- (void)setFooterDescriptor:(CPCollectionViewSupplementaryViewDescriptor *)footerDescriptor {
+    _footerDescriptor = footerDescriptor;
+    _ownsFooterDescriptor = NO;
+}
+
+- (CPCollectionViewSupplementaryViewDescriptor *)mutableHeaderDescriptor {
+    if (!_ownsHeaderDescriptor) {
+        _headerDescriptor = _headerDescriptor ? [_headerDescriptor copy] : [[CPCollectionViewSupplementaryViewDescriptor alloc] initWithViewClass:nil nib:nil reuseIdentifier:nil didReuseCallback:nil sizeCallback:nil];
+        _ownsHeaderDescriptor = YES;
+    }
+    
+    return _headerDescriptor;
+}
+
+- (CPCollectionViewSupplementaryViewDescriptor *)mutableFooterDescriptor {
+    if (!_ownsFooterDescriptor) {
+        _footerDescriptor = _footerDescriptor ? [_footerDescriptor copy] : [[CPCollectionViewSupplementaryViewDescriptor alloc] initWithViewClass:nil nib:nil reuseIdentifier:nil didReuseCallback:nil sizeCallback:nil];
+        _ownsFooterDescriptor = YES;
+    }
+    
+    return _footerDescriptor;
+}
+
+- (Class)headerClass {
+    return _headerDescriptor.viewClass;
+}
+
+- (void)setHeaderClass:(Class)headerClass {
+    [self mutableHeaderDescriptor].viewClass = headerClass;
+}
+
+- (UINib *)nibForHeader {
+    return _headerDescriptor.nib;
+}
+
+- (void)setNibForHeader:(UINib *)nibForHeader {
+    [self mutableHeaderDescriptor].nib = nibForHeader;
+}
+
+- (NSString *)headerReuseIdentifier {
+    return _headerDescriptor.reuseIdentifier;
+}
+
+- (void)setHeaderReuseIdentifier:(NSString *)headerReuseIdentifier {
+    [self mutableHeaderDescriptor].reuseIdentifier = headerReuseIdentifier;
+}
+
+- (CPCollectionViewSizeForHeaderOrFooterBlock)sizeForHeaderCallback {
+    return _headerDescriptor.sizeCallback;
+}
+
+- (void)setSizeForHeaderCallback:(CPCollectionViewSizeForHeaderOrFooterBlock)sizeForHeaderCallback {
+    [self mutableHeaderDescriptor].sizeCallback = sizeForHeaderCallback;
+}
+
+- (CPCollectionViewHeaderOrFooterBlock)headerDidReuseCallback {
+    return _headerDescriptor.didReuseCallback;
+}
+
+- (void)setHeaderDidReuseCallback:(CPCollectionViewHeaderOrFooterBlock)headerDidReuseCallback {
+    [self mutableHeaderDescriptor].didReuseCallback = headerDidReuseCallback;
+}
+
+- (Class)footerClass {
+    return _footerDescriptor.viewClass;
+}
+
+- (void)setFooterClass:(Class)footerClass {
+    [self mutableFooterDescriptor].viewClass = footerClass;
+}
+
+- (UINib *)nibForFooter {
+    return _footerDescriptor.nib;
+}
+
+- (void)setNibForFooter:(UINib *)nibForFooter {
+    [self mutableFooterDescriptor].nib = nibForFooter;
+}
+
+- (NSString *)footerReuseIdentifier {
+    return _footerDescriptor.reuseIdentifier;
+}
+
+- (void)setFooterReuseIdentifier:(NSString *)footerReuseIdentifier {
+    [self mutableFooterDescriptor].reuseIdentifier = footerReuseIdentifier;
+}
+
+- (CPCollectionViewSizeForHeaderOrFooterBlock)sizeForFooterCallback {
+    return _footerDescriptor.sizeCallback;
+}
+
+- (void)setSizeForFooterCallback:(CPCollectionViewSizeForHeaderOrFooterBlock)sizeForFooterCallback {
+    [self mutableFooterDescriptor].sizeCallback = sizeForFooterCallback;
+}
+
+- (CPCollectionViewHeaderOrFooterBlock)footerDidReuseCallback {
+    return _footerDescriptor.didReuseCallback;
+}
+
+- (void)setFooterDidReuseCallback:(CPCollectionViewHeaderOrFooterBlock)footerDidReuseCallback {
+    [self mutableFooterDescriptor].didReuseCallback = footerDidReuseCallback;
+}
+
+#pragma mark - Geometry
+
+- (void)setMinimumLineSpacing:(CGFloat)minimumLineSpacing {
+    _minimumLineSpacing = minimumLineSpacing;
+    [self geometryDidChange];
+}
+
+- (void)setMinimumInteritemSpacing:(CGFloat)minimumInteritemSpacing {
+    _minimumInteritemSpacing = minimumInteritemSpacing;
+    [self geometryDidChange];
+}
+
+- (void)setSectionInset:(UIEdgeInsets)sectionInset {
+    _sectionInset = sectionInset;
+    [self geometryDidChange];
+}
+
+- (void)addGeometryObserver:(id<_CPCollectionViewSectionInfoGeometryObserver>)observer {
+    if (!_geometryObservers) {
+        _geometryObservers = [NSHashTable hashTableWithOptions:NSPointerFunctionsWeakMemory|NSPointerFunctionsObjectPointerPersonality];
+    }
+    [_geometryObservers addObject:observer];
+}
+
+- (void)geometryDidChange {
+    //the mirrors of all collection views showing this section are told, detached copies have no observer
+    for (id<_CPCollectionViewSectionInfoGeometryObserver> observer in _geometryObservers) {
+        [observer sectionInfoGeometryDidChange:self];
+    }
+}
+
 #pragma mark - Getter
 
 - (NSInteger)numberOfItems {
-    if (self.cellInfos) {
-        return self.cellInfos.count;
+    return _mutableCellInfos.count;
+}
+
+- (NSArray<CPCollectionViewCellInfo *> *)cellInfos {
+    //mutations only touch the mutable storage, the immutable snapshot is rebuilt once when read
+    if (!_cellInfosSnapshot) {
+        _cellInfosSnapshot = [_mutableCellInfos copy];
+    }
+    
+    return _cellInfosSnapshot;
+}
+
+- (nullable CPCollectionViewCellInfo *)cp_cellInfoAtIndex:(NSUInteger)index {
+    if (index < _mutableCellInfos.count) {
+        return _mutableCellInfos[index];
+    }
+    
+    return nil;
+}
+
+- (void)cellInfosDidChange {
+    _cellInfosSnapshot = nil;
+}
+
+#pragma mark - Index
+
+- (NSUInteger)cp_indexOfCellInfo:(CPCollectionViewCellInfo *)cellInfo {
+    if (!cellInfo || cellInfo.sectionInfo != self) {
+        return NSNotFound;
+    }
+    
+    if (!self.indexesByCellInfo) {
+        [self buildIndexesByCellInfo];
+    }
+    
+    NSNumber *index = [self.indexesByCellInfo objectForKey:cellInfo];
+    if (index) {
+        return index.unsignedIntegerValue;
+    }
+    
+    return NSNotFound;
+}
+
+- (void)buildIndexesByCellInfo {
+    NSMapTable *indexesByCellInfo = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality
+                                                           valueOptions:NSPointerFunctionsStrongMemory];
+    //reverse enumerate so the first occurrence wins
+    [_mutableCellInfos enumerateObjectsWithOptions:NSEnumerationReverse usingBlock:^(CPCollectionViewCellInfo * _Nonnull cellInfo, NSUInteger idx, BOOL * _Nonnull stop) {
+        [indexesByCellInfo setObject:@(idx) forKey:cellInfo];
+    }];
+    self.indexesByCellInfo = indexesByCellInfo;
+}
+
+- (void)attachCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos {
+    if (_detached) {
+        //cellInfos may still belong to a section on screen, they are attached on the main thread when applied
+        return;
     }
     
-    return 0;
+    for (CPCollectionViewCellInfo *cellInfo in cellInfos) {
+        cellInfo.sectionInfo = self;
+    }
+}
+
+- (void)detachCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos {
+    if (_detached) {
+        return;
+    }
+    
+    for (CPCollectionViewCellInfo *cellInfo in cellInfos) {
+        if (cellInfo.sectionInfo == self) {
+            cellInfo.sectionInfo = nil;
+        }
+    }
 }
 
 #pragma mark - Appending And Inserting
 
 - (void)cp_appendCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos {
-    NSMutableArray *infos = [_cellInfos mutableCopy];
-    [infos addObjectsFromArray:cellInfos];
-    _cellInfos = [infos copy];
+    NSUInteger start = _mutableCellInfos.count;
+    [_mutableCellInfos addObjectsFromArray:cellInfos];
+    [self cellInfosDidChange];
+    [self geometryDidChange];
+    [self attachCellInfos:cellInfos];
+    
+    //appending does not shift existing indexes, so extend the index in place
+    [cellInfos enumerateObjectsUsingBlock:^(CPCollectionViewCellInfo * _Nonnull cellInfo, NSUInteger idx, BOOL * _Nonnull stop) {
+        if (![self.indexesByCellInfo objectForKey:cellInfo]) {
+            [self.indexesByCellInfo setObject:@(start+idx) forKey:cellInfo];
+        }
+    }];
 }
 
 - (void)cp_insertCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos atIndexSet:(NSIndexSet *)indexSet {
     NSAssert(cellInfos.count==indexSet.count, @"cellInfos count must equals to indexSet count");
     
-    NSMutableArray *infos = [_cellInfos mutableCopy];
-    __block NSUInteger index = 0;
-    [indexSet enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
-        [infos insertObject:cellInfos[index] atIndex:idx];
-        index++;
-    }];
-    
-    _cellInfos = [infos copy];
+    //single pass over the storage, indexes refer to the positions after insertion
+    [_mutableCellInfos insertObjects:cellInfos atIndexes:indexSet];
+    [self cellInfosDidChange];
+    [self geometryDidChange];
+    [self attachCellInfos:cellInfos];
+    self.indexesByCellInfo = nil;
 }
 
 #pragma mark - Update
 
 - (BOOL)cp_updateCellInfo:(CPCollectionViewCellInfo *)cellInfo atIndex:(NSUInteger)index {
-    NSAssert(index<[_cellInfos count], @"index out of cellInfos bounds");
+    NSAssert(index<[_mutableCellInfos count], @"index out of cellInfos bounds");
     
-    if (index < _cellInfos.count) {
-        NSMutableArray *infos = [_cellInfos mutableCopy];
-        infos[index] = cellInfo;
-        _cellInfos = [infos copy];
+    if (index < _mutableCellInfos.count) {
+        CPCollectionViewCellInfo *oldCellInfo = _mutableCellInfos[index];
+        if (oldCellInfo != cellInfo) {
+            _mutableCellInfos[index] = cellInfo;
+            [self cellInfosDidChange];
+            [self detachCellInfos:@[oldCellInfo]];
+            [self attachCellInfos:@[cellInfo]];
+            self.indexesByCellInfo = nil;
+        }
         
         return YES;
     }
@@ -166,20 +473,24 @@
 #pragma mark - Deleting
 
 - (void)cp_deleteCellInfosAtIndexSet:(NSIndexSet *)indexSet {
-    NSMutableArray *objectsForDelete = [NSMutableArray new];
-    [indexSet enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
-        [objectsForDelete addObject:[self.cellInfos objectAtIndex:idx]];
-    }];
+    if (indexSet.count == 0) {
+        return;
+    }
     
-    NSMutableArray *cellInfos = [_cellInfos mutableCopy];
-    [cellInfos removeObjectsInArray:objectsForDelete];
-    _cellInfos = [cellInfos copy];
+    //removes by position in a single pass, other occurrences of the same objects are kept
+    NSArray *objectsForDelete = [_mutableCellInfos objectsAtIndexes:indexSet];
+    [_mutableCellInfos removeObjectsAtIndexes:indexSet];
+    [self cellInfosDidChange];
+    [self geometryDidChange];
+    [self detachCellInfos:objectsForDelete];
+    self.indexesByCellInfo = nil;
 }
 
 - (void)cp_deleteCellInfo:(CPCollectionViewCellInfo *)cellInfo {
-    NSMutableArray *cellInfos = [_cellInfos mutableCopy];
-    [cellInfos removeObject:cellInfo];
-    _cellInfos = [cellInfos copy];
+    NSUInteger index = [self cp_indexOfCellInfo:cellInfo];
+    if (index != NSNotFound) {
+        [self cp_deleteCellInfosAtIndexSet:[NSIndexSet indexSetWithIndex:index]];
+    }
 }
 
 @end
@@ -0,0 +1,75 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "CPCollectionViewSectionInfo.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class CPCollectionViewMutableSnapshot;
+
+/**
+ 不可变的sectionInfo快照，可在任意线程创建、读取及mutableCopy，通过cp_applySnapshot:animated:在主线程一次性应用
+ 快照之间共享未修改的section与cellInfo，修改只复制被修改的section
+ 注意：快照中的cellInfo在多个快照间共享，请通过replaceCellInfo:atIndexPath:替换而非直接修改cellInfo的属性
+ */
+@interface CPCollectionViewSnapshot : NSObject <NSCopying, NSMutableCopying>
+
+@property (nonatomic, readonly) NSArray<CPCollectionViewSectionInfo *> *sectionInfos;
+@property (nonatomic, readonly) NSInteger numberOfSections;
+@property (nonatomic, readonly) NSInteger numberOfItems;
+
+- (instancetype)init;//empty snapshot
+- (instancetype)initWithSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos NS_DESIGNATED_INITIALIZER;
+
+- (NSInteger)numberOfItemsInSection:(NSInteger)section;
+- (nullable CPCollectionViewSectionInfo *)sectionInfoForSection:(NSInteger)section;//return nil if out of bounds
+- (nullable CPCollectionViewCellInfo *)cellInfoForItemAtIndexPath:(NSIndexPath *)indexPath;//return nil if out of bounds
+- (NSInteger)sectionForSectionIdentifier:(NSString *)identifier;//return -1 if not found, O(number of sections)
+
+@end
+
+/**
+ 可变快照，非线程安全，同一时间只能在一个队列中修改
+ 修改某个section的items时，该section在第一次修改前被复制一次，其余section与原快照共享
+ */
+@interface CPCollectionViewMutableSnapshot : CPCollectionViewSnapshot
+
+#pragma mark - Sections
+
+- (void)appendSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos;
+- (void)insertSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo inSection:(NSInteger)section;
+- (void)replaceSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo inSection:(NSInteger)section;
+- (void)moveSection:(NSInteger)section toSection:(NSInteger)newSection;
+- (void)deleteSectionsAtIndexSet:(NSIndexSet *)indexSet;
+
+#pragma mark - Items
+
+- (void)appendCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos inSection:(NSInteger)section;
+- (void)insertCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos inSection:(NSInteger)section atIndexSet:(NSIndexSet *)indexSet;
+- (void)replaceCellInfo:(CPCollectionViewCellInfo *)cellInfo atIndexPath:(NSIndexPath *)indexPath;
+- (void)moveItemAtIndexPath:(NSIndexPath *)indexPath toIndexPath:(NSIndexPath *)newIndexPath;//newIndexPath is the position after removing the item
+- (void)deleteItemsInSection:(NSInteger)section atIndexSet:(NSIndexSet *)indexSet;
+
+@end
+
+NS_ASSUME_NONNULL_END
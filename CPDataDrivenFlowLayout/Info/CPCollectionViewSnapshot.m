@@ -0,0 +1,271 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPCollectionViewSnapshot.h"
+#import "CPCollectionViewLazySectionInfo.h"
+#import "CPCollectionViewSectionInfo+Private.h"
+
+@interface CPCollectionViewSnapshot () {
+@protected
+    NSArray<CPCollectionViewSectionInfo *> *_sectionInfos;//NSMutableArray in mutable snapshot
+}
+
+- (void)shareSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos;
+
+@end
+
+@implementation CPCollectionViewSnapshot
+
+- (instancetype)init {
+    return [self initWithSectionInfos:@[]];
+}
+
+- (instancetype)initWithSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    self = [super init];
+    if (self) {
+        NSParameterAssert(sectionInfos);
+        _sectionInfos = [sectionInfos copy] ?: @[];
+        [self shareSectionInfos:_sectionInfos];
+    }
+    
+    return self;
+}
+
+- (void)shareSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    for (CPCollectionViewSectionInfo *sectionInfo in sectionInfos) {
+        //sections on screen are copied by cp_* before their items change, so the snapshot never changes underneath its readers
+        if (!sectionInfo.isSharedWithSnapshot && ![sectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]]) {
+            sectionInfo.sharedWithSnapshot = YES;
+        }
+    }
+}
+
+#pragma mark - Getter
+
+- (NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    return _sectionInfos;
+}
+
+- (NSInteger)numberOfSections {
+    return _sectionInfos.count;
+}
+
+- (NSInteger)numberOfItems {
+    NSInteger numberOfItems = 0;
+    for (CPCollectionViewSectionInfo *sectionInfo in _sectionInfos) {
+        numberOfItems += sectionInfo.numberOfItems;
+    }
+    
+    return numberOfItems;
+}
+
+- (NSInteger)numberOfItemsInSection:(NSInteger)section {
+    return [self sectionInfoForSection:section].numberOfItems;
+}
+
+- (CPCollectionViewSectionInfo *)sectionInfoForSection:(NSInteger)section {
+    if (section >= 0 && section < _sectionInfos.count) {
+        return _sectionInfos[section];
+    }
+    
+    return nil;
+}
+
+- (CPCollectionViewCellInfo *)cellInfoForItemAtIndexPath:(NSIndexPath *)indexPath {
+    return [[self sectionInfoForSection:indexPath.section] cp_cellInfoAtIndex:indexPath.item];
+}
+
+- (NSInteger)sectionForSectionIdentifier:(NSString *)identifier {
+    NSUInteger section = [_sectionInfos indexOfObjectPassingTest:^BOOL(CPCollectionViewSectionInfo * _Nonnull sectionInfo, NSUInteger idx, BOOL * _Nonnull stop) {
+        return [sectionInfo.identifier isEqualToString:identifier];
+    }];
+    
+    return section == NSNotFound ? -1 : section;
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    return self;
+}
+
+- (id)mutableCopyWithZone:(NSZone *)zone {
+    return [[CPCollectionViewMutableSnapshot allocWithZone:zone] initWithSectionInfos:_sectionInfos];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; sections = %ld>", NSStringFromClass([self class]), self, (long)_sectionInfos.count];
+}
+
+@end
+
+
+@interface CPCollectionViewMutableSnapshot () {
+    NSHashTable<CPCollectionViewSectionInfo *> *_ownedSectionInfos;//copies made by this snapshot, changed in place until the next copy
+}
+
+@end
+
+@implementation CPCollectionViewMutableSnapshot
+
+- (instancetype)initWithSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    self = [super initWithSectionInfos:sectionInfos];
+    if (self) {
+        _sectionInfos = [_sectionInfos mutableCopy];
+        _ownedSectionInfos = [NSHashTable hashTableWithOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality];
+    }
+    
+    return self;
+}
+
+- (NSMutableArray<CPCollectionViewSectionInfo *> *)mutableSectionInfos {
+    return (NSMutableArray *)_sectionInfos;
+}
+
+- (NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    return [_sectionInfos copy];
+}
+
+- (CPCollectionViewSectionInfo *)mutableSectionInfoInSection:(NSInteger)section {
+    CPCollectionViewSectionInfo *sectionInfo = _sectionInfos[section];
+    if (![_ownedSectionInfos containsObject:sectionInfo]) {
+        //copy on first write, sections which are not changed stay shared with other snapshots
+        sectionInfo = [sectionInfo detachedCopy];
+        [_ownedSectionInfos addObject:sectionInfo];
+        [self mutableSectionInfos][section] = sectionInfo;
+    }
+    
+    return sectionInfo;
+}
+
+- (BOOL)isValidSection:(NSInteger)section {
+    NSAssert(section >= 0 && section < _sectionInfos.count, @"section %ld out of bounds", (long)section);
+    
+    return section >= 0 && section < _sectionInfos.count;
+}
+
+- (void)prepareSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    for (CPCollectionViewSectionInfo *sectionInfo in sectionInfos) {
+        //builds the immutable cellInfos once, so the snapshot is only read afterwards
+        [sectionInfo cellInfos];
+    }
+    [self shareSectionInfos:sectionInfos];
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    //owned copies become shared with the immutable snapshot, they are copied again before the next change
+    [self prepareSectionInfos:_ownedSectionInfos.allObjects];
+    [_ownedSectionInfos removeAllObjects];
+    
+    return [[CPCollectionViewSnapshot allocWithZone:zone] initWithSectionInfos:_sectionInfos];
+}
+
+#pragma mark - Sections
+
+- (void)appendSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    [self prepareSectionInfos:sectionInfos];
+    [[self mutableSectionInfos] addObjectsFromArray:sectionInfos];
+}
+
+- (void)insertSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo inSection:(NSInteger)section {
+    NSParameterAssert(sectionInfo);
+    NSAssert(section >= 0 && section <= _sectionInfos.count, @"section %ld out of bounds", (long)section);
+    
+    if (sectionInfo && section >= 0 && section <= _sectionInfos.count) {
+        [self prepareSectionInfos:@[sectionInfo]];
+        [[self mutableSectionInfos] insertObject:sectionInfo atIndex:section];
+    }
+}
+
+- (void)replaceSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo inSection:(NSInteger)section {
+    NSParameterAssert(sectionInfo);
+    
+    if (sectionInfo && [self isValidSection:section]) {
+        [self prepareSectionInfos:@[sectionInfo]];
+        [_ownedSectionInfos removeObject:_sectionInfos[section]];
+        [self mutableSectionInfos][section] = sectionInfo;
+    }
+}
+
+- (void)moveSection:(NSInteger)section toSection:(NSInteger)newSection {
+    if ([self isValidSection:section] && [self isValidSection:newSection]) {
+        CPCollectionViewSectionInfo *sectionInfo = _sectionInfos[section];
+        [[self mutableSectionInfos] removeObjectAtIndex:section];
+        [[self mutableSectionInfos] insertObject:sectionInfo atIndex:newSection];
+    }
+}
+
+- (void)deleteSectionsAtIndexSet:(NSIndexSet *)indexSet {
+    NSAssert(indexSet.count == 0 || indexSet.lastIndex < _sectionInfos.count, @"indexSet out of bounds");
+    
+    if (indexSet.count > 0 && indexSet.lastIndex < _sectionInfos.count) {
+        for (CPCollectionViewSectionInfo *sectionInfo in [_sectionInfos objectsAtIndexes:indexSet]) {
+            [_ownedSectionInfos removeObject:sectionInfo];
+        }
+        [[self mutableSectionInfos] removeObjectsAtIndexes:indexSet];
+    }
+}
+
+#pragma mark - Items
+
+- (void)appendCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos inSection:(NSInteger)section {
+    if ([self isValidSection:section]) {
+        [[self mutableSectionInfoInSection:section] cp_appendCellInfos:cellInfos];
+    }
+}
+
+- (void)insertCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos inSection:(NSInteger)section atIndexSet:(NSIndexSet *)indexSet {
+    if ([self isValidSection:section]) {
+        [[self mutableSectionInfoInSection:section] cp_insertCellInfos:cellInfos atIndexSet:indexSet];
+    }
+}
+
+- (void)replaceCellInfo:(CPCollectionViewCellInfo *)cellInfo atIndexPath:(NSIndexPath *)indexPath {
+    NSParameterAssert(cellInfo);
+    
+    if (cellInfo && [self isValidSection:indexPath.section]) {
+        [[self mutableSectionInfoInSection:indexPath.section] cp_updateCellInfo:cellInfo atIndex:indexPath.item];
+    }
+}
+
+- (void)moveItemAtIndexPath:(NSIndexPath *)indexPath toIndexPath:(NSIndexPath *)newIndexPath {
+    if (![self isValidSection:indexPath.section] || ![self isValidSection:newIndexPath.section]) {
+        return;
+    }
+    
+    CPCollectionViewCellInfo *cellInfo = [_sectionInfos[indexPath.section] cp_cellInfoAtIndex:indexPath.item];
+    NSAssert(cellInfo, @"indexPath %@ out of bounds", indexPath);
+    if (cellInfo) {
+        [[self mutableSectionInfoInSection:indexPath.section] cp_deleteCellInfosAtIndexSet:[NSIndexSet indexSetWithIndex:indexPath.item]];
+        [[self mutableSectionInfoInSection:newIndexPath.section] cp_insertCellInfos:@[cellInfo] atIndexSet:[NSIndexSet indexSetWithIndex:newIndexPath.item]];
+    }
+}
+
+- (void)deleteItemsInSection:(NSInteger)section atIndexSet:(NSIndexSet *)indexSet {
+    if ([self isValidSection:section]) {
+        [[self mutableSectionInfoInSection:section] cp_deleteCellInfosAtIndexSet:indexSet];
+    }
+}
+
+@end
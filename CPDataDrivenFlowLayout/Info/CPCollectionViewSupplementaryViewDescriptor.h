@@ -0,0 +1,77 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+#import "CPCollectionViewCellDescriptor.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^CPCollectionViewHeaderOrFooterBlock)(__kindof UICollectionView *collectionView, __kindof UICollectionReusableView *reusableView, NSInteger section);
+typedef CGSize (^CPCollectionViewSizeForHeaderOrFooterBlock)(__kindof UICollectionView *collectionView, __kindof UICollectionViewLayout *layout, CPCollectionViewPreferredLayoutBlock sizeByPreferredLayoutCalculator);
+
+/**
+ 一种header或footer的共享描述 (class或nib、reuseIdentifier及回调)，创建一次后由多个sectionInfo共享
+ 修改sectionInfo上的header/footer属性时会为该sectionInfo复制一份descriptor，不影响其他sectionInfo
+ */
+@interface CPCollectionViewSupplementaryViewDescriptor : NSObject <NSCopying>
+
+@property (nonatomic, readonly, nullable) Class viewClass;
+@property (nonatomic, readonly, nullable) UINib *nib;
+@property (nonatomic, readonly, nullable) NSString *reuseIdentifier;
+
+@property (nonatomic, copy, readonly, nullable) CPCollectionViewHeaderOrFooterBlock didReuseCallback;
+@property (nonatomic, copy, readonly, nullable) CPCollectionViewSizeForHeaderOrFooterBlock sizeCallback;
+
+#pragma mark - Designated Initializer
+
+- (instancetype)initWithViewClass:(nullable Class)viewClass
+                              nib:(nullable UINib *)nib
+                  reuseIdentifier:(nullable NSString *)reuseIdentifier
+                 didReuseCallback:(nullable CPCollectionViewHeaderOrFooterBlock)didReuseCallback
+                     sizeCallback:(nullable CPCollectionViewSizeForHeaderOrFooterBlock)sizeCallback NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+#pragma mark - Convenience Initializers
+
+/**
+ 根据class创建descriptor，reuseIdentifier与sectionInfo的header/footer默认值一致
+
+ @param viewClass        header或footer的class
+ @param kind             UICollectionElementKindSectionHeader或UICollectionElementKindSectionFooter
+ @param didReuseCallback 复用回调
+ @param sizeCallback     尺寸回调
+ */
+- (instancetype)initWithViewClass:(Class)viewClass
+                           ofKind:(NSString *)kind
+                 didReuseCallback:(CPCollectionViewHeaderOrFooterBlock)didReuseCallback
+                     sizeCallback:(nullable CPCollectionViewSizeForHeaderOrFooterBlock)sizeCallback;
+
+- (instancetype)initWithNib:(UINib *)nib
+            reuseIdentifier:(NSString *)reuseIdentifier
+           didReuseCallback:(CPCollectionViewHeaderOrFooterBlock)didReuseCallback
+               sizeCallback:(nullable CPCollectionViewSizeForHeaderOrFooterBlock)sizeCallback;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPCollectionViewSupplementaryViewDescriptor.h"
+
+@interface CPCollectionViewSupplementaryViewDescriptor ()
+
+@property (nonatomic, nullable) Class viewClass;
+@property (nonatomic, nullable) UINib *nib;
+@property (nonatomic, nullable) NSString *reuseIdentifier;
+
+@property (nonatomic, copy, nullable) CPCollectionViewHeaderOrFooterBlock didReuseCallback;
+@property (nonatomic, copy, nullable) CPCollectionViewSizeForHeaderOrFooterBlock sizeCallback;
+
+@end
+
+@implementation CPCollectionViewSupplementaryViewDescriptor
+
+#pragma mark - Designated Initializer
+
+- (instancetype)initWithViewClass:(Class)viewClass nib:(UINib *)nib reuseIdentifier:(NSString *)reuseIdentifier didReuseCallback:(CPCollectionViewHeaderOrFooterBlock)didReuseCallback sizeCallback:(CPCollectionViewSizeForHeaderOrFooterBlock)sizeCallback {
+    self = [super init];
+    if (self) {
+        _viewClass = viewClass;
+        _nib = nib;
+        _reuseIdentifier = [reuseIdentifier copy];
+        _didReuseCallback = [didReuseCallback copy];
+        _sizeCallback = [sizeCallback copy];
+    }
+    
+    return self;
+}
+
+#pragma mark - Convenience Initializers
+
+- (instancetype)initWithViewClass:(Class)viewClass ofKind:(NSString *)kind didReuseCallback:(CPCollectionViewHeaderOrFooterBlock)didReuseCallback sizeCallback:(CPCollectionViewSizeForHeaderOrFooterBlock)sizeCallback {
+    NSParameterAssert(viewClass);
+    NSParameterAssert(didReuseCallback);
+    NSAssert([kind isEqualToString:UICollectionElementKindSectionHeader] || [kind isEqualToString:UICollectionElementKindSectionFooter], @"kind must be header or footer");
+    
+    NSString *suffix = [kind isEqualToString:UICollectionElementKindSectionFooter] ? @"_FooterReuseIdentifier" : @"_HeaderReuseIdentifier";
+    return [self initWithViewClass:viewClass
+                               nib:nil
+                   reuseIdentifier:[NSStringFromClass(viewClass) stringByAppendingString:suffix]
+                  didReuseCallback:didReuseCallback
+                      sizeCallback:sizeCallback];
+}
+
+- (instancetype)initWithNib:(UINib *)nib reuseIdentifier:(NSString *)reuseIdentifier didReuseCallback:(CPCollectionViewHeaderOrFooterBlock)didReuseCallback sizeCallback:(CPCollectionViewSizeForHeaderOrFooterBlock)sizeCallback {
+    NSParameterAssert(nib);
+    NSParameterAssert(reuseIdentifier);
+    NSParameterAssert(didReuseCallback);
+    
+    return [self initWithViewClass:nil
+                               nib:nib
+                   reuseIdentifier:reuseIdentifier
+                  didReuseCallback:didReuseCallback
+                      sizeCallback:sizeCallback];
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    return [[[self class] allocWithZone:zone] initWithViewClass:_viewClass
+                                                            nib:_nib
+                                                reuseIdentifier:_reuseIdentifier
+                                               didReuseCallback:_didReuseCallback
+                                                   sizeCallback:_sizeCallback];
+}
+
+@end
@@ -23,6 +23,32 @@
 #import <Foundation/Foundation.h>
 #import <UIKit/UIKit.h>
 
+//UICollectionViewDataSourcePrefetching needs the iOS 10 SDK, at runtime it is only used when UICollectionView responds to setPrefetchDataSource:
+#if __IPHONE_OS_VERSION_MAX_ALLOWED >= 100000
+#define CP_PREFETCHING_AVAILABLE 1
+#else
+#define CP_PREFETCHING_AVAILABLE 0
+#endif
+
+#if CP_PREFETCHING_AVAILABLE
+@interface CPCollectionViewDataSourceInterceptor : NSObject <UICollectionViewDataSource, UICollectionViewDataSourcePrefetching>
+#else
 @interface CPCollectionViewDataSourceInterceptor : NSObject <UICollectionViewDataSource>
+#endif
+
+/**
+ 同时进行的预取数量，超出的cellInfo排队等待，默认为4
+ 预取调用cellInfo的prefetchCallback，同一cellInfo同一data同时只有一个预取，结果保存在cellInfo的prefetchedResult
+ 已开始的预取被取消后，直到其completion被调用才释放名额，cancelPrefetchCallback中也须保证completion最终被调用；在此之前再次预取该item时，会在completion之后重新预取
+ */
+@property (nonatomic) NSUInteger maximumConcurrentPrefetches;
+
+/**
+ 保留prefetchedResult的cellInfo数量上限，默认为200，0表示不限制
+ 超出时按LRU清除最久未显示的cellInfo的prefetchedResult，收到内存警告时全部清除，被清除的cellInfo再次出现前会重新预取
+ */
+@property (nonatomic) NSUInteger prefetchedResultCountLimit;
+
+- (void)removeAllPrefetchedResults;
 
 @end
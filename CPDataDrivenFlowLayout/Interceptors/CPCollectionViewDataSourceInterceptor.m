@@ -22,21 +22,82 @@
 
 #import "CPCollectionViewDataSourceInterceptor.h"
 #import "UICollectionView+CPDataDrivenFlowLayout.h"
+#import "UICollectionView+CPMetrics.h"
+#import "CPCollectionViewLazySectionInfo.h"
 
-@implementation CPCollectionViewDataSourceInterceptor
+@interface CPCollectionViewLazySectionInfo ()
+
+- (void)cp_setAnchorIndex:(NSUInteger)index;
+
+@end
+
+@interface CPCollectionViewCellInfo ()
+
+@property (nonatomic, nullable) id prefetchedResult;
+@property (nonatomic) BOOL hasPrefetchedResult;
+
+@end
+
+@interface _CPCellInfoPrefetchRequest : NSObject
+
+@property (nonatomic, strong) CPCollectionViewCellInfo *cellInfo;
+@property (nonatomic, strong) id data;//data at the time of the request, the result is dropped if it changes
+@property (nonatomic, weak) UICollectionView *collectionView;
+@property (nonatomic, getter=isRunning) BOOL running;
+@property (nonatomic, getter=isCancelled) BOOL cancelled;//the result is dropped, the running slot is released by the completion
+@property (nonatomic) BOOL requestedAgain;//prefetched again while cancelled, a new request is queued once the completion arrives
+
+@end
+
+@implementation _CPCellInfoPrefetchRequest
+
+@end
+
+@implementation CPCollectionViewDataSourceInterceptor {
+    NSMapTable<CPCollectionViewCellInfo *, _CPCellInfoPrefetchRequest *> *_prefetchRequestsByCellInfo;
+    NSMutableArray<_CPCellInfoPrefetchRequest *> *_pendingPrefetchRequests;
+    NSUInteger _numberOfRunningPrefetches;
+    NSMutableOrderedSet<CPCollectionViewCellInfo *> *_cellInfosWithPrefetchedResult;//least recently displayed first, cellInfo does not override isEqual:
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        _maximumConcurrentPrefetches = 4;
+        _prefetchRequestsByCellInfo = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                            valueOptions:NSPointerFunctionsStrongMemory];
+        _pendingPrefetchRequests = [NSMutableArray array];
+        _prefetchedResultCountLimit = 200;
+        _cellInfosWithPrefetchedResult = [NSMutableOrderedSet orderedSet];
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(removeAllPrefetchedResults) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)setPrefetchedResultCountLimit:(NSUInteger)prefetchedResultCountLimit {
+    _prefetchedResultCountLimit = prefetchedResultCountLimit;
+    [self trimPrefetchedResultsToLimit];
+}
 
 - (NSInteger)numberOfSectionsInCollectionView:(UICollectionView *)collectionView {
-    if ([collectionView cp_sectionInfos].count > 0) {
-        return [collectionView cp_sectionInfos].count;
+    NSInteger numberOfSections = [collectionView cp_sectionGeometry]->numberOfSections;
+    if (numberOfSections > 0) {
+        return numberOfSections;
     }
     
     return 1;
 }
 
 - (NSInteger)collectionView:(UICollectionView *)collectionView numberOfItemsInSection:(NSInteger)section {
-    CPCollectionViewSectionInfo *sectionInfo = [collectionView cp_sectionInfoForSection:section];
-    if (sectionInfo) {
-        return sectionInfo.numberOfItems;
+    const CPCollectionViewSectionGeometry *geometry = [collectionView cp_sectionGeometry];
+    if (section >= 0 && section < geometry->numberOfSections) {
+        return geometry->numberOfItems[section];
     }
     
     return 0;
@@ -44,11 +105,30 @@
 
 //cell
 - (UICollectionViewCell *)collectionView:(UICollectionView *)collectionView cellForItemAtIndexPath:(NSIndexPath *)indexPath {
+    [self anchorLazySectionInfoOfCollectionView:collectionView atIndexPath:indexPath];
     CPCollectionViewCellInfo *cellInfo = [collectionView cp_cellInfoForItemAtIndexPath:indexPath];
     if (cellInfo) {
+        CPCollectionViewMetrics *metrics = collectionView.cp_metrics;
+        CPMetricsInterval interval = [metrics beginInterval:CPCollectionViewMetricsEventDequeue reuseIdentifier:cellInfo.cellReuseIdentifier];
         UICollectionViewCell *cell = [collectionView dequeueReusableCellWithReuseIdentifier:cellInfo.cellReuseIdentifier forIndexPath:indexPath];
+        [metrics endInterval:interval event:CPCollectionViewMetricsEventDequeue reuseIdentifier:cellInfo.cellReuseIdentifier];
+        
+        if (cellInfo.hasPrefetchedResult) {
+            [self touchPrefetchedResultOfCellInfo:cellInfo];
+        }
+        
         if (cellInfo.cellDidReuseCallback) {
+            interval = [metrics beginInterval:CPCollectionViewMetricsEventConfiguration reuseIdentifier:cellInfo.cellReuseIdentifier];
             cellInfo.cellDidReuseCallback(collectionView, cell, indexPath, cellInfo.data);
+            [metrics endInterval:interval event:CPCollectionViewMetricsEventConfiguration reuseIdentifier:cellInfo.cellReuseIdentifier];
+        }
+        
+        if (cellInfo.isSizeEstimated) {
+            //the cell is about to appear, measure it and correct the layout afterwards
+            id delegate = collectionView.delegate;
+            if ([delegate respondsToSelector:@selector(collectionView:measureEstimatedItemAtIndexPath:)]) {
+                [(CPCollectionViewDelegateFlowLayoutInterceptor *)delegate collectionView:collectionView measureEstimatedItemAtIndexPath:indexPath];
+            }
         }
         
         return cell;
@@ -61,23 +141,35 @@
 - (UICollectionReusableView *)collectionView:(UICollectionView *)collectionView viewForSupplementaryElementOfKind:(NSString *)kind atIndexPath:(NSIndexPath *)indexPath {
     CPCollectionViewSectionInfo *sectionInfo = [collectionView cp_sectionInfoForSection:indexPath.section];
     if (sectionInfo) {
+        CPCollectionViewMetrics *metrics = collectionView.cp_metrics;
+        CPMetricsInterval interval;
         if (sectionInfo.headerReuseIdentifier && [kind isEqualToString:UICollectionElementKindSectionHeader]) {
             //header
+            interval = [metrics beginInterval:CPCollectionViewMetricsEventDequeue reuseIdentifier:sectionInfo.headerReuseIdentifier];
             UICollectionReusableView *header = [collectionView dequeueReusableSupplementaryViewOfKind:kind
                                                                                   withReuseIdentifier:sectionInfo.headerReuseIdentifier
                                                                                          forIndexPath:indexPath];
+            [metrics endInterval:interval event:CPCollectionViewMetricsEventDequeue reuseIdentifier:sectionInfo.headerReuseIdentifier];
+            
             if (sectionInfo.headerDidReuseCallback) {
+                interval = [metrics beginInterval:CPCollectionViewMetricsEventConfiguration reuseIdentifier:sectionInfo.headerReuseIdentifier];
                 sectionInfo.headerDidReuseCallback(collectionView, header, indexPath.section);
+                [metrics endInterval:interval event:CPCollectionViewMetricsEventConfiguration reuseIdentifier:sectionInfo.headerReuseIdentifier];
             }
             return header;
             
         } else if (sectionInfo.footerReuseIdentifier && [kind isEqualToString:UICollectionElementKindSectionFooter]) {
             //footer
+            interval = [metrics beginInterval:CPCollectionViewMetricsEventDequeue reuseIdentifier:sectionInfo.footerReuseIdentifier];
             UICollectionReusableView *footer = [collectionView dequeueReusableSupplementaryViewOfKind:kind
                                                                                   withReuseIdentifier:sectionInfo.footerReuseIdentifier
                                                                                          forIndexPath:indexPath];
+            [metrics endInterval:interval event:CPCollectionViewMetricsEventDequeue reuseIdentifier:sectionInfo.footerReuseIdentifier];
+            
             if (sectionInfo.footerDidReuseCallback) {
+                interval = [metrics beginInterval:CPCollectionViewMetricsEventConfiguration reuseIdentifier:sectionInfo.footerReuseIdentifier];
                 sectionInfo.footerDidReuseCallback(collectionView, footer, indexPath.section);
+                [metrics endInterval:interval event:CPCollectionViewMetricsEventConfiguration reuseIdentifier:sectionInfo.footerReuseIdentifier];
             }
             return footer;
         }
@@ -86,4 +178,179 @@
     return [collectionView dequeueReusableSupplementaryViewOfKind:kind withReuseIdentifier:_CPPlaceholderSupplementaryView forIndexPath:indexPath];
 }
 
+#if CP_PREFETCHING_AVAILABLE
+
+#pragma mark - UICollectionViewDataSourcePrefetching
+
+- (void)collectionView:(UICollectionView *)collectionView prefetchItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    for (NSIndexPath *indexPath in indexPaths) {
+        [self anchorLazySectionInfoOfCollectionView:collectionView atIndexPath:indexPath];
+        CPCollectionViewCellInfo *cellInfo = [collectionView cp_cellInfoForItemAtIndexPath:indexPath];
+        if (!cellInfo.prefetchCallback || cellInfo.hasPrefetchedResult) {
+            //nothing to do, already prefetched
+            continue;
+        }
+        
+        _CPCellInfoPrefetchRequest *request = [_prefetchRequestsByCellInfo objectForKey:cellInfo];
+        if (request && !request.isCancelled) {
+            //already requested
+            continue;
+        }
+        if (request && request.data == cellInfo.data) {
+            //the cancelled work for the same data is still running, do not start it twice
+            request.requestedAgain = YES;
+            continue;
+        }
+        
+        [self enqueuePrefetchRequestForCellInfo:cellInfo collectionView:collectionView atFront:NO];
+    }
+    
+    [self startPendingPrefetches];
+}
+
+- (void)collectionView:(UICollectionView *)collectionView cancelPrefetchingForItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    for (NSIndexPath *indexPath in indexPaths) {
+        CPCollectionViewCellInfo *cellInfo = [collectionView cp_cellInfoForItemAtIndexPath:indexPath];
+        _CPCellInfoPrefetchRequest *request = cellInfo ? [_prefetchRequestsByCellInfo objectForKey:cellInfo] : nil;
+        if (!request) {
+            continue;
+        }
+        if (request.isCancelled) {
+            request.requestedAgain = NO;
+            continue;
+        }
+        
+        if (request.isRunning) {
+            //the work may still be running, keep its slot and its entry until the completion arrives
+            request.cancelled = YES;
+            if (cellInfo.cancelPrefetchCallback) {
+                cellInfo.cancelPrefetchCallback(request.data);
+            }
+        } else {
+            [_prefetchRequestsByCellInfo removeObjectForKey:cellInfo];
+            [_pendingPrefetchRequests removeObjectIdenticalTo:request];
+        }
+    }
+    
+    [self startPendingPrefetches];
+}
+
+#endif
+
+#pragma mark - Lazy Section Info
+
+- (void)anchorLazySectionInfoOfCollectionView:(UICollectionView *)collectionView atIndexPath:(NSIndexPath *)indexPath {
+    //cellInfos of a lazy section are kept around displayed and prefetched items, layout queries do not move the window
+    CPCollectionViewSectionInfo *sectionInfo = [collectionView cp_sectionInfoForSection:indexPath.section];
+    if ([sectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]]) {
+        [(CPCollectionViewLazySectionInfo *)sectionInfo cp_setAnchorIndex:indexPath.item];
+    }
+}
+
+#pragma mark - Prefetching
+
+- (void)enqueuePrefetchRequestForCellInfo:(CPCollectionViewCellInfo *)cellInfo collectionView:(UICollectionView *)collectionView atFront:(BOOL)atFront {
+    _CPCellInfoPrefetchRequest *request = [_CPCellInfoPrefetchRequest new];
+    request.cellInfo = cellInfo;
+    request.data = cellInfo.data;
+    request.collectionView = collectionView;
+    [_prefetchRequestsByCellInfo setObject:request forKey:cellInfo];
+    if (atFront) {
+        [_pendingPrefetchRequests insertObject:request atIndex:0];
+    } else {
+        [_pendingPrefetchRequests addObject:request];
+    }
+}
+
+- (void)startPendingPrefetches {
+    while (_pendingPrefetchRequests.count > 0 && _numberOfRunningPrefetches < MAX(_maximumConcurrentPrefetches, 1)) {
+        _CPCellInfoPrefetchRequest *request = _pendingPrefetchRequests.firstObject;
+        [_pendingPrefetchRequests removeObjectAtIndex:0];
+        request.running = YES;
+        _numberOfRunningPrefetches++;
+        
+        __weak typeof(self) weakSelf = self;
+        __block BOOL completed = NO;
+        request.cellInfo.prefetchCallback(request.data, ^(id prefetchedResult) {
+            void (^finish)(void) = ^{
+                if (completed) {
+                    return;
+                }
+                completed = YES;
+                [weakSelf finishPrefetchRequest:request withResult:prefetchedResult];
+            };
+            
+            if ([NSThread isMainThread]) {
+                finish();
+            } else {
+                dispatch_async(dispatch_get_main_queue(), finish);
+            }
+        });
+    }
+}
+
+- (void)finishPrefetchRequest:(_CPCellInfoPrefetchRequest *)request withResult:(id)prefetchedResult {
+    _numberOfRunningPrefetches--;
+    
+    CPCollectionViewCellInfo *cellInfo = request.cellInfo;
+    if ([_prefetchRequestsByCellInfo objectForKey:cellInfo] == request) {
+        //a cancelled request is replaced once the data of its cellInfo changes
+        [_prefetchRequestsByCellInfo removeObjectForKey:cellInfo];
+    }
+    
+    if (request.isCancelled) {
+        //the result of cancelled work may be partial, prefetch again if it was asked for meanwhile
+        UICollectionView *collectionView = request.collectionView;
+        if (request.requestedAgain && collectionView && cellInfo.data == request.data && !cellInfo.hasPrefetchedResult && ![_prefetchRequestsByCellInfo objectForKey:cellInfo]) {
+            [self enqueuePrefetchRequestForCellInfo:cellInfo collectionView:collectionView atFront:YES];
+        }
+        [self startPendingPrefetches];
+        return;
+    }
+    
+    if (cellInfo.data == request.data) {
+        cellInfo.prefetchedResult = prefetchedResult;
+        cellInfo.hasPrefetchedResult = YES;
+        [self touchPrefetchedResultOfCellInfo:cellInfo];
+        [self trimPrefetchedResultsToLimit];
+        
+        //the cell appeared before the result arrived, configure it again in place
+        UICollectionView *collectionView = request.collectionView;
+        NSIndexPath *indexPath = [collectionView cp_indexPathForCellInfo:cellInfo];
+        if (indexPath && [collectionView cellForItemAtIndexPath:indexPath]) {
+            [collectionView cp_reconfigureItemAtIndexPath:indexPath];
+        }
+    }
+    
+    [self startPendingPrefetches];
+}
+
+#pragma mark - Prefetched Results
+
+- (void)touchPrefetchedResultOfCellInfo:(CPCollectionViewCellInfo *)cellInfo {
+    [_cellInfosWithPrefetchedResult removeObject:cellInfo];
+    [_cellInfosWithPrefetchedResult addObject:cellInfo];
+}
+
+- (void)trimPrefetchedResultsToLimit {
+    if (_prefetchedResultCountLimit == 0) {
+        return;
+    }
+    
+    while (_cellInfosWithPrefetchedResult.count > _prefetchedResultCountLimit) {
+        CPCollectionViewCellInfo *cellInfo = _cellInfosWithPrefetchedResult.firstObject;
+        [_cellInfosWithPrefetchedResult removeObjectAtIndex:0];
+        cellInfo.prefetchedResult = nil;
+        cellInfo.hasPrefetchedResult = NO;
+    }
+}
+
+- (void)removeAllPrefetchedResults {
+    for (CPCollectionViewCellInfo *cellInfo in _cellInfosWithPrefetchedResult) {
+        cellInfo.prefetchedResult = nil;
+        cellInfo.hasPrefetchedResult = NO;
+    }
+    [_cellInfosWithPrefetchedResult removeAllObjects];
+}
+
 @end
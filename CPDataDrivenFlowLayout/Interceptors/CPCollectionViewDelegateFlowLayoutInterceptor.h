@@ -25,4 +25,16 @@
 
 @interface CPCollectionViewDelegateFlowLayoutInterceptor : NSObject <UICollectionViewDelegateFlowLayout>
 
+@property (nonatomic) BOOL shouldCacheSizeByIndexPath;//The default value of this property is YES
+@property (nonatomic) BOOL estimatesSizeForOffscreenItems;//The default value of this property is NO. when YES, cells which would be measured by a template cell are laid out with an estimate (cellInfo.estimatedSize, or the average measured size of the reuse identifier) and measured when their cells are requested
+
+/**
+ 精确计算使用预估尺寸布局的item，同一runloop内的调用合并为一次布局失效，位于可见区域之前的item变化时保持滚动位置不变
+ (cell即将显示时由CPCollectionViewDataSourceInterceptor自动调用)
+
+ @param collectionView collectionView
+ @param indexPath      item索引
+ */
+- (void)collectionView:(UICollectionView *)collectionView measureEstimatedItemAtIndexPath:(NSIndexPath *)indexPath;
+
 @end
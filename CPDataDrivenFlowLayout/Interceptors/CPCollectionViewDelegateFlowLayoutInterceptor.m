@@ -22,13 +22,45 @@
 
 #import "CPCollectionViewDelegateFlowLayoutInterceptor.h"
 #import "UICollectionView+CPDataDrivenFlowLayout.h"
+#import "UICollectionView+CPMetrics.h"
+#import "CPCollectionViewLazySectionInfo.h"
+
+@interface CPCollectionViewCellInfo ()
+
+@property (nonatomic, getter=isSizeEstimated) BOOL sizeEstimated;
+
+@end
+
+@interface CPCollectionViewLazySectionInfo ()
+
+- (BOOL)cp_getItemSize:(CGSize *)size atIndex:(NSUInteger)index referenceSize:(CGSize)referenceSize;
+- (void)cp_setItemSize:(CGSize)size atIndex:(NSUInteger)index referenceSize:(CGSize)referenceSize;
+
+@end
+
+@interface CPCollectionViewDelegateFlowLayoutInterceptor () {
+    NSMapTable<UICollectionView *, NSMutableArray<NSIndexPath *> *> *_estimatedIndexPathsByCollectionView;//items waiting for exact measurement, invalidated once per run loop turn
+    BOOL _measuresEstimatedItems;
+}
+
+@end
 
 @implementation CPCollectionViewDelegateFlowLayoutInterceptor
 
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _shouldCacheSizeByIndexPath = YES;
+        _estimatedIndexPathsByCollectionView = [NSMapTable weakToStrongObjectsMapTable];
+    }
+    
+    return self;
+}
+
 - (UIEdgeInsets)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewLayout*)collectionViewLayout insetForSectionAtIndex:(NSInteger)section {
-    CPCollectionViewSectionInfo *sectionInfo = [collectionView cp_sectionInfoForSection:section];
-    if (sectionInfo) {
-        return sectionInfo.sectionInset;
+    const CPCollectionViewSectionGeometry *geometry = [collectionView cp_sectionGeometry];
+    if (section >= 0 && section < geometry->numberOfSections) {
+        return geometry->sectionInsets[section];
     } else if ([collectionViewLayout isKindOfClass:[UICollectionViewFlowLayout class]]) {
         return [(UICollectionViewFlowLayout *)collectionViewLayout sectionInset];
     }
@@ -37,9 +69,9 @@
 }
 
 - (CGFloat)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewLayout *)collectionViewLayout minimumLineSpacingForSectionAtIndex:(NSInteger)section {
-    CPCollectionViewSectionInfo *sectionInfo = [collectionView cp_sectionInfoForSection:section];
-    if (sectionInfo) {
-        return sectionInfo.minimumLineSpacing;
+    const CPCollectionViewSectionGeometry *geometry = [collectionView cp_sectionGeometry];
+    if (section >= 0 && section < geometry->numberOfSections) {
+        return geometry->minimumLineSpacings[section];
     } else if ([collectionViewLayout isKindOfClass:[UICollectionViewFlowLayout class]]) {
         return [(UICollectionViewFlowLayout *)collectionViewLayout minimumLineSpacing];
     }
@@ -48,9 +80,9 @@
 }
 
 - (CGFloat)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewLayout *)collectionViewLayout minimumInteritemSpacingForSectionAtIndex:(NSInteger)section {
-    CPCollectionViewSectionInfo *sectionInfo = [collectionView cp_sectionInfoForSection:section];
-    if (sectionInfo) {
-        return sectionInfo.minimumInteritemSpacing;
+    const CPCollectionViewSectionGeometry *geometry = [collectionView cp_sectionGeometry];
+    if (section >= 0 && section < geometry->numberOfSections) {
+        return geometry->minimumInteritemSpacings[section];
     } else if ([collectionViewLayout isKindOfClass:[UICollectionViewFlowLayout class]]) {
         return [(UICollectionViewFlowLayout *)collectionViewLayout minimumInteritemSpacing];
     }
@@ -60,24 +92,73 @@
 
 //size for cell
 - (CGSize)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewLayout*)collectionViewLayout sizeForItemAtIndexPath:(NSIndexPath *)indexPath {
+    CPCollectionViewSectionInfo *sectionInfo = [collectionView cp_sectionInfoForSection:indexPath.section];
+    CPCollectionViewLazySectionInfo *lazySectionInfo = [sectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]] ? (CPCollectionViewLazySectionInfo *)sectionInfo : nil;
+    CGSize size = CGSizeZero;
+    if ([lazySectionInfo cp_getItemSize:&size atIndex:indexPath.item referenceSize:collectionView.bounds.size]) {
+        //sizes of a lazy section are kept by index, unloaded cellInfos are not rebuilt for every layout pass
+        return size;
+    }
+    
     CPCollectionViewCellInfo *cellInfo = [collectionView cp_cellInfoForItemAtIndexPath:indexPath];
+    size = [self collectionView:collectionView layout:collectionViewLayout sizeForCellInfo:cellInfo atIndexPath:indexPath];
+    if (lazySectionInfo && cellInfo && !cellInfo.isSizeEstimated) {
+        [lazySectionInfo cp_setItemSize:size atIndex:indexPath.item referenceSize:collectionView.bounds.size];
+    }
+    
+    return size;
+}
+
+- (CGSize)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewLayout*)collectionViewLayout sizeForCellInfo:(CPCollectionViewCellInfo *)cellInfo atIndexPath:(NSIndexPath *)indexPath {
     if (cellInfo.sizeForCellCallback) {
         //根据preferredLayout计算cell size的计算器
         CPCollectionViewPreferredLayoutBlock sizeByPreferredLayoutCalculator = ^(CPPreferredLayoutDimension dimension, CGFloat preferredLayoutValue) {
             CGSize size = CGSizeZero;
             
-            if (cellInfo.cellReuseIdentifier) {
-                size = [collectionView cp_sizeForCellWithIdentifier:cellInfo.cellReuseIdentifier preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue configuration:^(__kindof UICollectionViewCell * _Nonnull cell) {
-                    if (cellInfo.cellDidReuseCallback) {
-                        cellInfo.cellDidReuseCallback(collectionView, cell, indexPath, cellInfo.data);
+            if ([cellInfo cp_getPrecomputedSize:&size preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue]) {
+                return size;
+            }
+            
+            if (cellInfo.sizeForDataCallback) {
+                //view-free sizing does not need a template cell
+                size = cellInfo.sizeForDataCallback(cellInfo.data, dimension, preferredLayoutValue);
+                [cellInfo cp_setPrecomputedSize:size preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue];
+            } else if (cellInfo.cellReuseIdentifier) {
+                Class<CPStaticSizing> staticSizingClass = [collectionView cp_staticSizingClassForCellWithIdentifier:cellInfo.cellReuseIdentifier];
+                if (staticSizingClass) {
+                    //class level sizing skips the template cell and Auto Layout
+                    size = [staticSizingClass cp_sizeForData:cellInfo.data preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue];
+                    [cellInfo cp_setPrecomputedSize:size preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue];
+                } else {
+                    if (self.estimatesSizeForOffscreenItems && !self->_measuresEstimatedItems && [self getEstimatedSize:&size forCellInfo:cellInfo collectionView:collectionView atIndexPath:indexPath preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue]) {
+                        cellInfo.sizeEstimated = YES;
+                        return size;
+                    }
+                    
+                    size = [collectionView cp_sizeForCellWithIdentifier:cellInfo.cellReuseIdentifier preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue cacheByIndexPath:(self.shouldCacheSizeByIndexPath ? indexPath : nil) contentFingerprint:cellInfo.contentFingerprint configuration:^(__kindof UICollectionViewCell * _Nonnull cell) {
+                        if (cellInfo.cellDidReuseCallback) {
+                            cellInfo.cellDidReuseCallback(collectionView, cell, indexPath, cellInfo.data);
+                        }
+                    }];
+                    
+                    if (self.estimatesSizeForOffscreenItems) {
+                        //the exact size stays on the cell info, it is not estimated again until data changes
+                        cellInfo.sizeEstimated = NO;
+                        [cellInfo cp_setPrecomputedSize:size preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue];
+                        [collectionView.cp_estimatedSizeCache addMeasuredSize:size forReuseIdentifier:cellInfo.cellReuseIdentifier preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue];
                     }
-                }];
+                }
             }
             
             return size;
         };
         
-        return cellInfo.sizeForCellCallback(collectionView, collectionViewLayout, sizeByPreferredLayoutCalculator);
+        CPCollectionViewMetrics *metrics = collectionView.cp_metrics;
+        CPMetricsInterval interval = [metrics beginInterval:CPCollectionViewMetricsEventSizeCallback reuseIdentifier:cellInfo.cellReuseIdentifier];
+        CGSize size = cellInfo.sizeForCellCallback(collectionView, collectionViewLayout, sizeByPreferredLayoutCalculator);
+        [metrics endInterval:interval event:CPCollectionViewMetricsEventSizeCallback reuseIdentifier:cellInfo.cellReuseIdentifier];
+        
+        return size;
     }
     
     return CGSizeZero;
@@ -92,17 +173,27 @@
             CGSize size = CGSizeZero;
             
             if (sectionInfo.headerReuseIdentifier) {
-                size = [collectionView cp_sizeForSupplementaryViewOfKind:UICollectionElementKindSectionHeader identifier:sectionInfo.headerReuseIdentifier preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue configuration:^(__kindof UICollectionReusableView * _Nonnull supplementaryView) {
-                    if (sectionInfo.headerDidReuseCallback) {
-                        sectionInfo.headerDidReuseCallback(collectionView, supplementaryView, section);
-                    }
-                }];
+                Class<CPStaticSizing> staticSizingClass = [collectionView cp_staticSizingClassForSupplementaryViewOfKind:UICollectionElementKindSectionHeader identifier:sectionInfo.headerReuseIdentifier];
+                if (staticSizingClass) {
+                    size = [staticSizingClass cp_sizeForData:sectionInfo.data preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue];
+                } else {
+                    size = [collectionView cp_sizeForSupplementaryViewOfKind:UICollectionElementKindSectionHeader identifier:sectionInfo.headerReuseIdentifier preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue configuration:^(__kindof UICollectionReusableView * _Nonnull supplementaryView) {
+                        if (sectionInfo.headerDidReuseCallback) {
+                            sectionInfo.headerDidReuseCallback(collectionView, supplementaryView, section);
+                        }
+                    }];
+                }
             }
             
             return size;
         };
         
-        return sectionInfo.sizeForHeaderCallback(collectionView, collectionViewLayout, sizeByPreferredLayoutCalculator);
+        CPCollectionViewMetrics *metrics = collectionView.cp_metrics;
+        CPMetricsInterval interval = [metrics beginInterval:CPCollectionViewMetricsEventSizeCallback reuseIdentifier:sectionInfo.headerReuseIdentifier];
+        CGSize size = sectionInfo.sizeForHeaderCallback(collectionView, collectionViewLayout, sizeByPreferredLayoutCalculator);
+        [metrics endInterval:interval event:CPCollectionViewMetricsEventSizeCallback reuseIdentifier:sectionInfo.headerReuseIdentifier];
+        
+        return size;
     }
     
     return CGSizeZero;
@@ -117,17 +208,27 @@
             CGSize size = CGSizeZero;
             
             if (sectionInfo.footerReuseIdentifier) {
-                size = [collectionView cp_sizeForSupplementaryViewOfKind:UICollectionElementKindSectionFooter identifier:sectionInfo.footerReuseIdentifier preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue configuration:^(__kindof UICollectionReusableView * _Nonnull supplementaryView) {
-                    if (sectionInfo.footerDidReuseCallback) {
-                        sectionInfo.footerDidReuseCallback(collectionView, supplementaryView, section);
-                    }
-                }];
+                Class<CPStaticSizing> staticSizingClass = [collectionView cp_staticSizingClassForSupplementaryViewOfKind:UICollectionElementKindSectionFooter identifier:sectionInfo.footerReuseIdentifier];
+                if (staticSizingClass) {
+                    size = [staticSizingClass cp_sizeForData:sectionInfo.data preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue];
+                } else {
+                    size = [collectionView cp_sizeForSupplementaryViewOfKind:UICollectionElementKindSectionFooter identifier:sectionInfo.footerReuseIdentifier preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue configuration:^(__kindof UICollectionReusableView * _Nonnull supplementaryView) {
+                        if (sectionInfo.footerDidReuseCallback) {
+                            sectionInfo.footerDidReuseCallback(collectionView, supplementaryView, section);
+                        }
+                    }];
+                }
             }
             
             return size;
         };
         
-        return sectionInfo.sizeForFooterCallback(collectionView, collectionViewLayout, sizeByPreferredLayoutCalculator);
+        CPCollectionViewMetrics *metrics = collectionView.cp_metrics;
+        CPMetricsInterval interval = [metrics beginInterval:CPCollectionViewMetricsEventSizeCallback reuseIdentifier:sectionInfo.footerReuseIdentifier];
+        CGSize size = sectionInfo.sizeForFooterCallback(collectionView, collectionViewLayout, sizeByPreferredLayoutCalculator);
+        [metrics endInterval:interval event:CPCollectionViewMetricsEventSizeCallback reuseIdentifier:sectionInfo.footerReuseIdentifier];
+        
+        return size;
     }
     
     return CGSizeZero;
@@ -140,4 +241,114 @@
     }
 }
 
+#pragma mark - Estimated Size
+
+- (BOOL)getEstimatedSize:(CGSize *)size forCellInfo:(CPCollectionViewCellInfo *)cellInfo collectionView:(UICollectionView *)collectionView atIndexPath:(NSIndexPath *)indexPath preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue {
+    //cached sizes are as cheap as estimates, only sizes which need a template cell are estimated
+    if (self.shouldCacheSizeByIndexPath && [collectionView.cp_indexPathSizeCache existsSizeAtIndexPath:indexPath preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue]) {
+        return NO;
+    }
+    if (cellInfo.contentFingerprint && [collectionView.cp_contentSizeCache getSize:NULL forReuseIdentifier:cellInfo.cellReuseIdentifier contentFingerprint:cellInfo.contentFingerprint preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue]) {
+        return NO;
+    }
+    
+    if (!CGSizeEqualToSize(cellInfo.estimatedSize, CGSizeZero)) {
+        *size = cellInfo.estimatedSize;
+        return YES;
+    }
+    
+    //the first cell of a reuse identifier is measured, later ones use the average
+    return [collectionView.cp_estimatedSizeCache getEstimatedSize:size forReuseIdentifier:cellInfo.cellReuseIdentifier preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+}
+
+- (void)collectionView:(UICollectionView *)collectionView measureEstimatedItemAtIndexPath:(NSIndexPath *)indexPath {
+    NSMutableArray<NSIndexPath *> *indexPaths = [_estimatedIndexPathsByCollectionView objectForKey:collectionView];
+    if (!indexPaths) {
+        indexPaths = [NSMutableArray new];
+        [_estimatedIndexPathsByCollectionView setObject:indexPaths forKey:collectionView];
+        
+        //cells are requested one by one during layout, measure them together afterwards
+        __weak typeof(self) weakSelf = self;
+        __weak UICollectionView *weakCollectionView = collectionView;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            UICollectionView *strongCollectionView = weakCollectionView;
+            if (strongCollectionView) {
+                [weakSelf invalidateEstimatedItemsOfCollectionView:strongCollectionView];
+            }
+        });
+    }
+    
+    [indexPaths addObject:indexPath];
+}
+
+- (void)invalidateEstimatedItemsOfCollectionView:(UICollectionView *)collectionView {
+    NSArray<NSIndexPath *> *indexPaths = [_estimatedIndexPathsByCollectionView objectForKey:collectionView];
+    [_estimatedIndexPathsByCollectionView removeObjectForKey:collectionView];
+    
+    UICollectionViewLayout *layout = collectionView.collectionViewLayout;
+    BOOL horizontal = [layout isKindOfClass:[UICollectionViewFlowLayout class]] && [(UICollectionViewFlowLayout *)layout scrollDirection] == UICollectionViewScrollDirectionHorizontal;
+    NSMutableArray<NSIndexPath *> *invalidatedIndexPaths = [NSMutableArray new];
+    
+    _measuresEstimatedItems = YES;
+    for (NSIndexPath *indexPath in indexPaths) {
+        //index paths may be stale after updates, only items still laid out with an estimate are measured
+        CPCollectionViewCellInfo *cellInfo = [collectionView cp_cellInfoForItemAtIndexPath:indexPath];
+        UICollectionViewLayoutAttributes *attributes = cellInfo.isSizeEstimated ? [layout layoutAttributesForItemAtIndexPath:indexPath] : nil;
+        if (!attributes) {
+            continue;
+        }
+        
+        CGSize size = [self collectionView:collectionView layout:layout sizeForItemAtIndexPath:indexPath];
+        if (CGSizeEqualToSize(size, attributes.size)) {
+            continue;
+        }
+        
+        [invalidatedIndexPaths addObject:indexPath];
+    }
+    _measuresEstimatedItems = NO;
+    
+    if (invalidatedIndexPaths.count == 0) {
+        return;
+    }
+    
+    //items before the visible area would push visible content, keep the first visible item in place instead
+    //its shift is measured, items sharing a line in a grid do not add up their size changes
+    CGFloat visibleOrigin = horizontal ? collectionView.contentOffset.x : collectionView.contentOffset.y;
+    NSIndexPath *anchorIndexPath = nil;
+    CGFloat anchorOrigin = 0;
+    for (NSIndexPath *indexPath in [collectionView.indexPathsForVisibleItems sortedArrayUsingSelector:@selector(compare:)]) {
+        UICollectionViewLayoutAttributes *attributes = [layout layoutAttributesForItemAtIndexPath:indexPath];
+        CGFloat origin = horizontal ? CGRectGetMinX(attributes.frame) : CGRectGetMinY(attributes.frame);
+        if (attributes && origin >= visibleOrigin) {
+            anchorIndexPath = indexPath;
+            anchorOrigin = origin;
+            break;
+        }
+    }
+    
+    UICollectionViewLayoutInvalidationContext *context = [[[layout class] invalidationContextClass] new];
+    [context invalidateItemsAtIndexPaths:invalidatedIndexPaths];
+    if ([context isKindOfClass:[UICollectionViewFlowLayoutInvalidationContext class]]) {
+        //flow layout only asks the delegate for sizes again with delegate metrics invalidated, the other sizes are cached or estimated
+        [(UICollectionViewFlowLayoutInvalidationContext *)context setInvalidateFlowLayoutDelegateMetrics:YES];
+    }
+    [layout invalidateLayoutWithContext:context];
+    if (!anchorIndexPath) {
+        return;
+    }
+    
+    [collectionView layoutIfNeeded];
+    UICollectionViewLayoutAttributes *anchorAttributes = [layout layoutAttributesForItemAtIndexPath:anchorIndexPath];
+    CGFloat contentOffsetAdjustment = (horizontal ? CGRectGetMinX(anchorAttributes.frame) : CGRectGetMinY(anchorAttributes.frame)) - anchorOrigin;
+    if (anchorAttributes && contentOffsetAdjustment != 0) {
+        CGPoint contentOffset = collectionView.contentOffset;
+        if (horizontal) {
+            contentOffset.x += contentOffsetAdjustment;
+        } else {
+            contentOffset.y += contentOffsetAdjustment;
+        }
+        collectionView.contentOffset = contentOffset;
+    }
+}
+
 @end
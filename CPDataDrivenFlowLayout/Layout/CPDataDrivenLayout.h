@@ -0,0 +1,39 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ 基于CPFlowLayoutEngine的纵向流式布局，可替代UICollectionViewFlowLayout
+ sectionInset、minimumLineSpacing、minimumInteritemSpacing直接读取自CPCollectionViewSectionInfo (无sectionInfo时询问delegate)，header、footer与cell尺寸通过delegate获取
+ 行偏移与section偏移以前缀和保存，layoutAttributesForElementsInRect:通过二分查找定位；批量更新时只重新计算受影响的section
+ sectionInfo的numberOfColumns大于0时该section为瀑布流，只在末尾插入item (如cp_appendCellInfos:inSection:) 时仅放置新增的item
+ */
+@interface CPDataDrivenLayout : UICollectionViewLayout
+
+- (CGFloat)columnWidthForSection:(NSInteger)section;//width of items in a waterfall section as laid out (also valid inside its size callbacks), return 0 if numberOfColumns of the section info is 0 or the section has not been laid out yet
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,325 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPDataDrivenLayout.h"
+#import "CPFlowLayoutEngine.h"
+#import "UICollectionView+CPDataDrivenFlowLayout.h"
+#import "UICollectionView+CPMetrics.h"
+
+@interface CPDataDrivenLayout () <CPFlowLayoutEngineDataSource> {
+    CPFlowLayoutEngine *_engine;
+    BOOL _waitsForCollectionViewUpdates;//data source counts changed, affected sections are known in prepareForCollectionViewUpdates:
+}
+
+@end
+
+@implementation CPDataDrivenLayout
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        [self commonInit];
+    }
+    
+    return self;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+    self = [super initWithCoder:aDecoder];
+    if (self) {
+        [self commonInit];
+    }
+    
+    return self;
+}
+
+- (void)commonInit {
+    _engine = [CPFlowLayoutEngine new];
+    _engine.dataSource = self;
+}
+
+#pragma mark - Preparing
+
+- (void)prepareLayout {
+    [super prepareLayout];
+    
+    UICollectionView *collectionView = self.collectionView;
+    [collectionView.cp_metrics recordLayoutPass];
+    _engine.containerWidth = [self containerWidthForBounds:collectionView.bounds];
+    
+    if (!_waitsForCollectionViewUpdates) {
+        [_engine prepare];
+    }
+}
+
+- (CGSize)collectionViewContentSize {
+    [self prepareEngineIfNeeded];
+    return _engine.contentSize;
+}
+
+#pragma mark - Invalidating
+
+- (BOOL)shouldInvalidateLayoutForBoundsChange:(CGRect)newBounds {
+    //compared with the width laid out with, insets may have changed since then
+    return [self containerWidthForBounds:newBounds] != _engine.containerWidth;
+}
+
+- (void)invalidateLayoutWithContext:(UICollectionViewLayoutInvalidationContext *)context {
+    [super invalidateLayoutWithContext:context];
+    
+    if (context.invalidateEverything) {
+        //reloadData or invalidateLayout
+        _waitsForCollectionViewUpdates = NO;
+        [_engine invalidateAllSections];
+    } else if (context.invalidateDataSourceCounts) {
+        _waitsForCollectionViewUpdates = YES;
+    } else if (context.invalidatedItemIndexPaths.count > 0) {
+        //e.g. estimated items which have been measured, only their sections are laid out again
+        NSMutableIndexSet *sections = [NSMutableIndexSet new];
+        for (NSIndexPath *indexPath in context.invalidatedItemIndexPaths) {
+            [sections addIndex:indexPath.section];
+        }
+        [_engine invalidateSections:sections];
+    }
+}
+
+#pragma mark - Updates
+
+- (void)prepareForCollectionViewUpdates:(NSArray<UICollectionViewUpdateItem *> *)updateItems {
+    [super prepareForCollectionViewUpdates:updateItems];
+    
+    NSMutableIndexSet *invalidatedSectionsBeforeUpdate = [NSMutableIndexSet new];
+    NSMutableIndexSet *invalidatedSectionsAfterUpdate = [NSMutableIndexSet new];
+    NSMutableIndexSet *deletedSections = [NSMutableIndexSet new];
+    NSMutableIndexSet *insertedSections = [NSMutableIndexSet new];
+    NSMutableDictionary<NSNumber *, NSMutableIndexSet *> *insertedItemsBySection = [NSMutableDictionary new];
+    
+    for (UICollectionViewUpdateItem *updateItem in updateItems) {
+        NSIndexPath *indexPathBeforeUpdate = updateItem.indexPathBeforeUpdate;
+        NSIndexPath *indexPathAfterUpdate = updateItem.indexPathAfterUpdate;
+        BOOL isSectionUpdate = (indexPathBeforeUpdate ?: indexPathAfterUpdate).item == NSNotFound;
+        
+        switch (updateItem.updateAction) {
+            case UICollectionUpdateActionInsert:
+                if (isSectionUpdate) {
+                    [insertedSections addIndex:indexPathAfterUpdate.section];
+                } else {
+                    NSMutableIndexSet *insertedItems = insertedItemsBySection[@(indexPathAfterUpdate.section)];
+                    if (!insertedItems) {
+                        insertedItems = [NSMutableIndexSet new];
+                        insertedItemsBySection[@(indexPathAfterUpdate.section)] = insertedItems;
+                    }
+                    [insertedItems addIndex:indexPathAfterUpdate.item];
+                }
+                break;
+            case UICollectionUpdateActionDelete:
+                [(isSectionUpdate ? deletedSections : invalidatedSectionsBeforeUpdate) addIndex:indexPathBeforeUpdate.section];
+                break;
+            case UICollectionUpdateActionReload:
+                [invalidatedSectionsBeforeUpdate addIndex:indexPathBeforeUpdate.section];
+                break;
+            case UICollectionUpdateActionMove:
+                if (isSectionUpdate) {
+                    [deletedSections addIndex:indexPathBeforeUpdate.section];
+                    [insertedSections addIndex:indexPathAfterUpdate.section];
+                } else {
+                    [invalidatedSectionsBeforeUpdate addIndex:indexPathBeforeUpdate.section];
+                    [invalidatedSectionsAfterUpdate addIndex:indexPathAfterUpdate.section];
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    
+    //items inserted only at the end of a section are appended, e.g. infinite scrolling
+    NSMutableIndexSet *appendedSections = [NSMutableIndexSet new];
+    BOOL hasSectionUpdates = deletedSections.count > 0 || insertedSections.count > 0;
+    [insertedItemsBySection enumerateKeysAndObjectsUsingBlock:^(NSNumber * _Nonnull sectionNumber, NSMutableIndexSet * _Nonnull insertedItems, BOOL * _Nonnull stop) {
+        NSInteger section = sectionNumber.integerValue;
+        BOOL appended = !hasSectionUpdates &&
+                        ![invalidatedSectionsBeforeUpdate containsIndex:section] &&
+                        ![invalidatedSectionsAfterUpdate containsIndex:section] &&
+                        insertedItems.firstIndex + insertedItems.count == [self.collectionView numberOfItemsInSection:section];
+        [(appended ? appendedSections : invalidatedSectionsAfterUpdate) addIndex:section];
+    }];
+    
+    //same order as UICollectionView applies updates: reload and delete by old indexes, then insert by new indexes
+    [_engine invalidateSections:invalidatedSectionsBeforeUpdate];
+    [_engine deleteSections:deletedSections];
+    [_engine insertSections:insertedSections];
+    [_engine invalidateSections:invalidatedSectionsAfterUpdate];
+    [appendedSections enumerateIndexesUsingBlock:^(NSUInteger section, BOOL * _Nonnull stop) {
+        [self->_engine appendItemsInSection:section];
+    }];
+    
+    _waitsForCollectionViewUpdates = NO;
+    [_engine prepare];
+}
+
+#pragma mark - Waterfall
+
+- (CGFloat)columnWidthForSection:(NSInteger)section {
+    //the width the engine lays the items out with, never prepares the engine since size callbacks may call it during prepare
+    return section >= 0 ? [_engine columnWidthForSection:section] : 0;
+}
+
+#pragma mark - Layout Attributes
+
+- (nullable NSArray<__kindof UICollectionViewLayoutAttributes *> *)layoutAttributesForElementsInRect:(CGRect)rect {
+    [self prepareEngineIfNeeded];
+    
+    NSMutableArray<UICollectionViewLayoutAttributes *> *layoutAttributes = [NSMutableArray new];
+    [_engine enumerateElementsInRect:rect usingBlock:^(CPFlowLayoutElementKind kind, NSUInteger section, NSUInteger item, CGRect frame, BOOL * _Nonnull stop) {
+        [layoutAttributes addObject:[self layoutAttributesForElementKind:kind section:section item:item frame:frame]];
+    }];
+    
+    return layoutAttributes;
+}
+
+- (nullable UICollectionViewLayoutAttributes *)layoutAttributesForItemAtIndexPath:(NSIndexPath *)indexPath {
+    [self prepareEngineIfNeeded];
+    
+    CGRect frame = [_engine frameForItemAtIndex:indexPath.item inSection:indexPath.section];
+    if (CGRectIsNull(frame)) {
+        return nil;
+    }
+    
+    return [self layoutAttributesForElementKind:CPFlowLayoutElementKindCell section:indexPath.section item:indexPath.item frame:frame];
+}
+
+- (nullable UICollectionViewLayoutAttributes *)layoutAttributesForSupplementaryViewOfKind:(NSString *)elementKind atIndexPath:(NSIndexPath *)indexPath {
+    [self prepareEngineIfNeeded];
+    
+    if ([elementKind isEqualToString:UICollectionElementKindSectionHeader]) {
+        CGRect frame = [_engine frameForHeaderInSection:indexPath.section];
+        if (!CGRectIsNull(frame)) {
+            return [self layoutAttributesForElementKind:CPFlowLayoutElementKindHeader section:indexPath.section item:0 frame:frame];
+        }
+    } else if ([elementKind isEqualToString:UICollectionElementKindSectionFooter]) {
+        CGRect frame = [_engine frameForFooterInSection:indexPath.section];
+        if (!CGRectIsNull(frame)) {
+            return [self layoutAttributesForElementKind:CPFlowLayoutElementKindFooter section:indexPath.section item:0 frame:frame];
+        }
+    }
+    
+    return nil;
+}
+
+#pragma mark - CPFlowLayoutEngineDataSource
+
+- (NSUInteger)numberOfSectionsInFlowLayoutEngine:(CPFlowLayoutEngine *)engine {
+    return MAX([self.collectionView numberOfSections], 0);
+}
+
+- (NSUInteger)flowLayoutEngine:(CPFlowLayoutEngine *)engine numberOfItemsInSection:(NSUInteger)section {
+    return MAX([self.collectionView numberOfItemsInSection:section], 0);
+}
+
+- (CPFlowLayoutSectionMetrics)flowLayoutEngine:(CPFlowLayoutEngine *)engine metricsForSection:(NSUInteger)section {
+    UICollectionView *collectionView = self.collectionView;
+    id<UICollectionViewDelegateFlowLayout> delegate = (id<UICollectionViewDelegateFlowLayout>)collectionView.delegate;
+    
+    UIEdgeInsets sectionInset = UIEdgeInsetsZero;
+    CPFlowLayoutSectionMetrics metrics = {};
+    
+    CPCollectionViewSectionInfo *sectionInfo = [collectionView cp_sectionInfoForSection:section];
+    if (sectionInfo) {
+        sectionInset = sectionInfo.sectionInset;
+        metrics.minimumLineSpacing = sectionInfo.minimumLineSpacing;
+        metrics.minimumInteritemSpacing = sectionInfo.minimumInteritemSpacing;
+        metrics.numberOfColumns = sectionInfo.numberOfColumns;
+    } else {
+        if ([delegate respondsToSelector:@selector(collectionView:layout:insetForSectionAtIndex:)]) {
+            sectionInset = [delegate collectionView:collectionView layout:self insetForSectionAtIndex:section];
+        }
+        if ([delegate respondsToSelector:@selector(collectionView:layout:minimumLineSpacingForSectionAtIndex:)]) {
+            metrics.minimumLineSpacing = [delegate collectionView:collectionView layout:self minimumLineSpacingForSectionAtIndex:section];
+        }
+        if ([delegate respondsToSelector:@selector(collectionView:layout:minimumInteritemSpacingForSectionAtIndex:)]) {
+            metrics.minimumInteritemSpacing = [delegate collectionView:collectionView layout:self minimumInteritemSpacingForSectionAtIndex:section];
+        }
+    }
+    metrics.sectionInset = CPFlowLayoutInsetsMake(sectionInset.top, sectionInset.left, sectionInset.bottom, sectionInset.right);
+    
+    if ([delegate respondsToSelector:@selector(collectionView:layout:referenceSizeForHeaderInSection:)]) {
+        metrics.headerHeight = [delegate collectionView:collectionView layout:self referenceSizeForHeaderInSection:section].height;
+    }
+    if ([delegate respondsToSelector:@selector(collectionView:layout:referenceSizeForFooterInSection:)]) {
+        metrics.footerHeight = [delegate collectionView:collectionView layout:self referenceSizeForFooterInSection:section].height;
+    }
+    
+    return metrics;
+}
+
+- (CGSize)flowLayoutEngine:(CPFlowLayoutEngine *)engine sizeForItemAtIndex:(NSUInteger)item inSection:(NSUInteger)section {
+    UICollectionView *collectionView = self.collectionView;
+    id<UICollectionViewDelegateFlowLayout> delegate = (id<UICollectionViewDelegateFlowLayout>)collectionView.delegate;
+    if ([delegate respondsToSelector:@selector(collectionView:layout:sizeForItemAtIndexPath:)]) {
+        return [delegate collectionView:collectionView layout:self sizeForItemAtIndexPath:[NSIndexPath indexPathForItem:item inSection:section]];
+    }
+    
+    return CGSizeZero;
+}
+
+#pragma mark - Private
+
+- (CGFloat)containerWidthForBounds:(CGRect)bounds {
+    UICollectionView *collectionView = self.collectionView;
+    UIEdgeInsets contentInset = collectionView.contentInset;
+    if ([collectionView respondsToSelector:@selector(adjustedContentInset)]) {
+        //includes safe area insets since iOS 11
+        contentInset = collectionView.adjustedContentInset;
+    }
+    
+    return MAX(CGRectGetWidth(bounds) - contentInset.left - contentInset.right, 0);
+}
+
+- (void)prepareEngineIfNeeded {
+    if (_waitsForCollectionViewUpdates) {
+        //queried before prepareForCollectionViewUpdates:, affected sections are unknown
+        _waitsForCollectionViewUpdates = NO;
+        [_engine invalidateAllSections];
+        [_engine prepare];
+    }
+}
+
+- (UICollectionViewLayoutAttributes *)layoutAttributesForElementKind:(CPFlowLayoutElementKind)kind section:(NSUInteger)section item:(NSUInteger)item frame:(CGRect)frame {
+    UICollectionViewLayoutAttributes *layoutAttributes = nil;
+    NSIndexPath *indexPath = [NSIndexPath indexPathForItem:item inSection:section];
+    switch (kind) {
+        case CPFlowLayoutElementKindCell:
+            layoutAttributes = [UICollectionViewLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
+            break;
+        case CPFlowLayoutElementKindHeader:
+            layoutAttributes = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:UICollectionElementKindSectionHeader withIndexPath:indexPath];
+            break;
+        case CPFlowLayoutElementKindFooter:
+            layoutAttributes = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:UICollectionElementKindSectionFooter withIndexPath:indexPath];
+            break;
+    }
+    layoutAttributes.frame = frame;
+    
+    return layoutAttributes;
+}
+
+@end
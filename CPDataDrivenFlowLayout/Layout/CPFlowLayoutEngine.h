@@ -0,0 +1,115 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef struct CPFlowLayoutInsets {
+    CGFloat top, left, bottom, right;
+} CPFlowLayoutInsets;
+
+static inline CPFlowLayoutInsets CPFlowLayoutInsetsMake(CGFloat top, CGFloat left, CGFloat bottom, CGFloat right) {
+    CPFlowLayoutInsets insets = {top, left, bottom, right};
+    return insets;
+}
+
+typedef struct CPFlowLayoutSectionMetrics {
+    CPFlowLayoutInsets sectionInset;
+    CGFloat minimumLineSpacing;
+    CGFloat minimumInteritemSpacing;
+    CGFloat headerHeight;//0 means no header
+    CGFloat footerHeight;//0 means no footer
+    NSUInteger numberOfColumns;//0 means flow layout, otherwise items are placed in the shortest of numberOfColumns columns
+} CPFlowLayoutSectionMetrics;
+
+typedef NS_ENUM(NSInteger, CPFlowLayoutElementKind) {
+    CPFlowLayoutElementKindCell,
+    CPFlowLayoutElementKindHeader,
+    CPFlowLayoutElementKindFooter
+};
+
+typedef void (^CPFlowLayoutElementBlock)(CPFlowLayoutElementKind kind, NSUInteger section, NSUInteger item, CGRect frame, BOOL *stop);//item is 0 for header and footer
+
+@class CPFlowLayoutEngine;
+
+@protocol CPFlowLayoutEngineDataSource <NSObject>
+
+- (NSUInteger)numberOfSectionsInFlowLayoutEngine:(CPFlowLayoutEngine *)engine;
+- (NSUInteger)flowLayoutEngine:(CPFlowLayoutEngine *)engine numberOfItemsInSection:(NSUInteger)section;
+- (CPFlowLayoutSectionMetrics)flowLayoutEngine:(CPFlowLayoutEngine *)engine metricsForSection:(NSUInteger)section;
+- (CGSize)flowLayoutEngine:(CPFlowLayoutEngine *)engine sizeForItemAtIndex:(NSUInteger)item inSection:(NSUInteger)section;
+
+@end
+
+/**
+ 纵向流式布局的断行与偏移计算核心，仅依赖Foundation与CoreGraphics
+ 每个section内的行偏移与section的起始偏移均以前缀和保存，矩形查询通过二分查找定位；仅重新计算被标记失效的section
+ 断行规则与UICollectionViewFlowLayout一致：按minimumInteritemSpacing贪心断行，行内两端对齐，单个item的行居中，item在行内垂直居中
+ numberOfColumns大于0的section为瀑布流：列间距为minimumInteritemSpacing，列内间距为minimumLineSpacing，item宽度固定为列宽，通过最小堆放入最短的列 (O(log k))，矩形查询在每列有序的偏移中二分查找
+ */
+@interface CPFlowLayoutEngine : NSObject
+
+@property (nonatomic, weak, nullable) id<CPFlowLayoutEngineDataSource> dataSource;
+@property (nonatomic) CGFloat containerWidth;//changing it invalidates all sections
+
+@property (nonatomic, readonly) CGSize contentSize;//valid after prepare
+@property (nonatomic, readonly) NSUInteger numberOfSections;
+
+#pragma mark - Invalidate
+
+- (void)invalidateAllSections;
+- (void)invalidateSections:(NSIndexSet *)sections;
+
+#pragma mark - Structural Changes
+
+- (void)insertSections:(NSIndexSet *)sections;//indexes after insertion, inserted sections are computed on next prepare
+- (void)deleteSections:(NSIndexSet *)sections;//indexes before deletion
+- (void)appendItemsInSection:(NSUInteger)section;//items were only added at the end of the section, waterfall sections place only the new items on next prepare, flow sections are laid out again
+
+#pragma mark - Prepare
+
+/**
+ 重新计算失效的section及其后的section起始偏移
+ section数量与dataSource不一致时会重新计算全部section
+ */
+- (void)prepare;
+
+#pragma mark - Query
+
+- (CGRect)frameForItemAtIndex:(NSUInteger)item inSection:(NSUInteger)section;//return CGRectNull if out of bounds
+- (CGRect)frameForHeaderInSection:(NSUInteger)section;//return CGRectNull if not exists
+- (CGRect)frameForFooterInSection:(NSUInteger)section;//return CGRectNull if not exists
+- (CGFloat)columnWidthForSection:(NSUInteger)section;//item width of a waterfall section, also valid while its items are being sized, return 0 for flow sections and sections not laid out yet
+
+/**
+ 按section、行的顺序遍历与rect相交的元素 (尺寸为0的元素会被跳过)
+
+ @param rect 查询区域
+ @param block 遍历block
+ */
+- (void)enumerateElementsInRect:(CGRect)rect usingBlock:(CPFlowLayoutElementBlock)block;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,631 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPFlowLayoutEngine.h"
+
+static const CGFloat kCPFlowLayoutLineBreakTolerance = 0.0001;//tolerance of floating point error when filling a line
+
+//values must be in ascending order
+static NSUInteger CPFlowLayoutFirstIndexGreaterThan(const CGFloat *values, NSUInteger count, CGFloat value) {
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while (low < high) {
+        NSUInteger mid = low + (high - low) / 2;
+        if (values[mid] > value) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    
+    return low;
+}
+
+//items of a waterfall column are stacked, so their bottoms are in ascending order
+static NSUInteger CPFlowLayoutFirstColumnItemWithBottomGreaterThan(const CGRect *frames, const NSUInteger *items, NSUInteger count, CGFloat value) {
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while (low < high) {
+        NSUInteger mid = low + (high - low) / 2;
+        if (CGRectGetMaxY(frames[items[mid]]) > value) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    
+    return low;
+}
+
+static inline BOOL CPFlowLayoutColumnIsShorter(const CGFloat *columnBottoms, NSUInteger column, NSUInteger otherColumn) {
+    //the leftmost column wins a tie
+    return columnBottoms[column] < columnBottoms[otherColumn] || (columnBottoms[column] == columnBottoms[otherColumn] && column < otherColumn);
+}
+
+//restores the min-heap after the bottom of the root column has grown
+static void CPFlowLayoutColumnHeapSiftDown(NSUInteger *heap, NSUInteger count, const CGFloat *columnBottoms) {
+    NSUInteger index = 0;
+    while (YES) {
+        NSUInteger shortest = index;
+        NSUInteger left = index * 2 + 1;
+        NSUInteger right = left + 1;
+        if (left < count && CPFlowLayoutColumnIsShorter(columnBottoms, heap[left], heap[shortest])) {
+            shortest = left;
+        }
+        if (right < count && CPFlowLayoutColumnIsShorter(columnBottoms, heap[right], heap[shortest])) {
+            shortest = right;
+        }
+        if (shortest == index) {
+            return;
+        }
+        
+        NSUInteger column = heap[index];
+        heap[index] = heap[shortest];
+        heap[shortest] = column;
+        index = shortest;
+    }
+}
+
+static BOOL CPFlowLayoutSectionMetricsEqualToMetrics(CPFlowLayoutSectionMetrics metrics, CPFlowLayoutSectionMetrics otherMetrics) {
+    return metrics.sectionInset.top == otherMetrics.sectionInset.top &&
+           metrics.sectionInset.left == otherMetrics.sectionInset.left &&
+           metrics.sectionInset.bottom == otherMetrics.sectionInset.bottom &&
+           metrics.sectionInset.right == otherMetrics.sectionInset.right &&
+           metrics.minimumLineSpacing == otherMetrics.minimumLineSpacing &&
+           metrics.minimumInteritemSpacing == otherMetrics.minimumInteritemSpacing &&
+           metrics.headerHeight == otherMetrics.headerHeight &&
+           metrics.footerHeight == otherMetrics.footerHeight &&
+           metrics.numberOfColumns == otherMetrics.numberOfColumns;
+}
+
+@interface _CPFlowLayoutSectionGeometry : NSObject {
+@public
+    NSUInteger _numberOfItems;
+    CGRect *_itemFrames;//relative to section origin
+    NSUInteger _numberOfLines;
+    NSUInteger *_lineStarts;//index of first item of each line, _numberOfLines + 1 entries
+    CGFloat *_lineTops;//relative to section origin
+    CGFloat *_lineBottoms;//relative to section origin, ascending
+    CGRect _headerFrame;//CGRectNull if not exists
+    CGRect _footerFrame;//CGRectNull if not exists
+    CGFloat _height;
+    
+    //waterfall, state is kept so appended items can be placed without laying out the section again
+    CPFlowLayoutSectionMetrics _metrics;
+    NSUInteger _numberOfColumns;//0 for flow layout
+    CGFloat _columnWidth;
+    NSUInteger _itemFramesCapacity;
+    CGFloat *_columnBottoms;//relative to section origin
+    NSUInteger *_columnHeap;//min-heap of columns by bottom
+    NSUInteger **_columnItems;//items of each column, ascending offsets
+    NSUInteger *_columnItemCounts;
+    NSUInteger *_columnItemCapacities;
+    BOOL _needsAppend;
+}
+
+@end
+
+@implementation _CPFlowLayoutSectionGeometry
+
+- (void)dealloc {
+    free(_itemFrames);
+    free(_lineStarts);
+    free(_lineTops);
+    free(_lineBottoms);
+    
+    for (NSUInteger column = 0; column < _numberOfColumns; column++) {
+        free(_columnItems[column]);
+    }
+    free(_columnItems);
+    free(_columnItemCounts);
+    free(_columnItemCapacities);
+    free(_columnBottoms);
+    free(_columnHeap);
+}
+
+@end
+
+
+@interface CPFlowLayoutEngine () {
+    NSMutableArray *_sections;//_CPFlowLayoutSectionGeometry, or NSNull if invalid
+    CGFloat *_sectionOrigins;//prefix sums of section heights, _sections.count + 1 entries
+    NSUInteger _sectionOriginsCapacity;
+    NSUInteger _firstInvalidSection;//origins after it need to be recomputed, NSNotFound if all valid
+}
+
+@end
+
+@implementation CPFlowLayoutEngine
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _sections = [NSMutableArray new];
+        _sectionOriginsCapacity = 1;
+        _sectionOrigins = calloc(_sectionOriginsCapacity, sizeof(CGFloat));
+        _firstInvalidSection = NSNotFound;
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    free(_sectionOrigins);
+}
+
+- (void)setContainerWidth:(CGFloat)containerWidth {
+    if (_containerWidth != containerWidth) {
+        _containerWidth = containerWidth;
+        [self invalidateAllSections];
+    }
+}
+
+- (NSUInteger)numberOfSections {
+    return _sections.count;
+}
+
+#pragma mark - Invalidate
+
+- (void)invalidateAllSections {
+    [self resetSectionsWithCount:_sections.count];
+}
+
+- (void)invalidateSections:(NSIndexSet *)sections {
+    NSUInteger numberOfSections = _sections.count;
+    [sections enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL * _Nonnull stop) {
+        if (idx >= numberOfSections) {
+            *stop = YES;
+            return;
+        }
+        
+        _sections[idx] = [NSNull null];
+    }];
+    
+    [self markSectionsInvalidFromSection:sections.firstIndex];
+}
+
+#pragma mark - Structural Changes
+
+- (void)insertSections:(NSIndexSet *)sections {
+    if (sections.count == 0) {
+        return;
+    }
+    
+    if (sections.lastIndex >= _sections.count + sections.count) {
+        //out of sync, prepare will rebuild all sections
+        [self invalidateAllSections];
+        return;
+    }
+    
+    NSMutableArray *placeholders = [NSMutableArray arrayWithCapacity:sections.count];
+    for (NSUInteger i = 0; i < sections.count; i++) {
+        [placeholders addObject:[NSNull null]];
+    }
+    [_sections insertObjects:placeholders atIndexes:sections];
+    [self markSectionsInvalidFromSection:sections.firstIndex];
+}
+
+- (void)deleteSections:(NSIndexSet *)sections {
+    if (sections.count == 0) {
+        return;
+    }
+    
+    if (sections.lastIndex >= _sections.count) {
+        //out of sync, prepare will rebuild all sections
+        [self invalidateAllSections];
+        return;
+    }
+    
+    [_sections removeObjectsAtIndexes:sections];
+    [self markSectionsInvalidFromSection:sections.firstIndex];
+}
+
+- (void)appendItemsInSection:(NSUInteger)section {
+    if (section >= _sections.count) {
+        //out of sync, prepare will rebuild all sections
+        [self invalidateAllSections];
+        return;
+    }
+    
+    _CPFlowLayoutSectionGeometry *geometry = _sections[section];
+    if ((id)geometry != [NSNull null]) {
+        if (geometry->_numberOfColumns > 0) {
+            geometry->_needsAppend = YES;
+        } else {
+            //line breaking of the last line may change, flow sections are laid out again
+            _sections[section] = [NSNull null];
+        }
+    }
+    [self markSectionsInvalidFromSection:section];
+}
+
+#pragma mark - Prepare
+
+- (void)prepare {
+    NSUInteger numberOfSections = [self.dataSource numberOfSectionsInFlowLayoutEngine:self];
+    if (numberOfSections != _sections.count) {
+        //bookkeeping does not match the data source, e.g. after reloadData
+        [self resetSectionsWithCount:numberOfSections];
+    }
+    
+    if (_firstInvalidSection == NSNotFound) {
+        return;
+    }
+    
+    if (_sectionOriginsCapacity < numberOfSections + 1) {
+        _sectionOriginsCapacity = MAX(numberOfSections + 1, _sectionOriginsCapacity * 2);
+        _sectionOrigins = realloc(_sectionOrigins, sizeof(CGFloat) * _sectionOriginsCapacity);
+    }
+    
+    //sections before _firstInvalidSection keep their geometry and origins
+    _sectionOrigins[0] = 0;
+    for (NSUInteger section = MIN(_firstInvalidSection, numberOfSections); section < numberOfSections; section++) {
+        _CPFlowLayoutSectionGeometry *geometry = _sections[section];
+        if ((id)geometry == [NSNull null]) {
+            geometry = [self geometryByLayingOutSection:section];
+            _sections[section] = geometry;
+        } else if (geometry->_needsAppend) {
+            geometry = [self geometryByAppendingItemsToGeometry:geometry inSection:section];
+            _sections[section] = geometry;
+        }
+        
+        _sectionOrigins[section + 1] = _sectionOrigins[section] + geometry->_height;
+    }
+    
+    _contentSize = CGSizeMake(_containerWidth, _sectionOrigins[numberOfSections]);
+    _firstInvalidSection = NSNotFound;
+}
+
+#pragma mark - Query
+
+- (CGRect)frameForItemAtIndex:(NSUInteger)item inSection:(NSUInteger)section {
+    _CPFlowLayoutSectionGeometry *geometry = [self validGeometryForSection:section];
+    if (!geometry || item >= geometry->_numberOfItems) {
+        return CGRectNull;
+    }
+    
+    return CGRectOffset(geometry->_itemFrames[item], 0, _sectionOrigins[section]);
+}
+
+- (CGRect)frameForHeaderInSection:(NSUInteger)section {
+    _CPFlowLayoutSectionGeometry *geometry = [self validGeometryForSection:section];
+    if (!geometry || CGRectIsNull(geometry->_headerFrame)) {
+        return CGRectNull;
+    }
+    
+    return CGRectOffset(geometry->_headerFrame, 0, _sectionOrigins[section]);
+}
+
+- (CGRect)frameForFooterInSection:(NSUInteger)section {
+    _CPFlowLayoutSectionGeometry *geometry = [self validGeometryForSection:section];
+    if (!geometry || CGRectIsNull(geometry->_footerFrame)) {
+        return CGRectNull;
+    }
+    
+    return CGRectOffset(geometry->_footerFrame, 0, _sectionOrigins[section]);
+}
+
+- (CGFloat)columnWidthForSection:(NSUInteger)section {
+    //not gated by _firstInvalidSection, the data source may ask while the section is being laid out
+    if (section >= _sections.count || _sections[section] == [NSNull null]) {
+        return 0;
+    }
+    
+    return ((_CPFlowLayoutSectionGeometry *)_sections[section])->_columnWidth;
+}
+
+- (void)enumerateElementsInRect:(CGRect)rect usingBlock:(CPFlowLayoutElementBlock)block {
+    NSParameterAssert(block);
+    
+    NSUInteger numberOfSections = _sections.count;
+    if (numberOfSections == 0 || CGRectIsEmpty(rect) || _firstInvalidSection != NSNotFound) {
+        return;
+    }
+    
+    const CGFloat minY = CGRectGetMinY(rect);
+    const CGFloat maxY = CGRectGetMaxY(rect);
+    BOOL stop = NO;
+    
+    //first section whose bottom is below minY
+    NSUInteger section = CPFlowLayoutFirstIndexGreaterThan(_sectionOrigins + 1, numberOfSections, minY);
+    for (; section < numberOfSections && _sectionOrigins[section] < maxY; section++) {
+        _CPFlowLayoutSectionGeometry *geometry = _sections[section];
+        const CGFloat originY = _sectionOrigins[section];
+        
+        CGRect headerFrame = CGRectOffset(geometry->_headerFrame, 0, originY);
+        if (!CGRectIsNull(geometry->_headerFrame) && CGRectIntersectsRect(headerFrame, rect)) {
+            block(CPFlowLayoutElementKindHeader, section, 0, headerFrame, &stop);
+            if (stop) {
+                return;
+            }
+        }
+        
+        if (geometry->_numberOfColumns > 0) {
+            //first item of each column whose bottom is below minY
+            for (NSUInteger column = 0; column < geometry->_numberOfColumns; column++) {
+                const NSUInteger *items = geometry->_columnItems[column];
+                const NSUInteger count = geometry->_columnItemCounts[column];
+                NSUInteger index = CPFlowLayoutFirstColumnItemWithBottomGreaterThan(geometry->_itemFrames, items, count, minY - originY);
+                for (; index < count && CGRectGetMinY(geometry->_itemFrames[items[index]]) < maxY - originY; index++) {
+                    CGRect frame = CGRectOffset(geometry->_itemFrames[items[index]], 0, originY);
+                    if (CGRectIsEmpty(frame) || !CGRectIntersectsRect(frame, rect)) {
+                        continue;
+                    }
+                    
+                    block(CPFlowLayoutElementKindCell, section, items[index], frame, &stop);
+                    if (stop) {
+                        return;
+                    }
+                }
+            }
+        } else {
+            //first line whose bottom is below minY
+            NSUInteger line = CPFlowLayoutFirstIndexGreaterThan(geometry->_lineBottoms, geometry->_numberOfLines, minY - originY);
+            for (; line < geometry->_numberOfLines && geometry->_lineTops[line] < maxY - originY; line++) {
+                for (NSUInteger item = geometry->_lineStarts[line]; item < geometry->_lineStarts[line + 1]; item++) {
+                    CGRect frame = CGRectOffset(geometry->_itemFrames[item], 0, originY);
+                    if (CGRectIsEmpty(frame) || !CGRectIntersectsRect(frame, rect)) {
+                        continue;
+                    }
+                    
+                    block(CPFlowLayoutElementKindCell, section, item, frame, &stop);
+                    if (stop) {
+                        return;
+                    }
+                }
+            }
+        }
+        
+        CGRect footerFrame = CGRectOffset(geometry->_footerFrame, 0, originY);
+        if (!CGRectIsNull(geometry->_footerFrame) && CGRectIntersectsRect(footerFrame, rect)) {
+            block(CPFlowLayoutElementKindFooter, section, 0, footerFrame, &stop);
+            if (stop) {
+                return;
+            }
+        }
+    }
+}
+
+#pragma mark - Private
+
+- (void)resetSectionsWithCount:(NSUInteger)numberOfSections {
+    [_sections removeAllObjects];
+    for (NSUInteger i = 0; i < numberOfSections; i++) {
+        [_sections addObject:[NSNull null]];
+    }
+    _firstInvalidSection = 0;
+}
+
+- (void)markSectionsInvalidFromSection:(NSUInteger)section {
+    if (section != NSNotFound && (_firstInvalidSection == NSNotFound || section < _firstInvalidSection)) {
+        _firstInvalidSection = section;
+    }
+}
+
+- (nullable _CPFlowLayoutSectionGeometry *)validGeometryForSection:(NSUInteger)section {
+    if (section >= _sections.count || _firstInvalidSection != NSNotFound) {
+        return nil;
+    }
+    
+    return _sections[section];
+}
+
+- (_CPFlowLayoutSectionGeometry *)geometryByLayingOutSection:(NSUInteger)section {
+    id<CPFlowLayoutEngineDataSource> dataSource = self.dataSource;
+    CPFlowLayoutSectionMetrics metrics = [dataSource flowLayoutEngine:self metricsForSection:section];
+    NSUInteger numberOfItems = [dataSource flowLayoutEngine:self numberOfItemsInSection:section];
+    const CGFloat width = _containerWidth;
+    
+    if (metrics.numberOfColumns > 0) {
+        return [self waterfallGeometryWithMetrics:metrics numberOfItems:numberOfItems inSection:section];
+    }
+    
+    _CPFlowLayoutSectionGeometry *geometry = [_CPFlowLayoutSectionGeometry new];
+    geometry->_numberOfItems = numberOfItems;
+    geometry->_itemFrames = malloc(sizeof(CGRect) * MAX(numberOfItems, 1));
+    geometry->_lineStarts = malloc(sizeof(NSUInteger) * (numberOfItems + 1));
+    geometry->_lineTops = malloc(sizeof(CGFloat) * MAX(numberOfItems, 1));
+    geometry->_lineBottoms = malloc(sizeof(CGFloat) * MAX(numberOfItems, 1));
+    geometry->_headerFrame = CGRectNull;
+    geometry->_footerFrame = CGRectNull;
+    
+    CGFloat y = 0;
+    if (metrics.headerHeight > 0) {
+        geometry->_headerFrame = CGRectMake(0, y, width, metrics.headerHeight);
+        y += metrics.headerHeight;
+    }
+    
+    //like UICollectionViewFlowLayout, section inset is ignored for empty sections
+    if (numberOfItems > 0) {
+        const CPFlowLayoutInsets inset = metrics.sectionInset;
+        const CGFloat availableWidth = MAX(width - inset.left - inset.right, 0);
+        const CGFloat interitemSpacing = metrics.minimumInteritemSpacing;
+        CGRect *frames = geometry->_itemFrames;
+        
+        for (NSUInteger item = 0; item < numberOfItems; item++) {
+            CGSize size = [dataSource flowLayoutEngine:self sizeForItemAtIndex:item inSection:section];
+            frames[item] = CGRectMake(0, 0, MAX(size.width, 0), MAX(size.height, 0));
+        }
+        
+        y += inset.top;
+        NSUInteger line = 0;
+        NSUInteger item = 0;
+        while (item < numberOfItems) {
+            //greedy line breaking, a line takes at least one item
+            const NSUInteger start = item;
+            CGFloat itemsWidth = frames[item].size.width;
+            CGFloat lineHeight = frames[item].size.height;
+            item++;
+            while (item < numberOfItems && itemsWidth + (item - start) * interitemSpacing + frames[item].size.width <= availableWidth + kCPFlowLayoutLineBreakTolerance) {
+                itemsWidth += frames[item].size.width;
+                lineHeight = MAX(lineHeight, frames[item].size.height);
+                item++;
+            }
+            
+            //justify items in line, center the only item
+            const NSUInteger count = item - start;
+            CGFloat x = inset.left;
+            CGFloat spacing = 0;
+            if (count == 1) {
+                x += MAX((availableWidth - itemsWidth) / 2, 0);
+            } else {
+                spacing = (availableWidth - itemsWidth) / (count - 1);
+            }
+            
+            if (line > 0) {
+                y += metrics.minimumLineSpacing;
+            }
+            
+            geometry->_lineStarts[line] = start;
+            geometry->_lineTops[line] = y;
+            geometry->_lineBottoms[line] = y + lineHeight;
+            for (NSUInteger i = start; i < item; i++) {
+                frames[i].origin.x = x;
+                frames[i].origin.y = y + (lineHeight - frames[i].size.height) / 2;
+                x += frames[i].size.width + spacing;
+            }
+            
+            y += lineHeight;
+            line++;
+        }
+        
+        geometry->_lineStarts[line] = numberOfItems;
+        geometry->_numberOfLines = line;
+        y += inset.bottom;
+    } else {
+        geometry->_lineStarts[0] = 0;
+    }
+    
+    if (metrics.footerHeight > 0) {
+        geometry->_footerFrame = CGRectMake(0, y, width, metrics.footerHeight);
+        y += metrics.footerHeight;
+    }
+    
+    geometry->_height = y;
+    return geometry;
+}
+
+#pragma mark - Waterfall
+
+- (_CPFlowLayoutSectionGeometry *)waterfallGeometryWithMetrics:(CPFlowLayoutSectionMetrics)metrics numberOfItems:(NSUInteger)numberOfItems inSection:(NSUInteger)section {
+    const NSUInteger numberOfColumns = metrics.numberOfColumns;
+    const CPFlowLayoutInsets inset = metrics.sectionInset;
+    const CGFloat availableWidth = MAX(_containerWidth - inset.left - inset.right, 0);
+    
+    _CPFlowLayoutSectionGeometry *geometry = [_CPFlowLayoutSectionGeometry new];
+    geometry->_metrics = metrics;
+    geometry->_numberOfColumns = numberOfColumns;
+    geometry->_columnWidth = MAX((availableWidth - (numberOfColumns - 1) * metrics.minimumInteritemSpacing) / numberOfColumns, 0);
+    geometry->_columnBottoms = malloc(sizeof(CGFloat) * numberOfColumns);
+    geometry->_columnHeap = malloc(sizeof(NSUInteger) * numberOfColumns);
+    geometry->_columnItems = calloc(numberOfColumns, sizeof(NSUInteger *));
+    geometry->_columnItemCounts = calloc(numberOfColumns, sizeof(NSUInteger));
+    geometry->_columnItemCapacities = calloc(numberOfColumns, sizeof(NSUInteger));
+    geometry->_headerFrame = CGRectNull;
+    geometry->_footerFrame = CGRectNull;
+    
+    if (metrics.headerHeight > 0) {
+        geometry->_headerFrame = CGRectMake(0, 0, _containerWidth, metrics.headerHeight);
+    }
+    
+    //columns of equal height are already a heap in column order
+    const CGFloat itemsTop = MAX(metrics.headerHeight, 0) + inset.top;
+    for (NSUInteger column = 0; column < numberOfColumns; column++) {
+        geometry->_columnBottoms[column] = itemsTop;
+        geometry->_columnHeap[column] = column;
+    }
+    
+    //published before the items are sized, so the data source can size them by the column width
+    if (section < _sections.count) {
+        _sections[section] = geometry;
+    }
+    [self placeWaterfallItemsInGeometry:geometry numberOfItems:numberOfItems inSection:section];
+    return geometry;
+}
+
+- (_CPFlowLayoutSectionGeometry *)geometryByAppendingItemsToGeometry:(_CPFlowLayoutSectionGeometry *)geometry inSection:(NSUInteger)section {
+    id<CPFlowLayoutEngineDataSource> dataSource = self.dataSource;
+    CPFlowLayoutSectionMetrics metrics = [dataSource flowLayoutEngine:self metricsForSection:section];
+    NSUInteger numberOfItems = [dataSource flowLayoutEngine:self numberOfItemsInSection:section];
+    if (numberOfItems < geometry->_numberOfItems || !CPFlowLayoutSectionMetricsEqualToMetrics(metrics, geometry->_metrics)) {
+        //not an append any more, lay out the section again
+        return [self geometryByLayingOutSection:section];
+    }
+    
+    //column bottoms are carried over, only the new items are placed
+    geometry->_needsAppend = NO;
+    [self placeWaterfallItemsInGeometry:geometry numberOfItems:numberOfItems inSection:section];
+    return geometry;
+}
+
+- (void)placeWaterfallItemsInGeometry:(_CPFlowLayoutSectionGeometry *)geometry numberOfItems:(NSUInteger)numberOfItems inSection:(NSUInteger)section {
+    id<CPFlowLayoutEngineDataSource> dataSource = self.dataSource;
+    const CPFlowLayoutSectionMetrics metrics = geometry->_metrics;
+    const NSUInteger numberOfColumns = geometry->_numberOfColumns;
+    const CGFloat columnWidth = geometry->_columnWidth;
+    CGFloat *columnBottoms = geometry->_columnBottoms;
+    NSUInteger *columnHeap = geometry->_columnHeap;
+    
+    if (geometry->_itemFramesCapacity < numberOfItems) {
+        geometry->_itemFramesCapacity = MAX(numberOfItems, geometry->_itemFramesCapacity * 2);
+        geometry->_itemFrames = realloc(geometry->_itemFrames, sizeof(CGRect) * geometry->_itemFramesCapacity);
+    }
+    
+    for (NSUInteger item = geometry->_numberOfItems; item < numberOfItems; item++) {
+        //item width is the column width, only the height is used
+        CGSize size = [dataSource flowLayoutEngine:self sizeForItemAtIndex:item inSection:section];
+        const NSUInteger column = columnHeap[0];
+        const NSUInteger count = geometry->_columnItemCounts[column];
+        const CGFloat top = columnBottoms[column] + (count > 0 ? metrics.minimumLineSpacing : 0);
+        geometry->_itemFrames[item] = CGRectMake(metrics.sectionInset.left + column * (columnWidth + metrics.minimumInteritemSpacing), top, columnWidth, MAX(size.height, 0));
+        
+        if (count == geometry->_columnItemCapacities[column]) {
+            geometry->_columnItemCapacities[column] = MAX(count * 2, 16);
+            geometry->_columnItems[column] = realloc(geometry->_columnItems[column], sizeof(NSUInteger) * geometry->_columnItemCapacities[column]);
+        }
+        geometry->_columnItems[column][count] = item;
+        geometry->_columnItemCounts[column] = count + 1;
+        
+        columnBottoms[column] = CGRectGetMaxY(geometry->_itemFrames[item]);
+        CPFlowLayoutColumnHeapSiftDown(columnHeap, numberOfColumns, columnBottoms);
+    }
+    geometry->_numberOfItems = numberOfItems;
+    
+    //like UICollectionViewFlowLayout, section inset is ignored for empty sections
+    CGFloat y = MAX(metrics.headerHeight, 0);
+    if (numberOfItems > 0) {
+        for (NSUInteger column = 0; column < numberOfColumns; column++) {
+            y = MAX(y, columnBottoms[column]);
+        }
+        y += metrics.sectionInset.bottom;
+    }
+    
+    geometry->_footerFrame = CGRectNull;
+    if (metrics.footerHeight > 0) {
+        geometry->_footerFrame = CGRectMake(0, y, _containerWidth, metrics.footerHeight);
+        y += metrics.footerHeight;
+    }
+    
+    geometry->_height = y;
+}
+
+@end
@@ -0,0 +1,88 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, CPCollectionViewMetricsEvent) {
+    CPCollectionViewMetricsEventSizeCallback,//sizeForCellCallback, sizeForHeaderCallback and sizeForFooterCallback
+    CPCollectionViewMetricsEventMeasurement,//template view measurement with Auto Layout
+    CPCollectionViewMetricsEventConfiguration,//cellDidReuseCallback, headerDidReuseCallback and footerDidReuseCallback
+    CPCollectionViewMetricsEventDequeue//dequeue cell or supplementary view
+};
+
+typedef struct CPMetricsInterval {
+    uint64_t beginTime;//mach absolute time
+    uint64_t signpostID;
+} CPMetricsInterval;
+
+/**
+ 耗时直方图的不可变快照，第0个桶为小于1µs，第i个桶为[2^(i-1)µs, 2^i µs)，最后一个桶无上界
+ */
+@interface CPMetricsHistogram : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) NSTimeInterval totalDuration;
+@property (nonatomic, readonly) NSTimeInterval averageDuration;
+@property (nonatomic, readonly) NSTimeInterval maxDuration;
+
+@property (nonatomic, readonly) NSUInteger numberOfBuckets;
+
+- (NSUInteger)countInBucketAtIndex:(NSUInteger)index;
+- (NSTimeInterval)upperBoundOfBucketAtIndex:(NSUInteger)index;//return DBL_MAX for the last bucket
+- (NSTimeInterval)durationAtPercentile:(double)percentile;//percentile in [0, 1], return upper bound of the bucket it falls in
+
+@end
+
+/**
+ 按reuseIdentifier统计尺寸计算、模板测量、配置及dequeue的次数与耗时，以及批量更新、刷新与布局的次数 (线程安全)
+ iOS 12及以上同时输出os_signpost区间，可在Instruments的Points of Interest中查看
+ */
+@interface CPCollectionViewMetrics : NSObject
+
+@property (nonatomic) BOOL signpostsEnabled;//The default value of this property is YES
+
+#pragma mark - Counters
+
+@property (nonatomic, readonly) NSUInteger batchUpdateCount;//cp_performBatchUpdates:completion: and cp_applySectionInfos:animated:
+@property (nonatomic, readonly) NSUInteger reloadCount;//cp_reload*
+@property (nonatomic, readonly) NSUInteger layoutPassCount;//prepareLayout of CPDataDrivenLayout
+
+#pragma mark - Histograms
+
+- (NSDictionary<NSString *, CPMetricsHistogram *> *)histogramsForEvent:(CPCollectionViewMetricsEvent)event;//snapshot keyed by reuse identifier
+
+- (void)reset;
+
+#pragma mark - Recording
+
+- (CPMetricsInterval)beginInterval:(CPCollectionViewMetricsEvent)event reuseIdentifier:(nullable NSString *)reuseIdentifier;
+- (void)endInterval:(CPMetricsInterval)interval event:(CPCollectionViewMetricsEvent)event reuseIdentifier:(nullable NSString *)reuseIdentifier;
+
+- (void)recordBatchUpdate;
+- (void)recordReload;
+- (void)recordLayoutPass;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,351 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPCollectionViewMetrics.h"
+#import <mach/mach_time.h>
+#import <pthread.h>
+
+#if __has_include(<os/signpost.h>)
+#import <os/signpost.h>
+#define CP_METRICS_SIGNPOST_AVAILABLE 1
+#else
+#define CP_METRICS_SIGNPOST_AVAILABLE 0
+#endif
+
+#define CP_METRICS_BUCKET_COUNT 24 //the last bucket starts at ~4s
+#define CP_METRICS_EVENT_COUNT 4
+
+static NSString * const _CPMetricsUnknownReuseIdentifier = @"<unknown>";
+
+static uint64_t CPMetricsNanosecondsFromMachTime(uint64_t machTime) {
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    
+    return machTime * timebase.numer / timebase.denom;
+}
+
+static NSUInteger CPMetricsBucketIndexForNanoseconds(uint64_t nanoseconds) {
+    uint64_t microseconds = nanoseconds / 1000;
+    if (microseconds == 0) {
+        return 0;
+    }
+    
+    NSUInteger index = 64 - __builtin_clzll(microseconds);//floor(log2) + 1
+    return MIN(index, CP_METRICS_BUCKET_COUNT - 1);
+}
+
+typedef struct _CPMetricsHistogramStorage {
+    NSUInteger count;
+    uint64_t totalNanoseconds;
+    uint64_t maxNanoseconds;
+    NSUInteger buckets[CP_METRICS_BUCKET_COUNT];
+} _CPMetricsHistogramStorage;
+
+
+@interface CPMetricsHistogram () {
+    _CPMetricsHistogramStorage _storage;
+}
+
+@end
+
+@implementation CPMetricsHistogram
+
+- (instancetype)initWithStorage:(_CPMetricsHistogramStorage)storage {
+    self = [super init];
+    if (self) {
+        _storage = storage;
+    }
+    
+    return self;
+}
+
+- (NSUInteger)count {
+    return _storage.count;
+}
+
+- (NSTimeInterval)totalDuration {
+    return _storage.totalNanoseconds / (NSTimeInterval)NSEC_PER_SEC;
+}
+
+- (NSTimeInterval)averageDuration {
+    return _storage.count > 0 ? self.totalDuration / _storage.count : 0;
+}
+
+- (NSTimeInterval)maxDuration {
+    return _storage.maxNanoseconds / (NSTimeInterval)NSEC_PER_SEC;
+}
+
+- (NSUInteger)numberOfBuckets {
+    return CP_METRICS_BUCKET_COUNT;
+}
+
+- (NSUInteger)countInBucketAtIndex:(NSUInteger)index {
+    return index < CP_METRICS_BUCKET_COUNT ? _storage.buckets[index] : 0;
+}
+
+- (NSTimeInterval)upperBoundOfBucketAtIndex:(NSUInteger)index {
+    if (index >= CP_METRICS_BUCKET_COUNT - 1) {
+        return DBL_MAX;
+    }
+    
+    return (1ull << index) / (NSTimeInterval)USEC_PER_SEC;
+}
+
+- (NSTimeInterval)durationAtPercentile:(double)percentile {
+    if (_storage.count == 0) {
+        return 0;
+    }
+    
+    NSUInteger rank = (NSUInteger)ceil(MIN(MAX(percentile, 0), 1) * _storage.count);
+    NSUInteger accumulated = 0;
+    for (NSUInteger index = 0; index < CP_METRICS_BUCKET_COUNT; index++) {
+        accumulated += _storage.buckets[index];
+        if (accumulated >= MAX(rank, 1)) {
+            return MIN([self upperBoundOfBucketAtIndex:index], self.maxDuration);
+        }
+    }
+    
+    return self.maxDuration;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; count = %lu; average = %.1fµs; p99 = %.1fµs; max = %.1fµs>", NSStringFromClass([self class]), self, (unsigned long)self.count, self.averageDuration * USEC_PER_SEC, [self durationAtPercentile:0.99] * USEC_PER_SEC, self.maxDuration * USEC_PER_SEC];
+}
+
+@end
+
+
+@interface CPCollectionViewMetrics () {
+    pthread_mutex_t _lock;
+    NSMutableDictionary<NSString *, NSMutableData *> *_storagesByReuseIdentifier[CP_METRICS_EVENT_COUNT];//NSMutableData wraps _CPMetricsHistogramStorage
+    NSUInteger _batchUpdateCount;
+    NSUInteger _reloadCount;
+    NSUInteger _layoutPassCount;
+#if CP_METRICS_SIGNPOST_AVAILABLE
+    os_log_t _signpostLog;
+#endif
+}
+
+@end
+
+@implementation CPCollectionViewMetrics
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        pthread_mutex_init(&_lock, NULL);
+        for (NSUInteger event = 0; event < CP_METRICS_EVENT_COUNT; event++) {
+            _storagesByReuseIdentifier[event] = [NSMutableDictionary new];
+        }
+        _signpostsEnabled = YES;
+#if CP_METRICS_SIGNPOST_AVAILABLE
+        if (@available(iOS 12.0, *)) {
+            _signpostLog = os_log_create("com.caoping.CPDataDrivenFlowLayout", OS_LOG_CATEGORY_POINTS_OF_INTEREST);
+        }
+#endif
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+#pragma mark - Counters
+
+- (NSUInteger)batchUpdateCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _batchUpdateCount;
+    pthread_mutex_unlock(&_lock);
+    
+    return count;
+}
+
+- (NSUInteger)reloadCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _reloadCount;
+    pthread_mutex_unlock(&_lock);
+    
+    return count;
+}
+
+- (NSUInteger)layoutPassCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _layoutPassCount;
+    pthread_mutex_unlock(&_lock);
+    
+    return count;
+}
+
+#pragma mark - Histograms
+
+- (NSDictionary<NSString *, CPMetricsHistogram *> *)histogramsForEvent:(CPCollectionViewMetricsEvent)event {
+    if (event < 0 || event >= CP_METRICS_EVENT_COUNT) {
+        return @{};
+    }
+    
+    pthread_mutex_lock(&_lock);
+    NSMutableDictionary<NSString *, CPMetricsHistogram *> *histograms = [NSMutableDictionary dictionaryWithCapacity:_storagesByReuseIdentifier[event].count];
+    [_storagesByReuseIdentifier[event] enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull reuseIdentifier, NSMutableData * _Nonnull data, BOOL * _Nonnull stop) {
+        histograms[reuseIdentifier] = [[CPMetricsHistogram alloc] initWithStorage:*(_CPMetricsHistogramStorage *)data.bytes];
+    }];
+    pthread_mutex_unlock(&_lock);
+    
+    return [histograms copy];
+}
+
+- (void)reset {
+    pthread_mutex_lock(&_lock);
+    for (NSUInteger event = 0; event < CP_METRICS_EVENT_COUNT; event++) {
+        [_storagesByReuseIdentifier[event] removeAllObjects];
+    }
+    _batchUpdateCount = 0;
+    _reloadCount = 0;
+    _layoutPassCount = 0;
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark - Recording
+
+- (CPMetricsInterval)beginInterval:(CPCollectionViewMetricsEvent)event reuseIdentifier:(NSString *)reuseIdentifier {
+    CPMetricsInterval interval = {0, 0};
+#if CP_METRICS_SIGNPOST_AVAILABLE
+    if (_signpostsEnabled) {
+        if (@available(iOS 12.0, *)) {
+            os_log_t log = _signpostLog;
+            os_signpost_id_t signpostID = os_signpost_id_generate(log);
+            interval.signpostID = signpostID;
+            //signpost names must be string literals
+            switch (event) {
+                case CPCollectionViewMetricsEventSizeCallback:
+                    os_signpost_interval_begin(log, signpostID, "SizeCallback", "%{public}@", reuseIdentifier);
+                    break;
+                case CPCollectionViewMetricsEventMeasurement:
+                    os_signpost_interval_begin(log, signpostID, "Measurement", "%{public}@", reuseIdentifier);
+                    break;
+                case CPCollectionViewMetricsEventConfiguration:
+                    os_signpost_interval_begin(log, signpostID, "Configuration", "%{public}@", reuseIdentifier);
+                    break;
+                case CPCollectionViewMetricsEventDequeue:
+                    os_signpost_interval_begin(log, signpostID, "Dequeue", "%{public}@", reuseIdentifier);
+                    break;
+            }
+        }
+    }
+#endif
+    interval.beginTime = mach_absolute_time();
+    
+    return interval;
+}
+
+- (void)endInterval:(CPMetricsInterval)interval event:(CPCollectionViewMetricsEvent)event reuseIdentifier:(NSString *)reuseIdentifier {
+    uint64_t endTime = mach_absolute_time();
+    if (event < 0 || event >= CP_METRICS_EVENT_COUNT || interval.beginTime == 0) {
+        return;
+    }
+    
+#if CP_METRICS_SIGNPOST_AVAILABLE
+    if (interval.signpostID != 0) {
+        if (@available(iOS 12.0, *)) {
+            os_log_t log = _signpostLog;
+            os_signpost_id_t signpostID = interval.signpostID;
+            switch (event) {
+                case CPCollectionViewMetricsEventSizeCallback:
+                    os_signpost_interval_end(log, signpostID, "SizeCallback");
+                    break;
+                case CPCollectionViewMetricsEventMeasurement:
+                    os_signpost_interval_end(log, signpostID, "Measurement");
+                    break;
+                case CPCollectionViewMetricsEventConfiguration:
+                    os_signpost_interval_end(log, signpostID, "Configuration");
+                    break;
+                case CPCollectionViewMetricsEventDequeue:
+                    os_signpost_interval_end(log, signpostID, "Dequeue");
+                    break;
+            }
+        }
+    }
+#endif
+    
+    uint64_t nanoseconds = CPMetricsNanosecondsFromMachTime(endTime - interval.beginTime);
+    NSString *key = reuseIdentifier ?: _CPMetricsUnknownReuseIdentifier;
+    
+    pthread_mutex_lock(&_lock);
+    NSMutableData *data = _storagesByReuseIdentifier[event][key];
+    if (!data) {
+        data = [NSMutableData dataWithLength:sizeof(_CPMetricsHistogramStorage)];//zero filled
+        _storagesByReuseIdentifier[event][key] = data;
+    }
+    _CPMetricsHistogramStorage *storage = data.mutableBytes;
+    storage->count++;
+    storage->totalNanoseconds += nanoseconds;
+    storage->maxNanoseconds = MAX(storage->maxNanoseconds, nanoseconds);
+    storage->buckets[CPMetricsBucketIndexForNanoseconds(nanoseconds)]++;
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)recordBatchUpdate {
+    pthread_mutex_lock(&_lock);
+    _batchUpdateCount++;
+    pthread_mutex_unlock(&_lock);
+    
+#if CP_METRICS_SIGNPOST_AVAILABLE
+    if (_signpostsEnabled) {
+        if (@available(iOS 12.0, *)) {
+            os_signpost_event_emit(_signpostLog, OS_SIGNPOST_ID_EXCLUSIVE, "BatchUpdate");
+        }
+    }
+#endif
+}
+
+- (void)recordReload {
+    pthread_mutex_lock(&_lock);
+    _reloadCount++;
+    pthread_mutex_unlock(&_lock);
+    
+#if CP_METRICS_SIGNPOST_AVAILABLE
+    if (_signpostsEnabled) {
+        if (@available(iOS 12.0, *)) {
+            os_signpost_event_emit(_signpostLog, OS_SIGNPOST_ID_EXCLUSIVE, "Reload");
+        }
+    }
+#endif
+}
+
+- (void)recordLayoutPass {
+    pthread_mutex_lock(&_lock);
+    _layoutPassCount++;
+    pthread_mutex_unlock(&_lock);
+    
+#if CP_METRICS_SIGNPOST_AVAILABLE
+    if (_signpostsEnabled) {
+        if (@available(iOS 12.0, *)) {
+            os_signpost_event_emit(_signpostLog, OS_SIGNPOST_ID_EXCLUSIVE, "LayoutPass");
+        }
+    }
+#endif
+}
+
+@end
@@ -0,0 +1,40 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ 在主线程runloop空闲时 (default mode，滑动时不执行) 按reuseIdentifier提前创建模板cell，加载nib及cell的class、图片等资源，避免某种cell第一次出现时卡顿
+ 安装后会处理已注册及之后通过cp_register*接口注册的cell；收到内存警告后停止
+ */
+@interface CPReusableViewPrewarmer : NSObject
+
+@property (nonatomic) NSUInteger numberOfReuseIdentifiersPerIdle;//The default value of this property is 1, cells prewarmed in one idle pass
+@property (nonatomic, readonly) NSUInteger numberOfPendingReuseIdentifiers;
+@property (nonatomic, readonly, getter=isStopped) BOOL stopped;//YES after a memory warning, pending reuse identifiers are dropped and new ones are ignored
+
+@end
+
+NS_ASSUME_NONNULL_END
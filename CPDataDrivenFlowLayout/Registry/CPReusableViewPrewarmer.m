@@ -0,0 +1,122 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPReusableViewPrewarmer.h"
+#import "UICollectionView+CPTemplateLayoutCell.h"
+
+@interface CPReusableViewPrewarmer () {
+    NSMutableOrderedSet<NSString *> *_pendingReuseIdentifiers;
+    NSMutableSet<NSString *> *_prewarmedReuseIdentifiers;
+    CFRunLoopObserverRef _idleObserver;
+}
+
+@property (nonatomic, weak, nullable) UICollectionView *collectionView;
+
+@end
+
+@implementation CPReusableViewPrewarmer
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _numberOfReuseIdentifiersPerIdle = 1;
+        _pendingReuseIdentifiers = [NSMutableOrderedSet new];
+        _prewarmedReuseIdentifiers = [NSMutableSet new];
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(stop) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [self removeIdleObserver];
+}
+
+#pragma mark - Getter
+
+- (NSUInteger)numberOfPendingReuseIdentifiers {
+    return _pendingReuseIdentifiers.count;
+}
+
+#pragma mark - Enqueue
+
+- (void)enqueueCellReuseIdentifier:(NSString *)reuseIdentifier {
+    NSAssert([NSThread isMainThread], @"prewarmer must be used on the main thread");
+    
+    if (_stopped || [_prewarmedReuseIdentifiers containsObject:reuseIdentifier]) {
+        return;
+    }
+    
+    [_pendingReuseIdentifiers addObject:reuseIdentifier];
+    [self addIdleObserverIfNeeded];
+}
+
+- (void)stop {
+    _stopped = YES;
+    [_pendingReuseIdentifiers removeAllObjects];
+    [self removeIdleObserver];
+}
+
+#pragma mark - Idle
+
+- (void)addIdleObserverIfNeeded {
+    if (_idleObserver) {
+        return;
+    }
+    
+    //runs before the main run loop sleeps, after Core Animation has committed the frame
+    __weak typeof(self) weakSelf = self;
+    _idleObserver = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, kCFRunLoopBeforeWaiting, true, INT_MAX, ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+        [weakSelf prewarmPendingReuseIdentifiers];
+    });
+    CFRunLoopAddObserver(CFRunLoopGetMain(), _idleObserver, kCFRunLoopDefaultMode);
+}
+
+- (void)removeIdleObserver {
+    if (_idleObserver) {
+        CFRunLoopObserverInvalidate(_idleObserver);
+        CFRelease(_idleObserver);
+        _idleObserver = NULL;
+    }
+}
+
+- (void)prewarmPendingReuseIdentifiers {
+    UICollectionView *collectionView = self.collectionView;
+    NSUInteger count = MAX(_numberOfReuseIdentifiersPerIdle, 1);
+    while (collectionView && count > 0 && _pendingReuseIdentifiers.count > 0) {
+        NSString *reuseIdentifier = _pendingReuseIdentifiers.firstObject;
+        [_pendingReuseIdentifiers removeObjectAtIndex:0];
+        [_prewarmedReuseIdentifiers addObject:reuseIdentifier];
+        
+        //decodes the nib and loads the class and its resources once, the template cell is kept for sizing
+        [collectionView cp_templateCellForReuseIdentifier:reuseIdentifier];
+        count--;
+    }
+    
+    if (!collectionView || _pendingReuseIdentifiers.count == 0) {
+        [self removeIdleObserver];
+    }
+}
+
+@end
@@ -0,0 +1,55 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ 记录通过cp_*接口注册的cell及SupplementaryView，替代读取UICollectionView私有字典
+ 判断是否已注册及创建模板view均只需一次哈希查找 (非线程安全，仅在主线程使用)
+ */
+@interface CPReusableViewRegistry : NSObject
+
+#pragma mark - Cell
+
+- (BOOL)registerCellClass:(Class)cellClass forReuseIdentifier:(NSString *)reuseIdentifier;//return NO if reuseIdentifier has been registered
+- (BOOL)registerCellNib:(UINib *)nib forReuseIdentifier:(NSString *)reuseIdentifier;//return NO if reuseIdentifier has been registered
+
+- (BOOL)containsCellWithReuseIdentifier:(NSString *)reuseIdentifier;
+- (nullable Class)cellClassForReuseIdentifier:(NSString *)reuseIdentifier;
+- (nullable UINib *)cellNibForReuseIdentifier:(NSString *)reuseIdentifier;
+- (NSArray<NSString *> *)cellReuseIdentifiers;
+
+#pragma mark - Supplementary View
+
+- (BOOL)registerSupplementaryViewClass:(Class)viewClass ofKind:(NSString *)kind forReuseIdentifier:(NSString *)reuseIdentifier;//return NO if reuseIdentifier has been registered for kind
+- (BOOL)registerSupplementaryViewNib:(UINib *)nib ofKind:(NSString *)kind forReuseIdentifier:(NSString *)reuseIdentifier;//return NO if reuseIdentifier has been registered for kind
+
+- (BOOL)containsSupplementaryViewOfKind:(NSString *)kind reuseIdentifier:(NSString *)reuseIdentifier;
+- (nullable Class)supplementaryViewClassOfKind:(NSString *)kind reuseIdentifier:(NSString *)reuseIdentifier;
+- (nullable UINib *)supplementaryViewNibOfKind:(NSString *)kind reuseIdentifier:(NSString *)reuseIdentifier;
+
+@end
+
+NS_ASSUME_NONNULL_END
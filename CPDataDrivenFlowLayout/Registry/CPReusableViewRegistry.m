@@ -0,0 +1,120 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 caoping <caoping.dev@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#import "CPReusableViewRegistry.h"
+
+@interface CPReusableViewRegistry ()
+
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, id> *cellRegistrations;//reuseIdentifier -> Class or UINib
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, id> *> *supplementaryViewRegistrationsByKind;//kind -> reuseIdentifier -> Class or UINib
+
+@end
+
+@implementation CPReusableViewRegistry
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _cellRegistrations = [NSMutableDictionary new];
+        _supplementaryViewRegistrationsByKind = [NSMutableDictionary new];
+    }
+    
+    return self;
+}
+
+#pragma mark - Cell
+
+- (BOOL)registerCellClass:(Class)cellClass forReuseIdentifier:(NSString *)reuseIdentifier {
+    return [self registerObject:cellClass forReuseIdentifier:reuseIdentifier inRegistrations:_cellRegistrations];
+}
+
+- (BOOL)registerCellNib:(UINib *)nib forReuseIdentifier:(NSString *)reuseIdentifier {
+    return [self registerObject:nib forReuseIdentifier:reuseIdentifier inRegistrations:_cellRegistrations];
+}
+
+- (BOOL)containsCellWithReuseIdentifier:(NSString *)reuseIdentifier {
+    return _cellRegistrations[reuseIdentifier] != nil;
+}
+
+- (nullable Class)cellClassForReuseIdentifier:(NSString *)reuseIdentifier {
+    id registration = _cellRegistrations[reuseIdentifier];
+    return [registration isKindOfClass:[UINib class]] ? nil : registration;
+}
+
+- (nullable UINib *)cellNibForReuseIdentifier:(NSString *)reuseIdentifier {
+    id registration = _cellRegistrations[reuseIdentifier];
+    return [registration isKindOfClass:[UINib class]] ? registration : nil;
+}
+
+- (NSArray<NSString *> *)cellReuseIdentifiers {
+    return _cellRegistrations.allKeys;
+}
+
+#pragma mark - Supplementary View
+
+- (BOOL)registerSupplementaryViewClass:(Class)viewClass ofKind:(NSString *)kind forReuseIdentifier:(NSString *)reuseIdentifier {
+    return [self registerObject:viewClass forReuseIdentifier:reuseIdentifier inRegistrations:[self supplementaryViewRegistrationsOfKind:kind]];
+}
+
+- (BOOL)registerSupplementaryViewNib:(UINib *)nib ofKind:(NSString *)kind forReuseIdentifier:(NSString *)reuseIdentifier {
+    return [self registerObject:nib forReuseIdentifier:reuseIdentifier inRegistrations:[self supplementaryViewRegistrationsOfKind:kind]];
+}
+
+- (BOOL)containsSupplementaryViewOfKind:(NSString *)kind reuseIdentifier:(NSString *)reuseIdentifier {
+    return _supplementaryViewRegistrationsByKind[kind][reuseIdentifier] != nil;
+}
+
+- (nullable Class)supplementaryViewClassOfKind:(NSString *)kind reuseIdentifier:(NSString *)reuseIdentifier {
+    id registration = _supplementaryViewRegistrationsByKind[kind][reuseIdentifier];
+    return [registration isKindOfClass:[UINib class]] ? nil : registration;
+}
+
+- (nullable UINib *)supplementaryViewNibOfKind:(NSString *)kind reuseIdentifier:(NSString *)reuseIdentifier {
+    id registration = _supplementaryViewRegistrationsByKind[kind][reuseIdentifier];
+    return [registration isKindOfClass:[UINib class]] ? registration : nil;
+}
+
+#pragma mark - Private
+
+- (NSMutableDictionary<NSString *, id> *)supplementaryViewRegistrationsOfKind:(NSString *)kind {
+    NSMutableDictionary *registrations = _supplementaryViewRegistrationsByKind[kind];
+    if (!registrations) {
+        registrations = [NSMutableDictionary new];
+        _supplementaryViewRegistrationsByKind[kind] = registrations;
+    }
+    
+    return registrations;
+}
+
+- (BOOL)registerObject:(id)object forReuseIdentifier:(NSString *)reuseIdentifier inRegistrations:(NSMutableDictionary<NSString *, id> *)registrations {
+    NSParameterAssert(object);
+    NSParameterAssert(reuseIdentifier);
+    
+    if (!object || !reuseIdentifier || registrations[reuseIdentifier]) {
+        return NO;
+    }
+    registrations[reuseIdentifier] = object;
+    
+    return YES;
+}
+
+@end
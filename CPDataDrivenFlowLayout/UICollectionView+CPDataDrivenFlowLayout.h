@@ -22,6 +22,7 @@
 
 #import <UIKit/UIKit.h>
 #import "CPCollectionViewSectionInfo.h"
+#import "CPCollectionViewSnapshot.h"
 #import "CPCollectionViewDelegateFlowLayoutInterceptor.h"
 #import "CPCollectionViewDataSourceInterceptor.h"
 
@@ -29,6 +30,17 @@ static NSString * _Nonnull _CPPlaceholderSupplementaryView = @"_CPPlaceholderSup
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ cp_sectionInfos中每个section的item数量与间距的连续数组镜像 (struct of arrays)，第i个section的值位于各数组的第i个元素
+ */
+typedef struct CPCollectionViewSectionGeometry {
+    NSInteger numberOfSections;
+    const NSInteger *numberOfItems;
+    const UIEdgeInsets *sectionInsets;
+    const CGFloat *minimumLineSpacings;
+    const CGFloat *minimumInteritemSpacings;
+} CPCollectionViewSectionGeometry;
+
 @interface UICollectionView (CPDataDrivenFlowLayout)
 
 /**
@@ -96,6 +108,93 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)cp_reloadItemAtIndexPath:(NSIndexPath *)indexPath;
 
 
+#pragma mark - Reconfiguring
+
+
+/**
+ 根据某一个cellInfo更新对应的cell，不重新dequeue cell
+ 同一runloop内的多次更新会合并：可见cell直接调用cellDidReuseCallback重新配置，仅尺寸变化的cell会使布局失效 (合并为一次)
+ cellReuseIdentifier变化或在cp_performBatchUpdates内调用时等同于cp_reloadItemWithCellInfo:atIndexPath:
+
+ @param cellInfo cellInfo对象
+ @param indexPath cell索引
+ */
+- (void)cp_reconfigureItemWithCellInfo:(CPCollectionViewCellInfo *)cellInfo atIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ 根据某一个cell索引重新配置对应的cell，参见cp_reconfigureItemWithCellInfo:atIndexPath:
+
+ @param indexPath cell索引
+ */
+- (void)cp_reconfigureItemAtIndexPath:(NSIndexPath *)indexPath;
+
+
+#pragma mark - Applying
+
+
+/**
+ 根据sectionInfos与当前cp_sectionInfos的差异，以批量插入、删除、移动的方式刷新 (不调用reloadData)
+ section与cell通过identifier匹配，无identifier时按对象匹配；data或contentFingerprint变化的cell会被重新加载
+ 注意：请传入新的sectionInfo/cellInfos数组，直接修改当前sectionInfo的cellInfos将无法检测到差异
+
+ @param sectionInfos sectionInfo数组
+ @param animated 是否开启动画
+ */
+- (void)cp_applySectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos animated:(BOOL)animated;
+
+/**
+ 根据sectionInfos与当前cp_sectionInfos的差异，以批量插入、删除、移动的方式刷新 (不调用reloadData)
+
+ @param sectionInfos sectionInfo数组
+ @param animated 是否开启动画
+ @param completion 批量更新完成后的回调
+ */
+- (void)cp_applySectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos animated:(BOOL)animated completion:(nullable void (^)(BOOL finished))completion;
+
+
+#pragma mark - Snapshot
+
+
+/**
+ 当前cp_sectionInfos的快照，可传至其他队列mutableCopy后修改，再通过cp_applySnapshot:animated:应用
+ 快照与当前section共享，之后通过cp_*接口修改某个section的items时，该section在第一次修改前被复制一次 (O(该section的items))，快照不受影响
+ 注意：直接修改section的属性或调用sectionInfo的cp_*接口会同时修改快照，CPCollectionViewLazySectionInfo不会被复制
+ */
+@property (nonatomic, readonly) CPCollectionViewSnapshot *cp_snapshot;
+
+/**
+ 在主线程应用快照 (可在任意队列创建)，一次性替换cp_sectionInfos并以批量插入、删除、移动的方式刷新
+ 与当前cp_sectionInfos相同的section不会被遍历，开销为O(被修改的section的items)而非O(修改次数)，在一个很大的section中修改一个item也会比较该section的全部items
+ 应用后快照仍与当前section共享，之后通过cp_*接口修改时会先复制被修改的section，快照不受影响
+
+ @param snapshot 快照
+ @param animated 是否开启动画
+ */
+- (void)cp_applySnapshot:(CPCollectionViewSnapshot *)snapshot animated:(BOOL)animated;
+
+/**
+ 在主线程应用快照
+
+ @param snapshot 快照
+ @param animated 是否开启动画
+ @param completion 批量更新完成后的回调
+ */
+- (void)cp_applySnapshot:(CPCollectionViewSnapshot *)snapshot animated:(BOOL)animated completion:(nullable void (^)(BOOL finished))completion;
+
+
+#pragma mark - Batch Updates
+
+
+/**
+ 批量更新：updates中调用的cp_*插入、追加、删除、移动、刷新接口会立即修改数据，结束时按最终结果合并为一次performBatchUpdates
+ 嵌套调用时并入最外层的批量更新；请在updates中通过cp_*接口修改数据，直接修改sectionInfo的cellInfos将无法被记录
+
+ @param updates 批量更新block
+ @param completion 批量更新完成后的回调
+ */
+- (void)cp_performBatchUpdates:(void (^)(void))updates completion:(nullable void (^)(BOOL finished))completion;
+
+
 #pragma mark - Inserting
 
 
@@ -137,6 +236,63 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)cp_appendCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos inSection:(NSInteger)inSection;
 
 
+/**
+ 先在后台并发队列中通过sizeForDataCallback或cellClass实现的CPStaticSizing预计算尺寸，回到主线程发布后再将cellInfos追加至对应的section末尾
+ 追加时所有尺寸均已就绪，布局时不再逐个计算；两者均未提供的cellInfo仍在布局时计算
+
+ @param cellInfos cellInfo数组
+ @param inSection section索引
+ @param preferredLayoutDimension 预计算使用的preferredLayoutDimension，需与sizeForCellCallback中使用的一致
+ @param preferredLayoutValue 预计算使用的preferredLayoutValue，需与sizeForCellCallback中使用的一致
+ @param completion 追加完成后的回调，appended为NO表示section在此期间被删除，cellInfos未追加
+ */
+- (void)cp_appendCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos
+                 inSection:(NSInteger)inSection
+  preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+      preferredLayoutValue:(CGFloat)preferredLayoutValue
+                completion:(nullable void (^)(BOOL appended))completion;
+
+
+#pragma mark - Precomputing Sizes
+
+
+/**
+ 在后台并发队列中通过sizeForDataCallback或cellClass实现的CPStaticSizing预计算cellInfos的尺寸，完成后在主线程发布至cellInfo并回调
+ 设置了contentFingerprint的cellInfo会优先复用cp_contentSizeCache中的尺寸
+ 实现NSCopying的data会先复制再交给后台计算，其余data在回调之前不可修改
+
+ @param cellInfos cellInfo数组
+ @param preferredLayoutDimension 预计算使用的preferredLayoutDimension
+ @param preferredLayoutValue 预计算使用的preferredLayoutValue
+ @param completion 尺寸发布后在主线程的回调
+ */
+- (void)cp_precomputeSizesForCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos
+              preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+                  preferredLayoutValue:(CGFloat)preferredLayoutValue
+                            completion:(nullable void (^)(void))completion;
+
+
+#pragma mark - Moving
+
+
+/**
+ 将section移动至新的索引
+
+ @param section 原section索引
+ @param newSection 目标section索引
+ */
+- (void)cp_moveSection:(NSInteger)section toSection:(NSInteger)newSection;
+
+
+/**
+ 将item移动至新的索引
+
+ @param indexPath 原索引
+ @param newIndexPath 目标索引 (移除原item后的位置)
+ */
+- (void)cp_moveItemAtIndexPath:(NSIndexPath *)indexPath toIndexPath:(NSIndexPath *)newIndexPath;
+
+
 #pragma mark - Deleting
 
 
@@ -149,7 +305,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 
 /**
- 根据index集合删除对应section中的items
+ 根据index集合删除对应section中的items (删除后section为空时会一并删除该section)
 
  @param section section索引
  @param indexSet 需要删除的index集合
@@ -178,6 +334,16 @@ NS_ASSUME_NONNULL_BEGIN
 - (nullable CPCollectionViewSectionInfo *)cp_sectionInfoForSection:(NSInteger)section;
 
 
+/**
+ 返回section几何信息的镜像，供布局回调以数组下标直接读取，避免每次回调都查找sectionInfo对象
+ 插入、删除、替换section后下次调用时重新生成一次；通过cp_*接口或sectionInfo修改item数量、sectionInset、minimumLineSpacing、minimumInteritemSpacing后只重新读取被修改的section
+ 返回的指针在下次修改前有效，仅在主线程使用
+
+ @return section几何信息
+ */
+- (const CPCollectionViewSectionGeometry *)cp_sectionGeometry;
+
+
 #pragma mark - Get Index By Cell or Section Info
 
 
@@ -198,6 +364,36 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSInteger)cp_sectionForSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo;//return -1 if not found
 
+
+#pragma mark - Get Info By Identifier
+
+
+/**
+ 根据identifier获取cellInfo对象 (通过cp_*接口添加的cellInfo才会被索引)
+
+ @param identifier cellInfo的identifier
+ @return cellInfo对象
+ */
+- (nullable CPCollectionViewCellInfo *)cp_cellInfoWithIdentifier:(NSString *)identifier;//return nil if not found
+
+
+/**
+ 根据cellInfo的identifier返回对应的indexPath
+
+ @param identifier cellInfo的identifier
+ @return indexPath
+ */
+- (nullable NSIndexPath *)cp_indexPathForCellInfoIdentifier:(NSString *)identifier;//return nil if not found
+
+
+/**
+ 根据identifier获取sectionInfo对象
+
+ @param identifier sectionInfo的identifier
+ @return sectionInfo对象
+ */
+- (nullable CPCollectionViewSectionInfo *)cp_sectionInfoWithIdentifier:(NSString *)identifier;//return nil if not found
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -22,10 +22,25 @@
 
 #import "UICollectionView+CPDataDrivenFlowLayout.h"
 #import <objc/runtime.h>
+#import <pthread.h>
 #import "UICollectionView+CPTemplateLayoutCell.h"
-
-
-@interface _CPCollectionViewFlowLayoutProxy : NSProxy
+#import "UICollectionView+CPMetrics.h"
+#import "CPDiff.h"
+#import "CPCollectionViewLazySectionInfo.h"
+#import "CPCollectionViewSectionInfo+Private.h"
+#import "CPCollectionViewDelegateFlowLayoutInterceptor.h"
+
+
+typedef NS_ENUM(NSUInteger, _CPProxyHandler) {
+    _CPProxyHandlerNone = 1,//start at 1, 0 means not resolved in the selector cache
+    _CPProxyHandlerInterceptor,
+    _CPProxyHandlerTarget
+};
+
+@interface _CPCollectionViewFlowLayoutProxy : NSProxy {
+    pthread_mutex_t _lock;
+    CFMutableDictionaryRef _handlersBySelector;//SEL -> _CPProxyHandler
+}
 
 @property (nonatomic, weak) id target;
 @property (nonatomic, strong) id interceptor;
@@ -43,12 +58,33 @@
     }
     _target = target;
     _interceptor = interceptor;
+    pthread_mutex_init(&_lock, NULL);
+    _handlersBySelector = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
     
     return self;
 }
 
+- (void)dealloc {
+    CFRelease(_handlersBySelector);
+    pthread_mutex_destroy(&_lock);
+}
+
+- (void)setTarget:(id)target {
+    pthread_mutex_lock(&_lock);
+    _target = target;
+    CFDictionaryRemoveAllValues(_handlersBySelector);
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)setInterceptor:(id)interceptor {
+    pthread_mutex_lock(&_lock);
+    _interceptor = interceptor;
+    CFDictionaryRemoveAllValues(_handlersBySelector);
+    pthread_mutex_unlock(&_lock);
+}
+
 - (BOOL)respondsToSelector:(SEL)aSelector {
-    return [_interceptor respondsToSelector:aSelector] || [_target respondsToSelector:aSelector];
+    return [self handlerForSelector:aSelector] != _CPProxyHandlerNone;
 }
 
 - (BOOL)conformsToProtocol:(Protocol *)aProtocol {
@@ -57,6 +93,47 @@
 
 #pragma mark - Forward
 
+- (_CPProxyHandler)handlerForSelector:(SEL)sel {
+    //resolved once per selector, the cache is cleared whenever target or interceptor changes
+    pthread_mutex_lock(&_lock);
+    _CPProxyHandler handler = (_CPProxyHandler)(uintptr_t)CFDictionaryGetValue(_handlersBySelector, sel);
+    id interceptor = _interceptor;
+    id target = _target;
+    pthread_mutex_unlock(&_lock);
+    if (handler != 0) {
+        return handler;
+    }
+    
+    //ask outside the lock, respondsToSelector: may message the proxy again
+    if ([interceptor respondsToSelector:sel]) {
+        handler = _CPProxyHandlerInterceptor;
+    } else if ([target respondsToSelector:sel]) {
+        handler = _CPProxyHandlerTarget;
+    } else {
+        handler = _CPProxyHandlerNone;
+    }
+    
+    pthread_mutex_lock(&_lock);
+    if (interceptor == _interceptor && target == _target) {
+        CFDictionarySetValue(_handlersBySelector, sel, (const void *)(uintptr_t)handler);
+    }
+    pthread_mutex_unlock(&_lock);
+    
+    return handler;
+}
+
+- (id)forwardingTargetForSelector:(SEL)sel {
+    //fast path: the runtime resends the message without building an NSInvocation
+    switch ([self handlerForSelector:sel]) {
+        case _CPProxyHandlerInterceptor:
+            return _interceptor;
+        case _CPProxyHandlerTarget:
+            return _target;
+        default:
+            return nil;
+    }
+}
+
 - (NSMethodSignature *)methodSignatureForSelector:(SEL)sel {
     NSMethodSignature *signature = [(id)_interceptor methodSignatureForSelector:sel];
     if (signature) {
@@ -72,6 +149,7 @@
 }
 
 - (void)forwardInvocation:(NSInvocation *)invocation {
+    //slow path, only reached when no handler responds or the target has been released
     if ([invocation methodSignature] == [[self class] voidSignature]) {
         return;
     }
@@ -96,6 +174,208 @@
 
 
 
+@interface CPCollectionViewLazySectionInfo ()
+
+- (BOOL)cp_hasHandlersForObserver:(id)observer;
+- (void)cp_setCellInfoDidLoadHandler:(void (^)(CPCollectionViewCellInfo *cellInfo))cellInfoDidLoadHandler
+           cellInfoWillUnloadHandler:(void (^)(CPCollectionViewCellInfo *cellInfo))cellInfoWillUnloadHandler
+                         forObserver:(id)observer;
+- (void)cp_removeHandlersForObserver:(id)observer;
+- (void)cp_invalidateItemSizes;
+
+@end
+
+
+
+@interface _CPCollectionViewBatchUpdates : NSObject
+
+@property (nonatomic, readonly) NSMutableIndexSet *deletedSections;
+@property (nonatomic, readonly) NSMutableIndexSet *insertedSections;
+@property (nonatomic, readonly) NSMutableArray<CPDiffMove *> *sectionMoves;
+@property (nonatomic, readonly) NSMutableArray<NSIndexPath *> *deletedIndexPaths;
+@property (nonatomic, readonly) NSMutableArray<NSIndexPath *> *insertedIndexPaths;
+@property (nonatomic, readonly) NSMutableArray<NSArray<NSIndexPath *> *> *itemMoves;//[from, to]
+
+- (void)addSectionDiff:(CPDiffResult *)sectionDiff;
+- (void)addItemDiff:(CPDiffResult *)itemDiff fromSection:(NSUInteger)oldSection toSection:(NSUInteger)newSection;
+
+@end
+
+@implementation _CPCollectionViewBatchUpdates
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _deletedSections = [NSMutableIndexSet new];
+        _insertedSections = [NSMutableIndexSet new];
+        _sectionMoves = [NSMutableArray new];
+        _deletedIndexPaths = [NSMutableArray new];
+        _insertedIndexPaths = [NSMutableArray new];
+        _itemMoves = [NSMutableArray new];
+    }
+    
+    return self;
+}
+
+- (void)addSectionDiff:(CPDiffResult *)sectionDiff {
+    //reloads in batch updates use the old index for the new content, so updated sections are deleted and inserted instead
+    [_deletedSections addIndexes:sectionDiff.deletes];
+    [_insertedSections addIndexes:sectionDiff.inserts];
+    [sectionDiff.updates enumerateIndexesUsingBlock:^(NSUInteger oldSection, BOOL * _Nonnull stop) {
+        [self->_deletedSections addIndex:oldSection];
+        [self->_insertedSections addIndex:[sectionDiff newIndexForOldIndex:oldSection]];
+    }];
+    for (CPDiffMove *move in sectionDiff.moves) {
+        if (![sectionDiff.updates containsIndex:move.from]) {
+            [_sectionMoves addObject:move];
+        }
+    }
+}
+
+- (void)addItemDiff:(CPDiffResult *)itemDiff fromSection:(NSUInteger)oldSection toSection:(NSUInteger)newSection {
+    [itemDiff.deletes enumerateIndexesUsingBlock:^(NSUInteger item, BOOL * _Nonnull stop) {
+        [self->_deletedIndexPaths addObject:[NSIndexPath indexPathForItem:item inSection:oldSection]];
+    }];
+    [itemDiff.inserts enumerateIndexesUsingBlock:^(NSUInteger item, BOOL * _Nonnull stop) {
+        [self->_insertedIndexPaths addObject:[NSIndexPath indexPathForItem:item inSection:newSection]];
+    }];
+    [itemDiff.updates enumerateIndexesUsingBlock:^(NSUInteger item, BOOL * _Nonnull stop) {
+        [self->_deletedIndexPaths addObject:[NSIndexPath indexPathForItem:item inSection:oldSection]];
+        [self->_insertedIndexPaths addObject:[NSIndexPath indexPathForItem:[itemDiff newIndexForOldIndex:item] inSection:newSection]];
+    }];
+    for (CPDiffMove *move in itemDiff.moves) {
+        if (![itemDiff.updates containsIndex:move.from]) {
+            [_itemMoves addObject:@[[NSIndexPath indexPathForItem:move.from inSection:oldSection],
+                                    [NSIndexPath indexPathForItem:move.to inSection:newSection]]];
+        }
+    }
+}
+
+@end
+
+
+
+@interface _CPCollectionViewBatchUpdateTransaction : NSObject
+
+@property (nonatomic, readonly) NSArray<CPCollectionViewSectionInfo *> *oldSectionInfos;
+@property (nonatomic, readonly) NSMapTable<CPCollectionViewSectionInfo *, NSArray<CPCollectionViewCellInfo *> *> *oldCellInfosBySectionInfo;
+@property (nonatomic, readonly) NSHashTable<CPCollectionViewSectionInfo *> *reloadedSectionInfos;
+@property (nonatomic, readonly) NSHashTable<CPCollectionViewCellInfo *> *reloadedCellInfos;
+@property (nonatomic, readonly) NSMutableArray<void (^)(BOOL finished)> *completions;
+
+- (instancetype)initWithSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos;
+
+- (void)willMutateSectionInfo:(nullable CPCollectionViewSectionInfo *)sectionInfo;//records cellInfos before the first mutation
+
+@end
+
+@implementation _CPCollectionViewBatchUpdateTransaction
+
+- (instancetype)initWithSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    self = [super init];
+    if (self) {
+        NSPointerFunctionsOptions options = NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality;
+        _oldSectionInfos = [sectionInfos copy];
+        _oldCellInfosBySectionInfo = [NSMapTable mapTableWithKeyOptions:options valueOptions:NSPointerFunctionsStrongMemory];
+        _reloadedSectionInfos = [NSHashTable hashTableWithOptions:options];
+        _reloadedCellInfos = [NSHashTable hashTableWithOptions:options];
+        _completions = [NSMutableArray new];
+    }
+    
+    return self;
+}
+
+- (void)willMutateSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo {
+    if ([sectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]]) {
+        //diffing the items would load every cellInfo, reload the whole section instead
+        [_reloadedSectionInfos addObject:sectionInfo];
+        return;
+    }
+    
+    if (sectionInfo && ![_oldCellInfosBySectionInfo objectForKey:sectionInfo]) {
+        [_oldCellInfosBySectionInfo setObject:sectionInfo.cellInfos forKey:sectionInfo];
+    }
+}
+
+@end
+
+
+
+@interface _CPCollectionViewSectionGeometryStore : NSObject <_CPCollectionViewSectionInfoGeometryObserver> {
+@public
+    CPCollectionViewSectionGeometry _geometry;
+    BOOL _valid;//NO after sections have been inserted, deleted or replaced
+    NSHashTable<CPCollectionViewSectionInfo *> *_dirtySectionInfos;//sections whose items or spacing changed since the last update
+}
+
+- (void)rebuildWithSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos;
+- (void)updateSection:(NSUInteger)section withSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo;
+
+@end
+
+@implementation _CPCollectionViewSectionGeometryStore {
+    NSInteger *_numberOfItems;
+    UIEdgeInsets *_sectionInsets;
+    CGFloat *_minimumLineSpacings;
+    CGFloat *_minimumInteritemSpacings;
+    NSUInteger _capacity;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _dirtySectionInfos = [NSHashTable hashTableWithOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality];
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    free(_numberOfItems);
+    free(_sectionInsets);
+    free(_minimumLineSpacings);
+    free(_minimumInteritemSpacings);
+}
+
+- (void)rebuildWithSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    NSUInteger count = sectionInfos.count;
+    if (_capacity < count) {
+        _capacity = MAX(count, _capacity * 2);
+        _numberOfItems = realloc(_numberOfItems, sizeof(NSInteger) * _capacity);
+        _sectionInsets = realloc(_sectionInsets, sizeof(UIEdgeInsets) * _capacity);
+        _minimumLineSpacings = realloc(_minimumLineSpacings, sizeof(CGFloat) * _capacity);
+        _minimumInteritemSpacings = realloc(_minimumInteritemSpacings, sizeof(CGFloat) * _capacity);
+    }
+    
+    NSUInteger section = 0;
+    for (CPCollectionViewSectionInfo *sectionInfo in sectionInfos) {
+        [self updateSection:section withSectionInfo:sectionInfo];
+        [sectionInfo addGeometryObserver:self];
+        section++;
+    }
+    
+    _geometry = (CPCollectionViewSectionGeometry){count, _numberOfItems, _sectionInsets, _minimumLineSpacings, _minimumInteritemSpacings};
+    [_dirtySectionInfos removeAllObjects];
+    _valid = YES;
+}
+
+- (void)updateSection:(NSUInteger)section withSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo {
+    _numberOfItems[section] = sectionInfo.numberOfItems;
+    _sectionInsets[section] = sectionInfo.sectionInset;
+    _minimumLineSpacings[section] = sectionInfo.minimumLineSpacing;
+    _minimumInteritemSpacings[section] = sectionInfo.minimumInteritemSpacing;
+}
+
+- (void)sectionInfoGeometryDidChange:(CPCollectionViewSectionInfo *)sectionInfo {
+    if (_valid) {
+        [_dirtySectionInfos addObject:sectionInfo];
+    }
+}
+
+@end
+
+
+
 @implementation UICollectionView (CPDataDrivenFlowLayout)
 
 #define __DescriptionForAssert [NSString stringWithFormat:@"invoke %@ before must be set cp_delegateProxy/cp_dataSourceProxy interceptor",NSStringFromSelector(_cmd)]
@@ -104,11 +384,94 @@
 #pragma mark - Associated Object
 
 - (NSArray<CPCollectionViewSectionInfo *> *)cp_sectionInfos {
-    return objc_getAssociatedObject(self, _cmd);
+    //mutations only touch the mutable storage, the immutable snapshot is rebuilt once when read
+    NSArray *sectionInfos = objc_getAssociatedObject(self, _cmd);
+    if (!sectionInfos) {
+        sectionInfos = [[self cp_mutableSectionInfos] copy];
+        objc_setAssociatedObject(self, _cmd, sectionInfos, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    
+    return sectionInfos;
 }
 
 - (void)setCp_sectionInfos:(NSArray<CPCollectionViewSectionInfo *> * _Nonnull)cp_sectionInfos {
-    objc_setAssociatedObject(self, @selector(cp_sectionInfos), cp_sectionInfos, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    [[self cp_mutableSectionInfos] setArray:cp_sectionInfos];
+    [self cp_sectionInfosDidChange];
+}
+
+- (NSMutableArray<CPCollectionViewSectionInfo *> *)cp_mutableSectionInfos {
+    NSMutableArray *mutableSectionInfos = objc_getAssociatedObject(self, _cmd);
+    if (!mutableSectionInfos) {
+        mutableSectionInfos = [NSMutableArray new];
+        objc_setAssociatedObject(self, _cmd, mutableSectionInfos, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    
+    return mutableSectionInfos;
+}
+
+- (void)cp_sectionInfosDidChange {
+    objc_setAssociatedObject(self, @selector(cp_sectionInfos), nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    [self setCp_sectionIndexesBySectionInfo:nil];
+    
+    _CPCollectionViewSectionGeometryStore *geometryStore = objc_getAssociatedObject(self, @selector(cp_sectionGeometry));
+    if (geometryStore) {
+        geometryStore->_valid = NO;
+    }
+}
+
+- (NSMapTable<CPCollectionViewSectionInfo *, NSNumber *> *)cp_sectionIndexesBySectionInfo {
+    NSMapTable *sectionIndexesBySectionInfo = objc_getAssociatedObject(self, _cmd);
+    if (!sectionIndexesBySectionInfo) {
+        //built lazily, reset whenever cp_sectionInfos changed
+        sectionIndexesBySectionInfo = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality
+                                                            valueOptions:NSPointerFunctionsStrongMemory];
+        [[self cp_mutableSectionInfos] enumerateObjectsWithOptions:NSEnumerationReverse usingBlock:^(CPCollectionViewSectionInfo * _Nonnull sectionInfo, NSUInteger idx, BOOL * _Nonnull stop) {
+            [sectionIndexesBySectionInfo setObject:@(idx) forKey:sectionInfo];
+        }];
+        [self setCp_sectionIndexesBySectionInfo:sectionIndexesBySectionInfo];
+    }
+    
+    return sectionIndexesBySectionInfo;
+}
+
+- (void)setCp_sectionIndexesBySectionInfo:(NSMapTable<CPCollectionViewSectionInfo *, NSNumber *> *)cp_sectionIndexesBySectionInfo {
+    objc_setAssociatedObject(self, @selector(cp_sectionIndexesBySectionInfo), cp_sectionIndexesBySectionInfo, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (NSMutableDictionary<NSString *, CPCollectionViewCellInfo *> *)cp_cellInfosByIdentifier {
+    NSMutableDictionary *cellInfosByIdentifier = objc_getAssociatedObject(self, _cmd);
+    if (!cellInfosByIdentifier) {
+        cellInfosByIdentifier = [NSMutableDictionary new];
+        objc_setAssociatedObject(self, _cmd, cellInfosByIdentifier, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    
+    return cellInfosByIdentifier;
+}
+
+- (NSMutableDictionary<NSString *, CPCollectionViewSectionInfo *> *)cp_sectionInfosByIdentifier {
+    NSMutableDictionary *sectionInfosByIdentifier = objc_getAssociatedObject(self, _cmd);
+    if (!sectionInfosByIdentifier) {
+        sectionInfosByIdentifier = [NSMutableDictionary new];
+        objc_setAssociatedObject(self, _cmd, sectionInfosByIdentifier, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    
+    return sectionInfosByIdentifier;
+}
+
+- (nullable _CPCollectionViewBatchUpdateTransaction *)cp_batchUpdateTransaction {
+    return objc_getAssociatedObject(self, _cmd);
+}
+
+- (void)setCp_batchUpdateTransaction:(nullable _CPCollectionViewBatchUpdateTransaction *)cp_batchUpdateTransaction {
+    objc_setAssociatedObject(self, @selector(cp_batchUpdateTransaction), cp_batchUpdateTransaction, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (nullable NSHashTable<CPCollectionViewCellInfo *> *)cp_reconfiguredCellInfos {
+    return objc_getAssociatedObject(self, _cmd);
+}
+
+- (void)setCp_reconfiguredCellInfos:(nullable NSHashTable<CPCollectionViewCellInfo *> *)cp_reconfiguredCellInfos {
+    objc_setAssociatedObject(self, @selector(cp_reconfiguredCellInfos), cp_reconfiguredCellInfos, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
 }
 
 #pragma mark - Delegate and DataSource Proxy
@@ -171,6 +534,13 @@
         [self cp_dataSourceProxy].target = dataSource;
         [self cp_dataSourceProxy].interceptor = interceptor;
         [self setDataSource:(id <UICollectionViewDataSource>)[self cp_dataSourceProxy]];
+        
+#if CP_PREFETCHING_AVAILABLE
+        //prefetching is available since iOS 10, the deployment target is iOS 8. an explicitly set prefetchDataSource is kept
+        if ([self respondsToSelector:@selector(setPrefetchDataSource:)] && !self.prefetchDataSource) {
+            self.prefetchDataSource = (id <UICollectionViewDataSourcePrefetching>)[self cp_dataSourceProxy];
+        }
+#endif
     }
 }
 
@@ -180,6 +550,19 @@
     CPDataDrivenFlowLayoutEnabledAssert();
     
     [self cp_sectionInfosReload:sectionInfos];
+    [self cp_invalidatePrecomputedSizesOfSectionInfos:sectionInfos];
+    
+    _CPCollectionViewBatchUpdateTransaction *transaction = [self cp_batchUpdateTransaction];
+    if (transaction) {
+        //reloadData can not be called inside batch updates, reload every section instead
+        for (CPCollectionViewSectionInfo *sectionInfo in sectionInfos) {
+            [transaction.reloadedSectionInfos addObject:sectionInfo];
+        }
+        return;
+    }
+    
+    [self.cp_metrics recordReload];
+    [[self cp_indexPathSizeCache] invalidateAllSizeCache];
     [self reloadData];
 }
 
@@ -188,6 +571,16 @@
     
     BOOL success = [self cp_sectionInfosUpdate:sectionInfo inSection:inSection];
     if (success) {
+        [self cp_invalidatePrecomputedSizesOfSectionInfos:@[sectionInfo]];
+        
+        _CPCollectionViewBatchUpdateTransaction *transaction = [self cp_batchUpdateTransaction];
+        if (transaction) {
+            [transaction.reloadedSectionInfos addObject:sectionInfo];
+            return;
+        }
+        
+        [self.cp_metrics recordReload];
+        [[self cp_indexPathSizeCache] reloadSections:[NSIndexSet indexSetWithIndex:inSection]];
         [self reloadSections:[NSIndexSet indexSetWithIndex:inSection]];
     }
 }
@@ -199,9 +592,27 @@
         return;
     }
     
-    CPCollectionViewSectionInfo *sectionInfo = [self cp_sectionInfoForSection:indexPath.section];
+    CPCollectionViewSectionInfo *sectionInfo = [self cp_writableSectionInfoForSection:indexPath.section];
     if (sectionInfo) {
+        _CPCollectionViewBatchUpdateTransaction *transaction = [self cp_batchUpdateTransaction];
+        [transaction willMutateSectionInfo:sectionInfo];
+        
+        CPCollectionViewCellInfo *oldCellInfo = [self cp_cellInfoForItemAtIndexPath:indexPath];
         [sectionInfo cp_updateCellInfo:cellInfo atIndex:indexPath.item];
+        if (oldCellInfo != cellInfo) {
+            [self cp_unindexIdentifiersOfCellInfos:oldCellInfo ? @[oldCellInfo] : @[]];
+            [self cp_indexIdentifiersOfCellInfos:@[cellInfo]];
+        }
+        //data may have been mutated in place, the size pinned on the cell info is measured again
+        [cellInfo cp_invalidatePrecomputedSize];
+        
+        if (transaction) {
+            [transaction.reloadedCellInfos addObject:cellInfo];
+            return;
+        }
+        
+        [self.cp_metrics recordReload];
+        [[self cp_indexPathSizeCache] reloadItemsAtIndexPaths:@[indexPath]];
         
         //if cell is visible, reload immediately
         NSArray *visibleIndexPaths = [self indexPathsForVisibleItems];
@@ -223,13 +634,436 @@
     }
 }
 
+- (void)cp_invalidatePrecomputedSizesOfSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    for (CPCollectionViewSectionInfo *sectionInfo in sectionInfos) {
+        //unloaded cellInfos of a lazy section are rebuilt by its factory, only the loaded ones and the sizes kept by index are touched
+        BOOL isLazySectionInfo = [sectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]];
+        if (isLazySectionInfo) {
+            [(CPCollectionViewLazySectionInfo *)sectionInfo cp_invalidateItemSizes];
+        }
+        NSArray<CPCollectionViewCellInfo *> *cellInfos = isLazySectionInfo ? [(CPCollectionViewLazySectionInfo *)sectionInfo loadedCellInfos] : sectionInfo.cellInfos;
+        for (CPCollectionViewCellInfo *cellInfo in cellInfos) {
+            [cellInfo cp_invalidatePrecomputedSize];
+        }
+    }
+}
+
+#pragma mark - Reconfiguring
+
+- (void)cp_reconfigureItemWithCellInfo:(CPCollectionViewCellInfo *)cellInfo atIndexPath:(NSIndexPath *)indexPath {
+    CPDataDrivenFlowLayoutEnabledAssert();
+    NSAssert([NSThread isMainThread], @"reconfigure must be called on the main thread");
+    
+    if (!indexPath || !cellInfo) {
+        return;
+    }
+    
+    CPCollectionViewSectionInfo *sectionInfo = [self cp_sectionInfoForSection:indexPath.section];
+    CPCollectionViewCellInfo *oldCellInfo = [self cp_cellInfoForItemAtIndexPath:indexPath];
+    if (!sectionInfo || !oldCellInfo) {
+        return;
+    }
+    
+    if ([self cp_batchUpdateTransaction] || ![oldCellInfo.cellReuseIdentifier isEqualToString:cellInfo.cellReuseIdentifier]) {
+        //the existing cell can not be reused for another cell class, reload it instead
+        [self cp_reloadItemWithCellInfo:cellInfo atIndexPath:indexPath];
+        return;
+    }
+    
+    sectionInfo = [self cp_writableSectionInfoForSection:indexPath.section];
+    [sectionInfo cp_updateCellInfo:cellInfo atIndex:indexPath.item];
+    if (oldCellInfo != cellInfo) {
+        [self cp_unindexIdentifiersOfCellInfos:@[oldCellInfo]];
+        [self cp_indexIdentifiersOfCellInfos:@[cellInfo]];
+    }
+    //data may have been mutated in place, the flush compares the layout with a new size instead of the one pinned on the cell info
+    [cellInfo cp_invalidatePrecomputedSize];
+    [[self cp_indexPathSizeCache] reloadItemsAtIndexPaths:@[indexPath]];
+    
+    NSHashTable<CPCollectionViewCellInfo *> *cellInfos = [self cp_reconfiguredCellInfos];
+    if (!cellInfos) {
+        cellInfos = [NSHashTable hashTableWithOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality];
+        [self setCp_reconfiguredCellInfos:cellInfos];
+        
+        //flush once before the run loop sleeps, ahead of the Core Animation commit so the changes land in this frame
+        __weak typeof(self) weakSelf = self;
+        CFRunLoopObserverRef observer = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, kCFRunLoopBeforeWaiting | kCFRunLoopExit, false, 0, ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+            [weakSelf cp_flushReconfiguredItems];
+        });
+        CFRunLoopAddObserver(CFRunLoopGetMain(), observer, kCFRunLoopCommonModes);
+        CFRelease(observer);
+    }
+    [cellInfos addObject:cellInfo];
+}
+
+- (void)cp_reconfigureItemAtIndexPath:(NSIndexPath *)indexPath {
+    CPDataDrivenFlowLayoutEnabledAssert();
+    
+    CPCollectionViewCellInfo *cellInfo = [self cp_cellInfoForItemAtIndexPath:indexPath];
+    if (cellInfo) {
+        [self cp_reconfigureItemWithCellInfo:cellInfo atIndexPath:indexPath];
+    }
+}
+
+- (void)cp_flushReconfiguredItems {
+    NSHashTable<CPCollectionViewCellInfo *> *cellInfos = [self cp_reconfiguredCellInfos];
+    [self setCp_reconfiguredCellInfos:nil];
+    
+    UICollectionViewLayout *layout = self.collectionViewLayout;
+    id<UICollectionViewDelegateFlowLayout> delegate = (id<UICollectionViewDelegateFlowLayout>)self.delegate;
+    BOOL measures = [delegate respondsToSelector:@selector(collectionView:layout:sizeForItemAtIndexPath:)];
+    CPCollectionViewMetrics *metrics = self.cp_metrics;
+    NSMutableArray<NSIndexPath *> *invalidatedIndexPaths = [NSMutableArray new];
+    
+    for (CPCollectionViewCellInfo *cellInfo in cellInfos) {
+        //resolved now, items may have moved or been removed since they were reconfigured
+        NSIndexPath *indexPath = [self cp_indexPathForCellInfo:cellInfo];
+        if (!indexPath) {
+            continue;
+        }
+        
+        //visible cells are configured in place, the others are configured when they are dequeued
+        UICollectionViewCell *cell = [self cellForItemAtIndexPath:indexPath];
+        if (cell && cellInfo.cellDidReuseCallback) {
+            CPMetricsInterval interval = [metrics beginInterval:CPCollectionViewMetricsEventConfiguration reuseIdentifier:cellInfo.cellReuseIdentifier];
+            cellInfo.cellDidReuseCallback(self, cell, indexPath, cellInfo.data);
+            [metrics endInterval:interval event:CPCollectionViewMetricsEventConfiguration reuseIdentifier:cellInfo.cellReuseIdentifier];
+        }
+        
+        UICollectionViewLayoutAttributes *attributes = measures ? [layout layoutAttributesForItemAtIndexPath:indexPath] : nil;
+        if (!attributes) {
+            continue;
+        }
+        
+        CGSize size = [delegate collectionView:self layout:layout sizeForItemAtIndexPath:indexPath];
+        if (cell && cellInfo.isSizeEstimated && [delegate respondsToSelector:@selector(collectionView:measureEstimatedItemAtIndexPath:)]) {
+            //an estimate says nothing about the new content of a visible cell, it is measured with the other estimated items
+            [(CPCollectionViewDelegateFlowLayoutInterceptor *)delegate collectionView:self measureEstimatedItemAtIndexPath:indexPath];
+        } else if (!CGSizeEqualToSize(size, attributes.size)) {
+            [invalidatedIndexPaths addObject:indexPath];
+        }
+    }
+    
+    if (invalidatedIndexPaths.count == 0) {
+        return;
+    }
+    
+    UICollectionViewLayoutInvalidationContext *context = [[[layout class] invalidationContextClass] new];
+    [context invalidateItemsAtIndexPaths:invalidatedIndexPaths];
+    if ([context isKindOfClass:[UICollectionViewFlowLayoutInvalidationContext class]]) {
+        [(UICollectionViewFlowLayoutInvalidationContext *)context setInvalidateFlowLayoutDelegateMetrics:YES];
+    }
+    [layout invalidateLayoutWithContext:context];
+}
+
+#pragma mark - Applying
+
+- (void)cp_applySectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos animated:(BOOL)animated {
+    [self cp_applySectionInfos:sectionInfos animated:animated completion:nil];
+}
+
+- (void)cp_applySectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos animated:(BOOL)animated completion:(void (^)(BOOL))completion {
+    CPDataDrivenFlowLayoutEnabledAssert();
+    NSAssert(sectionInfos, @"sectionInfos must not be nil");
+    
+    _CPCollectionViewBatchUpdateTransaction *transaction = [self cp_batchUpdateTransaction];
+    if (transaction) {
+        //the enclosing transaction diffs the result when it commits
+        [self cp_sectionInfosReload:sectionInfos];
+        if (completion) {
+            [transaction.completions addObject:[completion copy]];
+        }
+        return;
+    }
+    
+    NSArray<CPCollectionViewSectionInfo *> *oldSectionInfos = [self cp_sectionInfos];
+    if (oldSectionInfos.count == 0 || sectionInfos.count == 0) {
+        //data source returns a placeholder section when there is no section info, which can not be expressed by batch updates
+        [self cp_reloadWithSectionInfos:sectionInfos];
+        if (completion) {
+            completion(YES);
+        }
+        return;
+    }
+    
+    _CPCollectionViewBatchUpdates *batchUpdates = [self cp_batchUpdatesFromSectionInfos:oldSectionInfos toSectionInfos:sectionInfos];
+    
+    void (^updates)(void) = ^{
+        [self cp_sectionInfosReload:sectionInfos];
+        [self cp_applyBatchUpdates:batchUpdates];
+    };
+    
+    [self.cp_metrics recordBatchUpdate];
+    if (animated) {
+        [self performBatchUpdates:updates completion:completion];
+    } else {
+        [UIView performWithoutAnimation:^{
+            [self performBatchUpdates:updates completion:completion];
+        }];
+    }
+}
+
+- (_CPCollectionViewBatchUpdates *)cp_batchUpdatesFromSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)oldSectionInfos toSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)newSectionInfos {
+    //sections
+    CPDiffResult *sectionDiff = [CPDiff diffWithOldArray:oldSectionInfos newArray:newSectionInfos keyBlock:^id<NSObject> _Nonnull(CPCollectionViewSectionInfo *sectionInfo) {
+        //a section copied by a snapshot is matched with the section it is copied from
+        return sectionInfo.identifier ?: [NSValue valueWithNonretainedObject:sectionInfo.originalSectionInfo ?: sectionInfo];
+    } equalBlock:^BOOL(CPCollectionViewSectionInfo *oldSectionInfo, CPCollectionViewSectionInfo *newSectionInfo) {
+        if (oldSectionInfo == newSectionInfo) {
+            return YES;
+        }
+        if ([oldSectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]] || [newSectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]]) {
+            //diffing the items would load every cellInfo, a different lazy section is reloaded as a whole
+            return NO;
+        }
+        return oldSectionInfo.data == newSectionInfo.data || [oldSectionInfo.data isEqual:newSectionInfo.data];
+    }];
+    _CPCollectionViewBatchUpdates *batchUpdates = [_CPCollectionViewBatchUpdates new];
+    [batchUpdates addSectionDiff:sectionDiff];
+    
+    //items in sections which exist on both sides
+    [oldSectionInfos enumerateObjectsUsingBlock:^(CPCollectionViewSectionInfo * _Nonnull oldSectionInfo, NSUInteger oldSection, BOOL * _Nonnull stop) {
+        NSUInteger newSection = [sectionDiff newIndexForOldIndex:oldSection];
+        if (newSection == NSNotFound || [sectionDiff.updates containsIndex:oldSection] || [oldSectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]]) {
+            return;
+        }
+        if (oldSectionInfo == newSectionInfos[newSection]) {
+            //the same object has the same cellInfos on both sides, skip it without walking its items
+            return;
+        }
+        
+        CPDiffResult *itemDiff = [CPDiff diffWithOldArray:oldSectionInfo.cellInfos newArray:newSectionInfos[newSection].cellInfos keyBlock:^id<NSObject> _Nonnull(CPCollectionViewCellInfo *cellInfo) {
+            return cellInfo.identifier ?: [NSValue valueWithNonretainedObject:cellInfo];
+        } equalBlock:^BOOL(CPCollectionViewCellInfo *oldCellInfo, CPCollectionViewCellInfo *newCellInfo) {
+            if (oldCellInfo == newCellInfo) {
+                return YES;
+            }
+            if (![oldCellInfo.cellReuseIdentifier isEqualToString:newCellInfo.cellReuseIdentifier]) {
+                return NO;
+            }
+            if (oldCellInfo.contentFingerprint && newCellInfo.contentFingerprint) {
+                return [oldCellInfo.contentFingerprint isEqualToString:newCellInfo.contentFingerprint];
+            }
+            return oldCellInfo.data == newCellInfo.data || [oldCellInfo.data isEqual:newCellInfo.data];
+        }];
+        [batchUpdates addItemDiff:itemDiff fromSection:oldSection toSection:newSection];
+    }];
+    
+    return batchUpdates;
+}
+
+- (void)cp_applyBatchUpdates:(_CPCollectionViewBatchUpdates *)batchUpdates {//must be called inside performBatchUpdates, after the model has been updated
+    [self cp_applySizeCacheWithBatchUpdates:batchUpdates];
+    
+    [self deleteSections:batchUpdates.deletedSections];
+    [self insertSections:batchUpdates.insertedSections];
+    for (CPDiffMove *move in batchUpdates.sectionMoves) {
+        [self moveSection:move.from toSection:move.to];
+    }
+    [self deleteItemsAtIndexPaths:batchUpdates.deletedIndexPaths];
+    [self insertItemsAtIndexPaths:batchUpdates.insertedIndexPaths];
+    for (NSArray<NSIndexPath *> *move in batchUpdates.itemMoves) {
+        [self moveItemAtIndexPath:move.firstObject toIndexPath:move.lastObject];
+    }
+}
+
+- (void)cp_applySizeCacheWithBatchUpdates:(_CPCollectionViewBatchUpdates *)batchUpdates {
+    //moves are treated as delete + insert, same as batch updates: old index paths first, then new ones
+    NSMutableIndexSet *oldSections = [batchUpdates.deletedSections mutableCopy];
+    NSMutableIndexSet *newSections = [batchUpdates.insertedSections mutableCopy];
+    for (CPDiffMove *move in batchUpdates.sectionMoves) {
+        [oldSections addIndex:move.from];
+        [newSections addIndex:move.to];
+    }
+    NSMutableArray<NSIndexPath *> *oldIndexPaths = [batchUpdates.deletedIndexPaths mutableCopy];
+    NSMutableArray<NSIndexPath *> *newIndexPaths = [batchUpdates.insertedIndexPaths mutableCopy];
+    for (NSArray<NSIndexPath *> *move in batchUpdates.itemMoves) {
+        [oldIndexPaths addObject:move.firstObject];
+        [newIndexPaths addObject:move.lastObject];
+    }
+    
+    CPIndexPathSizeCache *cache = [self cp_indexPathSizeCache];
+    [cache deleteItemsAtIndexPaths:oldIndexPaths];
+    [cache deleteSections:oldSections];
+    [cache insertSections:newSections];
+    [cache insertItemsAtIndexPaths:newIndexPaths];
+}
+
+#pragma mark - Snapshot
+
+- (CPCollectionViewSnapshot *)cp_snapshot {
+    NSArray<CPCollectionViewSectionInfo *> *sectionInfos = [self cp_sectionInfos];
+    for (CPCollectionViewSectionInfo *sectionInfo in sectionInfos) {
+        //builds the immutable cellInfos on the main thread, the snapshot may be read on other queues
+        [sectionInfo cellInfos];
+    }
+    
+    return [[CPCollectionViewSnapshot alloc] initWithSectionInfos:sectionInfos];
+}
+
+- (void)cp_applySnapshot:(CPCollectionViewSnapshot *)snapshot animated:(BOOL)animated {
+    [self cp_applySnapshot:snapshot animated:animated completion:nil];
+}
+
+- (void)cp_applySnapshot:(CPCollectionViewSnapshot *)snapshot animated:(BOOL)animated completion:(void (^)(BOOL))completion {
+    CPDataDrivenFlowLayoutEnabledAssert();
+    NSAssert([NSThread isMainThread], @"snapshot must be applied on the main thread");
+    NSAssert(snapshot, @"snapshot must not be nil");
+    
+    NSArray<CPCollectionViewSectionInfo *> *sectionInfos = [snapshot copy].sectionInfos;//a mutable snapshot is frozen first
+    NSArray<CPCollectionViewSectionInfo *> *oldSectionInfos = [self cp_sectionInfos];
+    if ([self cp_batchUpdateTransaction] || oldSectionInfos.count == 0 || sectionInfos.count == 0) {
+        [self cp_attachSectionInfos:sectionInfos];
+        [self cp_applySectionInfos:sectionInfos animated:animated completion:completion];
+        return;
+    }
+    
+    //sections shared with the current ones are neither diffed nor indexed again
+    _CPCollectionViewBatchUpdates *batchUpdates = [self cp_batchUpdatesFromSectionInfos:oldSectionInfos toSectionInfos:sectionInfos];
+    
+    void (^updates)(void) = ^{
+        [self cp_sectionInfosReplace:sectionInfos];
+        [self cp_applyBatchUpdates:batchUpdates];
+    };
+    
+    [self.cp_metrics recordBatchUpdate];
+    if (animated) {
+        [self performBatchUpdates:updates completion:completion];
+    } else {
+        [UIView performWithoutAnimation:^{
+            [self performBatchUpdates:updates completion:completion];
+        }];
+    }
+}
+
+- (void)cp_attachSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    for (CPCollectionViewSectionInfo *sectionInfo in sectionInfos) {
+        if (sectionInfo.isDetached) {
+            sectionInfo.detached = NO;
+        } else if (sectionInfo.isSharedWithSnapshot) {
+            //the cellInfos may have been attached to a copy made by cp_writableSectionInfoForSection: since the snapshot was taken
+            [sectionInfo attachCellInfos:sectionInfo.cellInfos];
+        }
+    }
+}
+
+- (nullable CPCollectionViewSectionInfo *)cp_writableSectionInfoForSection:(NSInteger)section {
+    CPCollectionViewSectionInfo *sectionInfo = [self cp_sectionInfoForSection:section];
+    if (!sectionInfo.isSharedWithSnapshot) {
+        return sectionInfo;
+    }
+    
+    //a snapshot still references the section, copy it before the first change so the snapshot stays immutable
+    CPCollectionViewSectionInfo *copiedSectionInfo = [sectionInfo detachedCopy];
+    copiedSectionInfo.detached = NO;
+    [self cp_mutableSectionInfos][section] = copiedSectionInfo;
+    [self cp_sectionInfosDidChange];
+    if (sectionInfo.identifier && [self cp_sectionInfosByIdentifier][sectionInfo.identifier] == sectionInfo) {
+        [self cp_sectionInfosByIdentifier][sectionInfo.identifier] = copiedSectionInfo;
+    }
+    
+    return copiedSectionInfo;
+}
+
+#pragma mark - Batch Updates
+
+- (void)cp_performBatchUpdates:(void (^)(void))updates completion:(void (^)(BOOL))completion {
+    CPDataDrivenFlowLayoutEnabledAssert();
+    NSAssert(updates, @"updates must not be nil");
+    
+    _CPCollectionViewBatchUpdateTransaction *transaction = [self cp_batchUpdateTransaction];
+    if (transaction) {
+        //nested transaction joins the outer one
+        if (updates) {
+            updates();
+        }
+        if (completion) {
+            [transaction.completions addObject:[completion copy]];
+        }
+        return;
+    }
+    
+    [self.cp_metrics recordBatchUpdate];
+    transaction = [[_CPCollectionViewBatchUpdateTransaction alloc] initWithSectionInfos:[self cp_sectionInfos]];
+    if (completion) {
+        [transaction.completions addObject:[completion copy]];
+    }
+    
+    [self performBatchUpdates:^{
+        //mutations inside updates only change the model, the changes are collected on commit
+        [self setCp_batchUpdateTransaction:transaction];
+        if (updates) {
+            updates();
+        }
+        [self setCp_batchUpdateTransaction:nil];
+        [self cp_commitBatchUpdateTransaction:transaction];
+    } completion:^(BOOL finished) {
+        for (void (^transactionCompletion)(BOOL) in transaction.completions) {
+            transactionCompletion(finished);
+        }
+    }];
+}
+
+- (void)cp_commitBatchUpdateTransaction:(_CPCollectionViewBatchUpdateTransaction *)transaction {
+    NSArray<CPCollectionViewSectionInfo *> *oldSectionInfos = transaction.oldSectionInfos;
+    NSArray<CPCollectionViewSectionInfo *> *newSectionInfos = [self cp_sectionInfos];
+    _CPCollectionViewBatchUpdates *batchUpdates = [_CPCollectionViewBatchUpdates new];
+    
+    if (oldSectionInfos.count == 0 || newSectionInfos.count == 0) {
+        //data source returns a placeholder section when there is no section info, replace it as a whole
+        if (oldSectionInfos.count > 0 || newSectionInfos.count > 0) {
+            [batchUpdates.deletedSections addIndexesInRange:NSMakeRange(0, MAX(oldSectionInfos.count, 1))];
+            [batchUpdates.insertedSections addIndexesInRange:NSMakeRange(0, MAX(newSectionInfos.count, 1))];
+        }
+        [self cp_applyBatchUpdates:batchUpdates];
+        return;
+    }
+    
+    //the model has already been mutated in place, so infos are matched by identity
+    CPDiffKeyBlock keyBlock = ^id<NSObject> _Nonnull(id info) {
+        return [NSValue valueWithNonretainedObject:info];
+    };
+    //a section shared with a snapshot is replaced by its copy before the first change, the copy is matched with it
+    CPDiffKeyBlock sectionKeyBlock = ^id<NSObject> _Nonnull(CPCollectionViewSectionInfo *sectionInfo) {
+        return [NSValue valueWithNonretainedObject:sectionInfo.originalSectionInfo ?: sectionInfo];
+    };
+    
+    NSHashTable *reloadedSectionInfos = transaction.reloadedSectionInfos;
+    CPDiffResult *sectionDiff = [CPDiff diffWithOldArray:oldSectionInfos newArray:newSectionInfos keyBlock:sectionKeyBlock equalBlock:^BOOL(id oldSectionInfo, id newSectionInfo) {
+        return ![reloadedSectionInfos containsObject:newSectionInfo];
+    }];
+    [batchUpdates addSectionDiff:sectionDiff];
+    
+    //only sections mutated inside the transaction have item changes
+    NSHashTable *reloadedCellInfos = transaction.reloadedCellInfos;
+    [oldSectionInfos enumerateObjectsUsingBlock:^(CPCollectionViewSectionInfo * _Nonnull oldSectionInfo, NSUInteger oldSection, BOOL * _Nonnull stop) {
+        NSUInteger newSection = [sectionDiff newIndexForOldIndex:oldSection];
+        if (newSection == NSNotFound || [sectionDiff.updates containsIndex:oldSection]) {
+            return;
+        }
+        CPCollectionViewSectionInfo *sectionInfo = newSectionInfos[newSection];
+        NSArray<CPCollectionViewCellInfo *> *oldCellInfos = [transaction.oldCellInfosBySectionInfo objectForKey:sectionInfo];
+        if (!oldCellInfos) {
+            return;
+        }
+        
+        CPDiffResult *itemDiff = [CPDiff diffWithOldArray:oldCellInfos newArray:sectionInfo.cellInfos keyBlock:keyBlock equalBlock:^BOOL(id oldCellInfo, id newCellInfo) {
+            return ![reloadedCellInfos containsObject:newCellInfo];
+        }];
+        [batchUpdates addItemDiff:itemDiff fromSection:oldSection toSection:newSection];
+    }];
+    
+    [self cp_applyBatchUpdates:batchUpdates];
+}
+
 #pragma mark - Inserting
 
 - (void)cp_insertSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo inSection:(NSInteger)inSection {
     CPDataDrivenFlowLayoutEnabledAssert();
     
     BOOL success = [self cp_sectionInfoInsert:sectionInfo inSection:inSection];
-    if (success) {
+    if (success && ![self cp_batchUpdateTransaction]) {
+        [[self cp_indexPathSizeCache] insertSections:[NSIndexSet indexSetWithIndex:inSection]];
         [self insertSections:[NSIndexSet indexSetWithIndex:inSection]];
     }
 }
@@ -241,17 +1075,42 @@
     NSAssert(indexPaths, @"indexPaths must not be nil");
     NSAssert(cellInfos.count == indexPaths.count, @"cellInfos count must equals to indexPaths count");
     
-    __weak typeof(self) weakSelf = self;
+    //indexPaths refer to the positions after insertion, group them by section so each section is mutated once
+    NSMutableDictionary<NSNumber *, NSMutableIndexSet *> *itemsBySection = [NSMutableDictionary new];
+    NSMutableDictionary<NSNumber *, NSMutableDictionary<NSNumber *, CPCollectionViewCellInfo *> *> *cellInfosBySection = [NSMutableDictionary new];
     [indexPaths enumerateObjectsUsingBlock:^(NSIndexPath * _Nonnull indexPath, NSUInteger idx, BOOL * _Nonnull stop) {
-        CPCollectionViewCellInfo *cellInfo = [cellInfos objectAtIndex:idx];
-        CPCollectionViewSectionInfo *sectionInfo = [weakSelf cp_sectionInfoForSection:indexPath.section];
-        if (cellInfo && sectionInfo) {
-            [sectionInfo cp_insertCellInfos:@[cellInfo] atIndexSet:[NSIndexSet indexSetWithIndex:indexPath.item]];
+        NSNumber *section = @(indexPath.section);
+        if (!itemsBySection[section]) {
+            itemsBySection[section] = [NSMutableIndexSet new];
+            cellInfosBySection[section] = [NSMutableDictionary new];
+        }
+        [itemsBySection[section] addIndex:indexPath.item];
+        cellInfosBySection[section][@(indexPath.item)] = cellInfos[idx];
+    }];
+    
+    for (NSNumber *section in itemsBySection) {
+        [self cp_validateItemMutationOfSectionInfo:[self cp_sectionInfoForSection:section.integerValue]];
+    }
+    
+    _CPCollectionViewBatchUpdateTransaction *transaction = [self cp_batchUpdateTransaction];
+    [itemsBySection enumerateKeysAndObjectsUsingBlock:^(NSNumber * _Nonnull section, NSMutableIndexSet * _Nonnull items, BOOL * _Nonnull stop) {
+        CPCollectionViewSectionInfo *sectionInfo = [self cp_writableSectionInfoForSection:section.integerValue];
+        if (sectionInfo) {
+            NSMutableArray *sortedCellInfos = [NSMutableArray arrayWithCapacity:items.count];
+            [items enumerateIndexesUsingBlock:^(NSUInteger item, BOOL * _Nonnull stop) {
+                [sortedCellInfos addObject:cellInfosBySection[section][@(item)]];
+            }];
+            [transaction willMutateSectionInfo:sectionInfo];
+            [sectionInfo cp_insertCellInfos:sortedCellInfos atIndexSet:items];
         }
     }];
     
     [self cp_registerCellWithCellInfos:cellInfos];
-    [self insertItemsAtIndexPaths:indexPaths];
+    [self cp_indexIdentifiersOfCellInfos:cellInfos];
+    if (!transaction) {
+        [[self cp_indexPathSizeCache] insertItemsAtIndexPaths:indexPaths];
+        [self insertItemsAtIndexPaths:indexPaths];
+    }
 }
 
 #pragma mark - Appending
@@ -259,10 +1118,11 @@
 - (void)cp_appendSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
     CPDataDrivenFlowLayoutEnabledAssert();
     
-    NSInteger start = [self cp_sectionInfos].count;
+    NSInteger start = [self cp_mutableSectionInfos].count;
     NSInteger count = sectionInfos.count;
     BOOL success = [self cp_sectionInfosAppend:sectionInfos];
-    if (success) {
+    if (success && ![self cp_batchUpdateTransaction]) {
+        [[self cp_indexPathSizeCache] insertSections:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(start, count)]];
         [self insertSections:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(start, count)]];
     }
 }
@@ -272,48 +1132,264 @@
     NSAssert(cellInfos, @"cellInfos must not be nil");
     
     CPCollectionViewSectionInfo *sectionInfo = [self cp_sectionInfoForSection:inSection];
+    [self cp_validateItemMutationOfSectionInfo:sectionInfo];
     if (sectionInfo && cellInfos && cellInfos.count > 0) {
+        sectionInfo = [self cp_writableSectionInfoForSection:inSection];
+        _CPCollectionViewBatchUpdateTransaction *transaction = [self cp_batchUpdateTransaction];
+        [transaction willMutateSectionInfo:sectionInfo];
+        
         NSInteger start = sectionInfo.numberOfItems;
         NSInteger count = cellInfos.count;
         [sectionInfo cp_appendCellInfos:cellInfos];
         [self cp_registerCellWithCellInfos:cellInfos];
+        [self cp_indexIdentifiersOfCellInfos:cellInfos];
+        if (transaction) {
+            return;
+        }
         
         NSMutableArray *indexPaths = [NSMutableArray new];
         for (NSInteger i = start; i < start+count; i++) {
             [indexPaths addObject:[NSIndexPath indexPathForItem:i inSection:inSection]];
         }
+        [[self cp_indexPathSizeCache] insertItemsAtIndexPaths:indexPaths];
         [self insertItemsAtIndexPaths:[indexPaths copy]];
     }
 }
 
-#pragma mark - Deleting
+- (void)cp_appendCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos inSection:(NSInteger)inSection preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue completion:(void (^)(BOOL))completion {
+    CPDataDrivenFlowLayoutEnabledAssert();
+    NSAssert(cellInfos, @"cellInfos must not be nil");
+    
+    //sections may be inserted or deleted while sizes are being computed, so resolve the index again afterwards
+    CPCollectionViewSectionInfo *sectionInfo = [self cp_sectionInfoForSection:inSection];
+    [self cp_validateItemMutationOfSectionInfo:sectionInfo];
+    __weak typeof(self) weakSelf = self;
+    [self cp_precomputeSizesForCellInfos:cellInfos preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue completion:^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf) {
+            return;
+        }
+        
+        NSInteger section = [strongSelf cp_sectionForSectionInfoOrCopy:sectionInfo];
+        if (section >= 0) {
+            [strongSelf cp_appendCellInfos:cellInfos inSection:section];
+        }
+        if (completion) {
+            completion(section >= 0);
+        }
+    }];
+}
 
-- (void)cp_deleteItemAtIndexPath:(NSIndexPath *)indexPath {
+- (NSInteger)cp_sectionForSectionInfoOrCopy:(CPCollectionViewSectionInfo *)sectionInfo {
+    NSInteger section = [self cp_sectionForSectionInfo:sectionInfo];
+    if (section >= 0 || !sectionInfo) {
+        return section;
+    }
+    
+    //cp_writableSectionInfoForSection: may have replaced the section by a copy since, match it the way applying a snapshot does
+    CPCollectionViewSectionInfo *originalSectionInfo = sectionInfo.originalSectionInfo ?: sectionInfo;
+    NSUInteger index = [[self cp_mutableSectionInfos] indexOfObjectPassingTest:^BOOL(CPCollectionViewSectionInfo * _Nonnull obj, NSUInteger idx, BOOL * _Nonnull stop) {
+        return obj.originalSectionInfo == originalSectionInfo || obj.originalSectionInfo == sectionInfo;
+    }];
+    
+    return index != NSNotFound ? (NSInteger)index : -1;
+}
+
+#pragma mark - Precomputing Sizes
+
+- (void)cp_precomputeSizesForCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension preferredLayoutValue:(CGFloat)preferredLayoutValue completion:(void (^)(void))completion {
+    NSAssert([NSThread isMainThread], @"%@ must be called on main thread", NSStringFromSelector(_cmd));
+    
+    //background workers never see the cell infos themselves, datas conforming to NSCopying are copied,
+    //other datas are read concurrently and must not be mutated until completion
+    NSMutableArray<CPCollectionViewCellInfo *> *pendingCellInfos = [NSMutableArray new];
+    NSMutableArray<CPCollectionViewCellDataSizeBlock> *sizeBlocks = [NSMutableArray new];
+    NSMutableArray *datas = [NSMutableArray new];
+    NSMutableArray *cacheKeys = [NSMutableArray new];//[reuseIdentifier, contentFingerprint] or NSNull
+    for (CPCollectionViewCellInfo *cellInfo in cellInfos) {
+        CPCollectionViewCellDataSizeBlock sizeBlock = cellInfo.sizeForDataCallback;
+        Class cellClass = cellInfo.cellClass;
+        if (!sizeBlock && [cellClass respondsToSelector:@selector(cp_sizeForData:preferredLayoutDimension:preferredLayoutValue:)]) {
+            sizeBlock = ^CGSize(id data, CPPreferredLayoutDimension dimension, CGFloat preferredLayoutValue) {
+                return [(Class<CPStaticSizing>)cellClass cp_sizeForData:data preferredLayoutDimension:dimension preferredLayoutValue:preferredLayoutValue];
+            };
+        }
+        if (!sizeBlock || [cellInfo cp_getPrecomputedSize:NULL preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue]) {
+            continue;
+        }
+        [pendingCellInfos addObject:cellInfo];
+        [sizeBlocks addObject:sizeBlock];
+        id data = [cellInfo.data conformsToProtocol:@protocol(NSCopying)] ? [(id<NSCopying>)cellInfo.data copyWithZone:NULL] : cellInfo.data;
+        [datas addObject:data ?: [NSNull null]];
+        [cacheKeys addObject:(cellInfo.cellReuseIdentifier && cellInfo.contentFingerprint) ? @[cellInfo.cellReuseIdentifier, cellInfo.contentFingerprint] : [NSNull null]];
+    }
+    
+    NSUInteger count = pendingCellInfos.count;
+    if (count == 0) {
+        if (completion) {
+            completion();
+        }
+        return;
+    }
+    
+    CPContentSizeCache *contentSizeCache = [self cp_contentSizeCache];
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    dispatch_async(queue, ^{
+        CGSize *sizes = malloc(sizeof(CGSize) * count);
+        dispatch_apply(count, queue, ^(size_t i) {
+            id data = datas[i] == [NSNull null] ? nil : datas[i];
+            NSArray<NSString *> *cacheKey = cacheKeys[i] == [NSNull null] ? nil : cacheKeys[i];
+            if (cacheKey && [contentSizeCache getSize:&sizes[i] forReuseIdentifier:cacheKey.firstObject contentFingerprint:cacheKey.lastObject preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue]) {
+                return;
+            }
+            
+            sizes[i] = sizeBlocks[i](data, preferredLayoutDimension, preferredLayoutValue);
+            if (cacheKey) {
+                [contentSizeCache cacheSize:sizes[i] forReuseIdentifier:cacheKey.firstObject contentFingerprint:cacheKey.lastObject preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+            }
+        });
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            //publish before the caller inserts, so layout finds every size ready
+            for (NSUInteger i = 0; i < count; i++) {
+                CPCollectionViewCellInfo *cellInfo = pendingCellInfos[i];
+                if ((cellInfo.data ?: [NSNull null]) != datas[i]) {
+                    continue;//data changed meanwhile, size is stale
+                }
+                [cellInfo cp_setPrecomputedSize:sizes[i] preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+            }
+            free(sizes);
+            if (completion) {
+                completion();
+            }
+        });
+    });
+}
+
+#pragma mark - Moving
+
+- (void)cp_moveSection:(NSInteger)section toSection:(NSInteger)newSection {
+    CPDataDrivenFlowLayoutEnabledAssert();
+    
+    NSMutableArray<CPCollectionViewSectionInfo *> *mSectionInfos = [self cp_mutableSectionInfos];
+    if (section < 0 || section >= mSectionInfos.count || newSection < 0 || newSection >= mSectionInfos.count) {
+        return;
+    }
+    
+    CPCollectionViewSectionInfo *sectionInfo = mSectionInfos[section];
+    [mSectionInfos removeObjectAtIndex:section];
+    [mSectionInfos insertObject:sectionInfo atIndex:newSection];
+    [self cp_sectionInfosDidChange];
+    if ([self cp_batchUpdateTransaction]) {
+        return;
+    }
+    
+    [[self cp_indexPathSizeCache] deleteSections:[NSIndexSet indexSetWithIndex:section]];
+    [[self cp_indexPathSizeCache] insertSections:[NSIndexSet indexSetWithIndex:newSection]];
+    [self moveSection:section toSection:newSection];
+}
+
+- (void)cp_moveItemAtIndexPath:(NSIndexPath *)indexPath toIndexPath:(NSIndexPath *)newIndexPath {
     CPDataDrivenFlowLayoutEnabledAssert();
     
     CPCollectionViewSectionInfo *sectionInfo = [self cp_sectionInfoForSection:indexPath.section];
-    if (sectionInfo) {
-        [sectionInfo cp_deleteCellInfosAtIndexSet:[NSIndexSet indexSetWithIndex:indexPath.item]];
-        if (sectionInfo.numberOfItems == 0) {
-            NSMutableArray *mSectionInfos = [[self cp_sectionInfos] mutableCopy];
-            [mSectionInfos removeObject:sectionInfo];
-            [self setCp_sectionInfos:[mSectionInfos copy]];
-            [self deleteSections:[NSIndexSet indexSetWithIndex:indexPath.section]];
-        } else {
-            [self deleteItemsAtIndexPaths:@[indexPath]];
-        }
+    CPCollectionViewSectionInfo *newSectionInfo = [self cp_sectionInfoForSection:newIndexPath.section];
+    CPCollectionViewCellInfo *cellInfo = [self cp_cellInfoForItemAtIndexPath:indexPath];
+    //newIndexPath refers to the position after the item has been removed
+    NSInteger maxItem = newSectionInfo.numberOfItems - (newSectionInfo == sectionInfo ? 1 : 0);
+    if (!cellInfo || !newSectionInfo || newIndexPath.item < 0 || newIndexPath.item > maxItem) {
+        return;
     }
+    [self cp_validateItemMutationOfSectionInfo:sectionInfo];
+    [self cp_validateItemMutationOfSectionInfo:newSectionInfo];
+    
+    sectionInfo = [self cp_writableSectionInfoForSection:indexPath.section];
+    newSectionInfo = [self cp_writableSectionInfoForSection:newIndexPath.section];
+    _CPCollectionViewBatchUpdateTransaction *transaction = [self cp_batchUpdateTransaction];
+    [transaction willMutateSectionInfo:sectionInfo];
+    [transaction willMutateSectionInfo:newSectionInfo];
+    [sectionInfo cp_deleteCellInfosAtIndexSet:[NSIndexSet indexSetWithIndex:indexPath.item]];
+    [newSectionInfo cp_insertCellInfos:@[cellInfo] atIndexSet:[NSIndexSet indexSetWithIndex:newIndexPath.item]];
+    if (transaction) {
+        return;
+    }
+    
+    [[self cp_indexPathSizeCache] deleteItemsAtIndexPaths:@[indexPath]];
+    [[self cp_indexPathSizeCache] insertItemsAtIndexPaths:@[newIndexPath]];
+    [self moveItemAtIndexPath:indexPath toIndexPath:newIndexPath];
+}
+
+#pragma mark - Deleting
+
+- (void)cp_deleteItemAtIndexPath:(NSIndexPath *)indexPath {
+    CPDataDrivenFlowLayoutEnabledAssert();
+    
+    [self cp_deleteItemsInSection:indexPath.section atIndexSet:[NSIndexSet indexSetWithIndex:indexPath.item]];
 }
 
 - (void)cp_deleteItemsInSection:(NSInteger)section atIndexSet:(NSIndexSet *)indexSet {
     CPDataDrivenFlowLayoutEnabledAssert();
+    NSAssert(indexSet, @"indexSet must not be nil");
+    
+    CPCollectionViewSectionInfo *sectionInfo = [self cp_sectionInfoForSection:section];
+    [self cp_validateItemMutationOfSectionInfo:sectionInfo];
+    if (!sectionInfo || indexSet.count == 0 || indexSet.lastIndex >= sectionInfo.numberOfItems) {
+        return;
+    }
+    
+    sectionInfo = [self cp_writableSectionInfoForSection:section];
+    _CPCollectionViewBatchUpdateTransaction *transaction = [self cp_batchUpdateTransaction];
+    [transaction willMutateSectionInfo:sectionInfo];
+    
+    NSMutableArray<CPCollectionViewCellInfo *> *cellInfos = [NSMutableArray arrayWithCapacity:indexSet.count];
+    [indexSet enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL * _Nonnull stop) {
+        [cellInfos addObject:[sectionInfo cp_cellInfoAtIndex:idx]];
+    }];
+    [sectionInfo cp_deleteCellInfosAtIndexSet:indexSet];
+    [self cp_unindexIdentifiersOfCellInfos:cellInfos];
+    
+    if (sectionInfo.numberOfItems == 0) {
+        [[self cp_mutableSectionInfos] removeObjectAtIndex:section];
+        [self cp_sectionInfosDidChange];
+        [self cp_unindexIdentifiersOfSectionInfos:@[sectionInfo]];
+        if (transaction) {
+            return;
+        }
+        
+        [[self cp_indexPathSizeCache] deleteSections:[NSIndexSet indexSetWithIndex:section]];
+        if ([self cp_mutableSectionInfos].count == 0) {
+            //data source returns a placeholder section when there is no section info
+            [self reloadSections:[NSIndexSet indexSetWithIndex:section]];
+        } else {
+            [self deleteSections:[NSIndexSet indexSetWithIndex:section]];
+        }
+    } else {
+        if (transaction) {
+            return;
+        }
+        
+        NSMutableArray<NSIndexPath *> *indexPaths = [NSMutableArray arrayWithCapacity:indexSet.count];
+        [indexSet enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL * _Nonnull stop) {
+            [indexPaths addObject:[NSIndexPath indexPathForItem:idx inSection:section]];
+        }];
+        [[self cp_indexPathSizeCache] deleteItemsAtIndexPaths:indexPaths];
+        [self deleteItemsAtIndexPaths:indexPaths];
+    }
 }
 
 #pragma mark - Reload / Insert / Update / Append / Delete Data
 
 - (BOOL)cp_sectionInfosReload:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
     if (sectionInfos) {
-        [self setCp_sectionInfos:[sectionInfos copy]];
+        for (CPCollectionViewSectionInfo *sectionInfo in [self cp_mutableSectionInfos]) {
+            if ([sectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]]) {
+                [self cp_unobserveLazySectionInfo:(CPCollectionViewLazySectionInfo *)sectionInfo];
+            }
+        }
+        [self setCp_sectionInfos:sectionInfos];
+        [[self cp_cellInfosByIdentifier] removeAllObjects];
+        [[self cp_sectionInfosByIdentifier] removeAllObjects];
+        [self cp_indexIdentifiersOfSectionInfos:sectionInfos];
         [self cp_registerCellWithSectionInfos:sectionInfos];
         [self cp_registerHeaderAndFooterWithSectionInfos:sectionInfos];
         
@@ -323,15 +1399,45 @@
     return NO;
 }
 
+- (void)cp_sectionInfosReplace:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    //unlike reload, only sections which are not on both sides are unindexed, indexed and registered
+    NSPointerFunctionsOptions options = NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality;
+    NSHashTable<CPCollectionViewSectionInfo *> *oldSectionInfoSet = [NSHashTable hashTableWithOptions:options];
+    for (CPCollectionViewSectionInfo *sectionInfo in [self cp_mutableSectionInfos]) {
+        [oldSectionInfoSet addObject:sectionInfo];
+    }
+    NSHashTable<CPCollectionViewSectionInfo *> *newSectionInfoSet = [NSHashTable hashTableWithOptions:options];
+    NSMutableArray<CPCollectionViewSectionInfo *> *addedSectionInfos = [NSMutableArray new];
+    for (CPCollectionViewSectionInfo *sectionInfo in sectionInfos) {
+        [newSectionInfoSet addObject:sectionInfo];
+        if (![oldSectionInfoSet containsObject:sectionInfo]) {
+            [addedSectionInfos addObject:sectionInfo];
+        }
+    }
+    NSMutableArray<CPCollectionViewSectionInfo *> *removedSectionInfos = [NSMutableArray new];
+    for (CPCollectionViewSectionInfo *sectionInfo in [self cp_mutableSectionInfos]) {
+        if (![newSectionInfoSet containsObject:sectionInfo]) {
+            [removedSectionInfos addObject:sectionInfo];
+        }
+    }
+    
+    [self cp_attachSectionInfos:addedSectionInfos];
+    [self setCp_sectionInfos:sectionInfos];
+    [self cp_unindexIdentifiersOfSectionInfos:removedSectionInfos];
+    [self cp_indexIdentifiersOfSectionInfos:addedSectionInfos];
+    [self cp_registerCellWithSectionInfos:addedSectionInfos];
+    [self cp_registerHeaderAndFooterWithSectionInfos:addedSectionInfos];
+}
+
 - (BOOL)cp_sectionInfoInsert:(CPCollectionViewSectionInfo *)sectionInfo inSection:(NSInteger)inSection {
     if (sectionInfo) {
-        NSMutableArray *mSectionInfos = [[self cp_sectionInfos] mutableCopy];
-        if (inSection < mSectionInfos.count) {
-            mSectionInfos[inSection] = sectionInfo;
-        } else {
-            [mSectionInfos addObject:sectionInfo];
+        NSMutableArray *mSectionInfos = [self cp_mutableSectionInfos];
+        if (inSection > mSectionInfos.count) {
+            return NO;
         }
-        [self setCp_sectionInfos:[mSectionInfos copy]];
+        [mSectionInfos insertObject:sectionInfo atIndex:inSection];
+        [self cp_sectionInfosDidChange];
+        [self cp_indexIdentifiersOfSectionInfos:@[sectionInfo]];
         [self cp_registerCellWithSectionInfos:@[sectionInfo]];
         [self cp_registerHeaderAndFooterWithSectionInfos:@[sectionInfo]];
         
@@ -342,10 +1448,12 @@
 }
 
 - (BOOL)cp_sectionInfosUpdate:(CPCollectionViewSectionInfo *)sectionInfo inSection:(NSInteger)inSection {
-    if (sectionInfo && inSection < [self cp_sectionInfos].count) {
-        NSMutableArray *mSectionInfos = [[self cp_sectionInfos] mutableCopy];
+    if (sectionInfo && inSection < [self cp_mutableSectionInfos].count) {
+        NSMutableArray *mSectionInfos = [self cp_mutableSectionInfos];
+        [self cp_unindexIdentifiersOfSectionInfos:@[mSectionInfos[inSection]]];
         mSectionInfos[inSection] = sectionInfo;
-        [self setCp_sectionInfos:[mSectionInfos copy]];
+        [self cp_sectionInfosDidChange];
+        [self cp_indexIdentifiersOfSectionInfos:@[sectionInfo]];
         [self cp_registerCellWithSectionInfos:@[sectionInfo]];
         [self cp_registerHeaderAndFooterWithSectionInfos:@[sectionInfo]];
         
@@ -357,9 +1465,9 @@
 
 - (BOOL)cp_sectionInfosAppend:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
     if (sectionInfos) {
-        NSMutableArray *mSectionInfos = [[self cp_sectionInfos] mutableCopy];
-        [mSectionInfos addObjectsFromArray:sectionInfos];
-        [self setCp_sectionInfos:[mSectionInfos copy]];
+        [[self cp_mutableSectionInfos] addObjectsFromArray:sectionInfos];
+        [self cp_sectionInfosDidChange];
+        [self cp_indexIdentifiersOfSectionInfos:sectionInfos];
         [self cp_registerCellWithSectionInfos:sectionInfos];
         [self cp_registerHeaderAndFooterWithSectionInfos:sectionInfos];
         
@@ -377,7 +1485,7 @@
     
     CPCollectionViewSectionInfo *sectionInfo = [self cp_sectionInfoForSection:indexPath.section];
     if (sectionInfo && indexPath.item < sectionInfo.numberOfItems) {
-        return [sectionInfo.cellInfos objectAtIndex:indexPath.item];
+        return [sectionInfo cp_cellInfoAtIndex:indexPath.item];
     }
     
     return nil;
@@ -386,38 +1494,150 @@
 - (nullable CPCollectionViewSectionInfo *)cp_sectionInfoForSection:(NSInteger)section {
     CPDataDrivenFlowLayoutEnabledAssert();
     
-    if (section < [self cp_sectionInfos].count) {
-        return [[self cp_sectionInfos] objectAtIndex:section];
+    NSMutableArray<CPCollectionViewSectionInfo *> *sectionInfos = [self cp_mutableSectionInfos];
+    if (section >= 0 && section < sectionInfos.count) {
+        return [sectionInfos objectAtIndex:section];
     }
     
     return nil;
 }
 
+- (const CPCollectionViewSectionGeometry *)cp_sectionGeometry {
+    _CPCollectionViewSectionGeometryStore *geometryStore = objc_getAssociatedObject(self, _cmd);
+    if (!geometryStore) {
+        geometryStore = [_CPCollectionViewSectionGeometryStore new];
+        objc_setAssociatedObject(self, _cmd, geometryStore, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    
+    //rebuilt in one pass after sections change, otherwise only the sections which reported a change are read again
+    if (!geometryStore->_valid) {
+        [geometryStore rebuildWithSectionInfos:[self cp_mutableSectionInfos]];
+    } else if (geometryStore->_dirtySectionInfos.count > 0) {
+        for (CPCollectionViewSectionInfo *sectionInfo in geometryStore->_dirtySectionInfos) {
+            //sections removed since they were last mirrored still report changes, they are not found any more
+            NSInteger section = [self cp_sectionForSectionInfo:sectionInfo];
+            if (section >= 0) {
+                [geometryStore updateSection:section withSectionInfo:sectionInfo];
+            }
+        }
+        [geometryStore->_dirtySectionInfos removeAllObjects];
+    }
+    
+    return &geometryStore->_geometry;
+}
+
 - (nullable NSIndexPath *)cp_indexPathForCellInfo:(CPCollectionViewCellInfo *)cellInfo {
-    __block NSIndexPath *indexPath;
-    [[self cp_sectionInfos] enumerateObjectsUsingBlock:^(CPCollectionViewSectionInfo * _Nonnull section, NSUInteger sectionIndex, BOOL * _Nonnull stop1) {
-       [section.cellInfos enumerateObjectsUsingBlock:^(CPCollectionViewCellInfo * _Nonnull cell, NSUInteger itemIndex, BOOL * _Nonnull stop2) {
-           if (cell == cellInfo) {
-               indexPath = [NSIndexPath indexPathForItem:itemIndex inSection:sectionIndex];
-               *stop1 = YES;
-               *stop2 = YES;
-           }
-       }];
-    }];
+    CPCollectionViewSectionInfo *sectionInfo = cellInfo.sectionInfo;
+    NSInteger section = [self cp_sectionForSectionInfo:sectionInfo];
+    if (section < 0) {
+        return nil;
+    }
+    
+    NSUInteger item = [sectionInfo cp_indexOfCellInfo:cellInfo];
+    if (item == NSNotFound) {
+        return nil;
+    }
     
-    return indexPath;
+    return [NSIndexPath indexPathForItem:item inSection:section];
 }
 
 - (NSInteger)cp_sectionForSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo {
-    __block NSInteger section = -1;
-    [[self cp_sectionInfos] enumerateObjectsUsingBlock:^(CPCollectionViewSectionInfo * _Nonnull obj, NSUInteger idx, BOOL * _Nonnull stop) {
-        if (obj == sectionInfo) {
-            section = idx;
-            *stop = YES;
-        }
-    }];
+    if (!sectionInfo) {
+        return -1;
+    }
+    
+    NSNumber *section = [[self cp_sectionIndexesBySectionInfo] objectForKey:sectionInfo];
+    if (section) {
+        return section.integerValue;
+    }
     
-    return section;
+    return -1;
+}
+
+#pragma mark - Get Info By Identifier
+
+- (nullable CPCollectionViewCellInfo *)cp_cellInfoWithIdentifier:(NSString *)identifier {
+    if (!identifier) {
+        return nil;
+    }
+    
+    CPCollectionViewCellInfo *cellInfo = [self cp_cellInfosByIdentifier][identifier];
+    //cell info may have been removed from its section info directly
+    if (cellInfo && [self cp_indexPathForCellInfo:cellInfo]) {
+        return cellInfo;
+    }
+    
+    return nil;
+}
+
+- (nullable NSIndexPath *)cp_indexPathForCellInfoIdentifier:(NSString *)identifier {
+    CPCollectionViewCellInfo *cellInfo = [self cp_cellInfoWithIdentifier:identifier];
+    if (cellInfo) {
+        return [self cp_indexPathForCellInfo:cellInfo];
+    }
+    
+    return nil;
+}
+
+- (nullable CPCollectionViewSectionInfo *)cp_sectionInfoWithIdentifier:(NSString *)identifier {
+    if (!identifier) {
+        return nil;
+    }
+    
+    CPCollectionViewSectionInfo *sectionInfo = [self cp_sectionInfosByIdentifier][identifier];
+    if (sectionInfo && [self cp_sectionForSectionInfo:sectionInfo] >= 0) {
+        return sectionInfo;
+    }
+    
+    return nil;
+}
+
+#pragma mark - Index Identifiers
+
+- (void)cp_indexIdentifiersOfSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    NSMutableDictionary *sectionInfosByIdentifier = [self cp_sectionInfosByIdentifier];
+    for (CPCollectionViewSectionInfo *sectionInfo in sectionInfos) {
+        if (sectionInfo.identifier) {
+            sectionInfosByIdentifier[sectionInfo.identifier] = sectionInfo;
+        }
+        if ([sectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]]) {
+            [self cp_observeLazySectionInfo:(CPCollectionViewLazySectionInfo *)sectionInfo];
+        } else {
+            [self cp_indexIdentifiersOfCellInfos:sectionInfo.cellInfos];
+        }
+    }
+}
+
+- (void)cp_unindexIdentifiersOfSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    NSMutableDictionary *sectionInfosByIdentifier = [self cp_sectionInfosByIdentifier];
+    for (CPCollectionViewSectionInfo *sectionInfo in sectionInfos) {
+        if (sectionInfo.identifier && sectionInfosByIdentifier[sectionInfo.identifier] == sectionInfo) {
+            [sectionInfosByIdentifier removeObjectForKey:sectionInfo.identifier];
+        }
+        if ([sectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]]) {
+            [self cp_unobserveLazySectionInfo:(CPCollectionViewLazySectionInfo *)sectionInfo];
+        } else {
+            [self cp_unindexIdentifiersOfCellInfos:sectionInfo.cellInfos];
+        }
+    }
+}
+
+- (void)cp_indexIdentifiersOfCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos {
+    NSMutableDictionary *cellInfosByIdentifier = [self cp_cellInfosByIdentifier];
+    for (CPCollectionViewCellInfo *cellInfo in cellInfos) {
+        if (cellInfo.identifier) {
+            cellInfosByIdentifier[cellInfo.identifier] = cellInfo;
+        }
+    }
+}
+
+- (void)cp_unindexIdentifiersOfCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos {
+    NSMutableDictionary *cellInfosByIdentifier = [self cp_cellInfosByIdentifier];
+    for (CPCollectionViewCellInfo *cellInfo in cellInfos) {
+        if (cellInfo.identifier && cellInfosByIdentifier[cellInfo.identifier] == cellInfo) {
+            [cellInfosByIdentifier removeObjectForKey:cellInfo.identifier];
+        }
+    }
 }
 
 #pragma mark - Register Header and Footer
@@ -432,48 +1652,17 @@
 
 - (void)cp_registerHeaderAndFooterWithSectionInfo:(CPCollectionViewSectionInfo *)sectionInfo {
     if (sectionInfo.headerReuseIdentifier) {
-        if (sectionInfo.nibForHeader) {
-            [self cp_registerSupplementaryViewWithNib:sectionInfo.nibForHeader kind:UICollectionElementKindSectionHeader reuseIdentifier:sectionInfo.headerReuseIdentifier];
-        } else if (sectionInfo.headerClass) {
-            [self cp_registerSupplementaryViewWithClass:sectionInfo.headerClass kind:UICollectionElementKindSectionHeader reuseIdentifier:sectionInfo.headerReuseIdentifier];
-        }
+        [self cp_registerSupplementaryViewClass:sectionInfo.headerClass orNib:sectionInfo.nibForHeader ofKind:UICollectionElementKindSectionHeader forReuseIdentifier:sectionInfo.headerReuseIdentifier];
     }
     
     if (sectionInfo.footerReuseIdentifier) {
-        if (sectionInfo.nibForFooter) {
-            [self cp_registerSupplementaryViewWithNib:sectionInfo.nibForFooter kind:UICollectionElementKindSectionFooter reuseIdentifier:sectionInfo.footerReuseIdentifier];
-        } else if (sectionInfo.footerClass) {
-            [self cp_registerSupplementaryViewWithClass:sectionInfo.footerClass kind:UICollectionElementKindSectionFooter reuseIdentifier:sectionInfo.footerReuseIdentifier];
-        }
-    }
-}
-
-- (void)cp_registerSupplementaryViewWithNib:(UINib *)nib kind:(NSString *)kind reuseIdentifier:(NSString *)reuseIdentifier {
-    NSDictionary *supplementaryViewNibDict = [self valueForKey:@"_supplementaryViewNibDict"];
-    if ([supplementaryViewNibDict valueForKey:reuseIdentifier]) {
-        //prevent repeat register cell
-        return;
-    }
-    [self registerNib:nib forSupplementaryViewOfKind:kind withReuseIdentifier:reuseIdentifier];
-}
-
-- (void)cp_registerSupplementaryViewWithClass:(Class)viewClass kind:(NSString *)kind reuseIdentifier:(NSString *)reuseIdentifier {
-    NSDictionary *supplementaryViewClassDict = [self valueForKey:@"_supplementaryViewClassDict"];
-    if ([supplementaryViewClassDict valueForKey:reuseIdentifier]) {
-        //prevent repeat register cell
-        return;
+        [self cp_registerSupplementaryViewClass:sectionInfo.footerClass orNib:sectionInfo.nibForFooter ofKind:UICollectionElementKindSectionFooter forReuseIdentifier:sectionInfo.footerReuseIdentifier];
     }
-    [self registerClass:viewClass forSupplementaryViewOfKind:kind withReuseIdentifier:reuseIdentifier];
 }
 
 - (void)cp_registerPlaceholderSupplementaryView {
-    NSDictionary *supplementaryViewClassDict = [self valueForKey:@"_supplementaryViewClassDict"];
-    if ([supplementaryViewClassDict valueForKey:_CPPlaceholderSupplementaryView]) {
-        //prevent repeat register cell
-        return;
-    }
-    [self registerClass:[UICollectionReusableView class] forSupplementaryViewOfKind:UICollectionElementKindSectionHeader withReuseIdentifier:_CPPlaceholderSupplementaryView];
-    [self registerClass:[UICollectionReusableView class] forSupplementaryViewOfKind:UICollectionElementKindSectionFooter withReuseIdentifier:_CPPlaceholderSupplementaryView];
+    [self cp_registerSupplementaryViewClass:[UICollectionReusableView class] orNib:nil ofKind:UICollectionElementKindSectionHeader forReuseIdentifier:_CPPlaceholderSupplementaryView];
+    [self cp_registerSupplementaryViewClass:[UICollectionReusableView class] orNib:nil ofKind:UICollectionElementKindSectionFooter forReuseIdentifier:_CPPlaceholderSupplementaryView];
 }
 
 #pragma mark - Register Cell
@@ -481,29 +1670,63 @@
 - (void)cp_registerCellWithSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
     __weak typeof(self) weakSelf = self;
     [sectionInfos enumerateObjectsUsingBlock:^(CPCollectionViewSectionInfo * _Nonnull sectionInfo, NSUInteger idx, BOOL * _Nonnull stop) {
-        [weakSelf cp_registerCellWithCellInfos:sectionInfo.cellInfos];
+        if ([sectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]]) {
+            //cells of a lazy section are registered when they are loaded
+            [weakSelf cp_observeLazySectionInfo:(CPCollectionViewLazySectionInfo *)sectionInfo];
+        } else {
+            [weakSelf cp_registerCellWithCellInfos:sectionInfo.cellInfos];
+        }
     }];
 }
 
 - (void)cp_registerCellWithCellInfos:(NSArray<CPCollectionViewCellInfo *> *)cellInfos {
-    __weak typeof(self) weakSelf = self;
-    [cellInfos enumerateObjectsUsingBlock:^(CPCollectionViewCellInfo * _Nonnull cellInfo, NSUInteger idx, BOOL * _Nonnull stop) {
-        [weakSelf cp_registerCellWithCellInfo:cellInfo];
-    }];
+    NSString *lastReuseIdentifier = nil;
+    for (CPCollectionViewCellInfo *cellInfo in cellInfos) {
+        //neighbouring cell infos usually share a reuse identifier, skip them without probing the registry
+        if (cellInfo.cellReuseIdentifier == lastReuseIdentifier) {
+            continue;
+        }
+        lastReuseIdentifier = cellInfo.cellReuseIdentifier;
+        [self cp_registerCellWithCellInfo:cellInfo];
+    }
 }
 
 - (void)cp_registerCellWithCellInfo:(CPCollectionViewCellInfo * _Nonnull)cellInfo {
-    NSDictionary *cellNibDict = [self valueForKey:@"_cellNibDict"];
-    NSDictionary *cellClassDict = [self valueForKey:@"_cellClassDict"];
-    if ([cellNibDict objectForKey:cellInfo.cellReuseIdentifier] ||
-        [cellClassDict objectForKey:cellInfo.cellReuseIdentifier]) {
-        //prevent repeat register cell
+    if (cellInfo.cellReuseIdentifier) {
+        [self cp_registerCellClass:cellInfo.cellClass orNib:cellInfo.nibForCell forReuseIdentifier:cellInfo.cellReuseIdentifier];
+    }
+}
+
+#pragma mark - Lazy Section Info
+
+- (void)cp_observeLazySectionInfo:(CPCollectionViewLazySectionInfo *)sectionInfo {
+    if ([sectionInfo cp_hasHandlersForObserver:self]) {
         return;
     }
-    if (cellInfo.nibForCell) {
-        [self registerNib:cellInfo.nibForCell forCellWithReuseIdentifier:cellInfo.cellReuseIdentifier];
-    } else if (cellInfo.cellClass) {
-        [self registerClass:cellInfo.cellClass forCellWithReuseIdentifier:cellInfo.cellReuseIdentifier];
+    
+    //cells are registered and identifiers are indexed when cellInfos are loaded, instead of loading them all up front
+    //handlers are kept per collection view, a lazy section may be shown in several or outlive the first one
+    __weak typeof(self) weakSelf = self;
+    [sectionInfo cp_setCellInfoDidLoadHandler:^(CPCollectionViewCellInfo *cellInfo) {
+        [weakSelf cp_registerCellWithCellInfo:cellInfo];
+        [weakSelf cp_indexIdentifiersOfCellInfos:@[cellInfo]];
+    } cellInfoWillUnloadHandler:^(CPCollectionViewCellInfo *cellInfo) {
+        [weakSelf cp_unindexIdentifiersOfCellInfos:@[cellInfo]];
+    } forObserver:self];
+    [self cp_registerCellWithCellInfos:sectionInfo.loadedCellInfos];
+    [self cp_indexIdentifiersOfCellInfos:sectionInfo.loadedCellInfos];
+}
+
+- (void)cp_unobserveLazySectionInfo:(CPCollectionViewLazySectionInfo *)sectionInfo {
+    [sectionInfo cp_removeHandlersForObserver:self];
+    [self cp_unindexIdentifiersOfCellInfos:sectionInfo.loadedCellInfos];
+}
+
+- (void)cp_validateItemMutationOfSectionInfo:(nullable CPCollectionViewSectionInfo *)sectionInfo {
+    //items of a lazy section come from its factory, reload the section with a new lazy section info instead
+    //raised in release builds too, silently skipping the mutation would leave the caller's model out of sync
+    if ([sectionInfo isKindOfClass:[CPCollectionViewLazySectionInfo class]]) {
+        [NSException raise:NSInvalidArgumentException format:@"items of CPCollectionViewLazySectionInfo can not be inserted, appended, moved or deleted"];
     }
 }
 
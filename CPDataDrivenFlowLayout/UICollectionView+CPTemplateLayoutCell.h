@@ -23,16 +23,74 @@
 // SOFTWARE.
 
 #import <UIKit/UIKit.h>
-
-typedef NS_ENUM(NSInteger, CPPreferredLayoutDimension) {
-    CPPreferredLayoutDimensionWidth = 0,
-    CPPreferredLayoutDimensionHeight
-};
+#import "CPIndexPathSizeCache.h"
+#import "CPContentSizeCache.h"
+#import "CPEstimatedSizeCache.h"
+#import "CPReusableViewRegistry.h"
+#import "CPReusableViewPrewarmer.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ 可选的静态尺寸协议，cell或SupplementaryView的class实现后，计算尺寸时直接调用该方法，不再使用模板view进行Auto Layout计算
+ 实现需与view无关且线程安全 (cellInfo指定cellClass时也用于后台预计算，此时data在后台读取，实现NSCopying的data会先复制)
+ */
+@protocol CPStaticSizing <NSObject>
+
++ (CGSize)cp_sizeForData:(nullable id)data
+preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+    preferredLayoutValue:(CGFloat)preferredLayoutValue;
+
+@end
+
 @interface UICollectionView (CPTemplateLayoutCell)
 
+/**
+ 按indexPath缓存的cell尺寸，通过cp_*接口修改数据时会自动同步
+ */
+@property (nonatomic, readonly) CPIndexPathSizeCache *cp_indexPathSizeCache;
+
+/**
+ 按内容指纹缓存的尺寸，reload后仍然有效；可设置为同一实例以在多个collectionView之间共享
+ */
+@property (nonatomic, null_resettable) CPContentSizeCache *cp_contentSizeCache;
+
+/**
+ 预估尺寸模式下使用的平均尺寸，精确计算的尺寸会加入其中
+ */
+@property (nonatomic, readonly) CPEstimatedSizeCache *cp_estimatedSizeCache;
+
+/**
+ 通过cp_register*接口注册的cell及SupplementaryView
+ */
+@property (nonatomic, readonly) CPReusableViewRegistry *cp_reusableViewRegistry;
+
+/**
+ 设置后在runloop空闲时预先创建已注册及之后注册的cell的模板cell，默认为nil (不预热)
+ */
+@property (nonatomic, nullable) CPReusableViewPrewarmer *cp_reusableViewPrewarmer;
+
+#pragma mark - Register Cell or SupplementaryView
+
+/**
+ 注册cell，同一reuseIdentifier只注册一次 (nib优先)
+
+ @param cellClass       cell的class
+ @param nib             cell的nib
+ @param reuseIdentifier 重用标识
+ */
+- (void)cp_registerCellClass:(nullable Class)cellClass orNib:(nullable UINib *)nib forReuseIdentifier:(NSString *)reuseIdentifier;
+
+/**
+ 注册SupplementaryView，同一kind及reuseIdentifier只注册一次 (nib优先)
+
+ @param viewClass       view的class
+ @param nib             view的nib
+ @param kind            SupplementaryViewKind
+ @param reuseIdentifier 重用标识
+ */
+- (void)cp_registerSupplementaryViewClass:(nullable Class)viewClass orNib:(nullable UINib *)nib ofKind:(NSString *)kind forReuseIdentifier:(NSString *)reuseIdentifier;
+
 #pragma mark - Get Template Cell or SupplementaryView
 
 - (__kindof UICollectionReusableView *)cp_templateSupplementaryViewOfKind:(NSString *)kind
@@ -40,6 +98,13 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (__kindof UICollectionViewCell *)cp_templateCellForReuseIdentifier:(NSString *)identifier;
 
+#pragma mark - Static Sizing
+
+- (nullable Class<CPStaticSizing>)cp_staticSizingClassForCellWithIdentifier:(NSString *)identifier;//return nil if the cell class does not implement CPStaticSizing
+
+- (nullable Class<CPStaticSizing>)cp_staticSizingClassForSupplementaryViewOfKind:(NSString *)kind
+                                                                      identifier:(NSString *)identifier;//return nil if the view class does not implement CPStaticSizing
+
 #pragma mark - Calculating CollectionView Cell Size
 
 /**
@@ -58,12 +123,30 @@ NS_ASSUME_NONNULL_BEGIN
                          configuration:(nullable void (^)(__kindof UICollectionViewCell *cell))configuration;
 
 /**
- 根据已注册collectionViewCell的identifier及期望的宽度or高度，返回cell的尺寸 (cache暂未实现)
+ 根据已注册collectionViewCell的identifier及期望的宽度or高度，返回cell的尺寸，并按indexPath缓存
+ 
+ @param identifier               已注册collectionViewCell的identifier
+ @param preferredLayoutDimension 用于计算期望cell尺寸的固定值类型枚举，Width or Height
+ @param preferredLayoutValue     用于计算期望cell尺寸的固定值
+ @param indexPath                根据indexPath缓存cell size，为nil时不缓存
+ @param configuration            配置cell的block
+ 
+ @return CGSize
+ */
+- (CGSize)cp_sizeForCellWithIdentifier:(NSString *)identifier
+              preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+                  preferredLayoutValue:(CGFloat)preferredLayoutValue
+                      cacheByIndexPath:(nullable NSIndexPath *)indexPath
+                         configuration:(nullable void (^)(__kindof UICollectionViewCell *cell))configuration;
+
+/**
+ 根据已注册collectionViewCell的identifier及期望的宽度or高度，返回cell的尺寸，并按indexPath及内容指纹缓存
  
  @param identifier               已注册collectionViewCell的identifier
  @param preferredLayoutDimension 用于计算期望cell尺寸的固定值类型枚举，Width or Height
  @param preferredLayoutValue     用于计算期望cell尺寸的固定值
- @param indexPath                根据indexPath缓存cell size
+ @param indexPath                根据indexPath缓存cell size，为nil时不缓存
+ @param contentFingerprint       根据内容指纹缓存cell size，为nil时不缓存
  @param configuration            配置cell的block
  
  @return CGSize
@@ -71,7 +154,8 @@ NS_ASSUME_NONNULL_BEGIN
 - (CGSize)cp_sizeForCellWithIdentifier:(NSString *)identifier
               preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
                   preferredLayoutValue:(CGFloat)preferredLayoutValue
-                      cacheByIndexPath:(NSIndexPath *)indexPath
+                      cacheByIndexPath:(nullable NSIndexPath *)indexPath
+                    contentFingerprint:(nullable NSString *)contentFingerprint
                          configuration:(nullable void (^)(__kindof UICollectionViewCell *cell))configuration;
 
 #pragma mark - Calculating Supplementary View Size
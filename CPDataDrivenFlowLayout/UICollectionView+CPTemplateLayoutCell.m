@@ -21,10 +21,126 @@
 // SOFTWARE.
 
 #import "UICollectionView+CPTemplateLayoutCell.h"
+#import "UICollectionView+CPMetrics.h"
 #import <objc/runtime.h>
 
+@interface CPReusableViewPrewarmer ()
+
+@property (nonatomic, weak, nullable) UICollectionView *collectionView;
+
+- (void)enqueueCellReuseIdentifier:(NSString *)reuseIdentifier;
+
+@end
+
 @implementation UICollectionView (CPTemplateLayoutCell)
 
+#pragma mark - Size Cache
+
+- (CPIndexPathSizeCache *)cp_indexPathSizeCache {
+    CPIndexPathSizeCache *cache = objc_getAssociatedObject(self, _cmd);
+    if (!cache) {
+        cache = [CPIndexPathSizeCache new];
+        objc_setAssociatedObject(self, _cmd, cache, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+
+    return cache;
+}
+
+- (CPContentSizeCache *)cp_contentSizeCache {
+    CPContentSizeCache *cache = objc_getAssociatedObject(self, _cmd);
+    if (!cache) {
+        cache = [CPContentSizeCache new];
+        [self setCp_contentSizeCache:cache];
+    }
+    
+    return cache;
+}
+
+- (void)setCp_contentSizeCache:(CPContentSizeCache *)cp_contentSizeCache {
+    objc_setAssociatedObject(self, @selector(cp_contentSizeCache), cp_contentSizeCache, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (CPEstimatedSizeCache *)cp_estimatedSizeCache {
+    CPEstimatedSizeCache *cache = objc_getAssociatedObject(self, _cmd);
+    if (!cache) {
+        cache = [CPEstimatedSizeCache new];
+        objc_setAssociatedObject(self, _cmd, cache, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    
+    return cache;
+}
+
+#pragma mark - Register Cell or SupplementaryView
+
+- (CPReusableViewRegistry *)cp_reusableViewRegistry {
+    CPReusableViewRegistry *registry = objc_getAssociatedObject(self, _cmd);
+    if (!registry) {
+        registry = [CPReusableViewRegistry new];
+        objc_setAssociatedObject(self, _cmd, registry, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    
+    return registry;
+}
+
+- (CPReusableViewPrewarmer *)cp_reusableViewPrewarmer {
+    return objc_getAssociatedObject(self, _cmd);
+}
+
+- (void)setCp_reusableViewPrewarmer:(CPReusableViewPrewarmer *)cp_reusableViewPrewarmer {
+    CPReusableViewPrewarmer *oldPrewarmer = self.cp_reusableViewPrewarmer;
+    if (oldPrewarmer.collectionView == self) {
+        oldPrewarmer.collectionView = nil;
+    }
+    
+    NSAssert(!cp_reusableViewPrewarmer.collectionView || cp_reusableViewPrewarmer.collectionView == self, @"prewarmer can not be shared between collection views");
+    cp_reusableViewPrewarmer.collectionView = self;
+    objc_setAssociatedObject(self, @selector(cp_reusableViewPrewarmer), cp_reusableViewPrewarmer, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    
+    //cells registered before the prewarmer was set
+    for (NSString *reuseIdentifier in [[self cp_reusableViewRegistry] cellReuseIdentifiers]) {
+        [cp_reusableViewPrewarmer enqueueCellReuseIdentifier:reuseIdentifier];
+    }
+}
+
+- (void)cp_registerCellClass:(Class)cellClass orNib:(UINib *)nib forReuseIdentifier:(NSString *)reuseIdentifier {
+    CPReusableViewRegistry *registry = [self cp_reusableViewRegistry];
+    if (nib) {
+        if ([registry registerCellNib:nib forReuseIdentifier:reuseIdentifier]) {
+            [self registerNib:nib forCellWithReuseIdentifier:reuseIdentifier];
+            [self.cp_reusableViewPrewarmer enqueueCellReuseIdentifier:reuseIdentifier];
+        }
+    } else if (cellClass) {
+        if ([registry registerCellClass:cellClass forReuseIdentifier:reuseIdentifier]) {
+            [self registerClass:cellClass forCellWithReuseIdentifier:reuseIdentifier];
+            [self.cp_reusableViewPrewarmer enqueueCellReuseIdentifier:reuseIdentifier];
+        }
+    }
+}
+
+- (void)cp_registerSupplementaryViewClass:(Class)viewClass orNib:(UINib *)nib ofKind:(NSString *)kind forReuseIdentifier:(NSString *)reuseIdentifier {
+    CPReusableViewRegistry *registry = [self cp_reusableViewRegistry];
+    if (nib) {
+        if ([registry registerSupplementaryViewNib:nib ofKind:kind forReuseIdentifier:reuseIdentifier]) {
+            [self registerNib:nib forSupplementaryViewOfKind:kind withReuseIdentifier:reuseIdentifier];
+        }
+    } else if (viewClass) {
+        if ([registry registerSupplementaryViewClass:viewClass ofKind:kind forReuseIdentifier:reuseIdentifier]) {
+            [self registerClass:viewClass forSupplementaryViewOfKind:kind withReuseIdentifier:reuseIdentifier];
+        }
+    }
+}
+
+- (nullable id)cp_systemRegistrationForKey:(NSString *)key inDictionaryNamed:(NSString *)dictionaryName {
+    //fallback for views registered with UIKit directly, reads private state so it is only used once per template
+    @try {
+        return [[self valueForKey:dictionaryName] objectForKey:key];
+    } @catch (NSException *exception) {
+        return nil;
+    }
+}
+
+#pragma mark - Get Template Cell or SupplementaryView
+
 - (__kindof UICollectionReusableView *)cp_templateSupplementaryViewOfKind:(NSString *)kind reuseIdentifier:(NSString *)identifier {
     NSAssert(identifier.length > 0, @"Expect a valid identifier - %@", identifier);
     
@@ -38,16 +154,19 @@
     UICollectionReusableView *templateSupplementaryView = [templateSupplementaryViewsByIdentifiers valueForKey:key];
     
     if (!templateSupplementaryView) {
-        NSDictionary *supplementaryViewNibDict = [self valueForKey:@"_supplementaryViewNibDict"];
-        NSDictionary *supplementaryViewClassDict = [self valueForKey:@"_supplementaryViewClassDict"];
+        CPReusableViewRegistry *registry = [self cp_reusableViewRegistry];
+        UINib *supplementaryViewNib = [registry supplementaryViewNibOfKind:kind reuseIdentifier:identifier];
+        Class cls = [registry supplementaryViewClassOfKind:kind reuseIdentifier:identifier];
+        if (!supplementaryViewNib && !cls) {
+            supplementaryViewNib = [self cp_systemRegistrationForKey:key inDictionaryNamed:@"_supplementaryViewNibDict"];
+            cls = supplementaryViewNib ? nil : [self cp_systemRegistrationForKey:key inDictionaryNamed:@"_supplementaryViewClassDict"];
+        }
         
-        if ([supplementaryViewNibDict valueForKey:key]) {
+        if (supplementaryViewNib) {
             //instance from nib
-            UINib *supplementaryViewNib = [supplementaryViewNibDict valueForKey:key];
             templateSupplementaryView = [[supplementaryViewNib instantiateWithOwner:nil options:nil] firstObject];
-        } else if ([supplementaryViewClassDict valueForKey:key]) {
+        } else if (cls) {
             //instance from class
-            Class cls = [supplementaryViewClassDict valueForKey:key];
             templateSupplementaryView = [cls new];
         } else {
             NSAssert(NO, @"Supplementary View must be registered to collection view for identifier - %@", identifier);
@@ -70,15 +189,19 @@
     UICollectionViewCell *templateCell = [templateCellsByIdentifiers valueForKey:identifier];
     
     if (!templateCell) {
-        NSDictionary *cellNibDict = [self valueForKey:@"_cellNibDict"];
-        NSDictionary *cellClassDict = [self valueForKey:@"_cellClassDict"];
-        if ([cellNibDict valueForKey:identifier]) {
+        CPReusableViewRegistry *registry = [self cp_reusableViewRegistry];
+        UINib *cellNib = [registry cellNibForReuseIdentifier:identifier];
+        Class cls = [registry cellClassForReuseIdentifier:identifier];
+        if (!cellNib && !cls) {
+            cellNib = [self cp_systemRegistrationForKey:identifier inDictionaryNamed:@"_cellNibDict"];
+            cls = cellNib ? nil : [self cp_systemRegistrationForKey:identifier inDictionaryNamed:@"_cellClassDict"];
+        }
+        
+        if (cellNib) {
             //instance from nib
-            UINib *cellNib = [cellNibDict valueForKey:identifier];
             templateCell = [[cellNib instantiateWithOwner:nil options:nil] firstObject];
-        } else if ([cellClassDict valueForKey:identifier]) {
+        } else if (cls) {
             //instance from class
-            Class cls = [cellClassDict valueForKey:identifier];
             templateCell = [cls new];
         } else {
             NSAssert(NO, @"Cell must be registered to collection view for identifier - %@", identifier);
@@ -90,6 +213,27 @@
     return templateCell;
 }
 
+#pragma mark - Static Sizing
+
+- (nullable Class<CPStaticSizing>)cp_staticSizingClassForCellWithIdentifier:(NSString *)identifier {
+    Class cls = [[self cp_reusableViewRegistry] cellClassForReuseIdentifier:identifier];
+    if (!cls) {
+        //registered by nib or with UIKit directly, the template cell is created once and cached
+        cls = [[self cp_templateCellForReuseIdentifier:identifier] class];
+    }
+    
+    return [cls respondsToSelector:@selector(cp_sizeForData:preferredLayoutDimension:preferredLayoutValue:)] ? cls : nil;
+}
+
+- (nullable Class<CPStaticSizing>)cp_staticSizingClassForSupplementaryViewOfKind:(NSString *)kind identifier:(NSString *)identifier {
+    Class cls = [[self cp_reusableViewRegistry] supplementaryViewClassOfKind:kind reuseIdentifier:identifier];
+    if (!cls) {
+        cls = [[self cp_templateSupplementaryViewOfKind:kind reuseIdentifier:identifier] class];
+    }
+    
+    return [cls respondsToSelector:@selector(cp_sizeForData:preferredLayoutDimension:preferredLayoutValue:)] ? cls : nil;
+}
+
 #pragma mark - Calculating CollectionView Cell Size
 
 - (CGSize)cp_sizeForCellWithIdentifier:(NSString *)identifier
@@ -102,27 +246,62 @@
     
     UICollectionViewCell *templateLayoutCell = [self cp_templateCellForReuseIdentifier:identifier];
     
-    return [self cp_sizeForReusableView:templateLayoutCell
-               preferredLayoutDimension:preferredLayoutDimension
-                   preferredLayoutValue:preferredLayoutValue
-                          configuration:configuration];
+    CPCollectionViewMetrics *metrics = self.cp_metrics;
+    CPMetricsInterval interval = [metrics beginInterval:CPCollectionViewMetricsEventMeasurement reuseIdentifier:identifier];
+    CGSize size = [self cp_sizeForReusableView:templateLayoutCell
+                      preferredLayoutDimension:preferredLayoutDimension
+                          preferredLayoutValue:preferredLayoutValue
+                                 configuration:configuration];
+    [metrics endInterval:interval event:CPCollectionViewMetricsEventMeasurement reuseIdentifier:identifier];
+    
+    return size;
 }
 
 - (CGSize)cp_sizeForCellWithIdentifier:(NSString *)identifier
               preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
                   preferredLayoutValue:(CGFloat)preferredLayoutValue
-                      cacheByIndexPath:(NSIndexPath *)indexPath
+                      cacheByIndexPath:(nullable NSIndexPath *)indexPath
                          configuration:(nullable void (^)(__kindof UICollectionViewCell *cell))configuration {
-    if (!identifier || preferredLayoutValue <= 0) {
-        return CGSizeZero;
-    }
-    
     return [self cp_sizeForCellWithIdentifier:identifier
                      preferredLayoutDimension:preferredLayoutDimension
                          preferredLayoutValue:preferredLayoutValue
+                             cacheByIndexPath:indexPath
+                           contentFingerprint:nil
                                 configuration:configuration];
 }
 
+- (CGSize)cp_sizeForCellWithIdentifier:(NSString *)identifier
+              preferredLayoutDimension:(CPPreferredLayoutDimension)preferredLayoutDimension
+                  preferredLayoutValue:(CGFloat)preferredLayoutValue
+                      cacheByIndexPath:(nullable NSIndexPath *)indexPath
+                    contentFingerprint:(nullable NSString *)contentFingerprint
+                         configuration:(nullable void (^)(__kindof UICollectionViewCell *cell))configuration {
+    if (!identifier || preferredLayoutValue <= 0) {
+        return CGSizeZero;
+    }
+    
+    //hit indexPath cache
+    CPIndexPathSizeCache *indexPathSizeCache = indexPath ? [self cp_indexPathSizeCache] : nil;
+    if ([indexPathSizeCache existsSizeAtIndexPath:indexPath preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue]) {
+        return [indexPathSizeCache sizeForIndexPath:indexPath preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+    }
+    
+    //hit content cache
+    CGSize size = CGSizeZero;
+    CPContentSizeCache *contentSizeCache = contentFingerprint ? [self cp_contentSizeCache] : nil;
+    if (![contentSizeCache getSize:&size forReuseIdentifier:identifier contentFingerprint:contentFingerprint preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue]) {
+        size = [self cp_sizeForCellWithIdentifier:identifier
+                         preferredLayoutDimension:preferredLayoutDimension
+                             preferredLayoutValue:preferredLayoutValue
+                                    configuration:configuration];
+        [contentSizeCache cacheSize:size forReuseIdentifier:identifier contentFingerprint:contentFingerprint preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+    }
+    
+    [indexPathSizeCache cacheSize:size byIndexPath:indexPath preferredLayoutDimension:preferredLayoutDimension preferredLayoutValue:preferredLayoutValue];
+    
+    return size;
+}
+
 #pragma mark - Calculating Supplementary View Size
 
 - (CGSize)cp_sizeForSupplementaryViewOfKind:(NSString *)kind
@@ -135,10 +314,16 @@
     }
     
     UICollectionReusableView *templateLayoutSupplementaryView = [self cp_templateSupplementaryViewOfKind:kind reuseIdentifier:identifier];
-    return [self cp_sizeForReusableView:templateLayoutSupplementaryView
-               preferredLayoutDimension:preferredLayoutDimension
-                   preferredLayoutValue:preferredLayoutValue
-                          configuration:configuration];
+    
+    CPCollectionViewMetrics *metrics = self.cp_metrics;
+    CPMetricsInterval interval = [metrics beginInterval:CPCollectionViewMetricsEventMeasurement reuseIdentifier:identifier];
+    CGSize size = [self cp_sizeForReusableView:templateLayoutSupplementaryView
+                      preferredLayoutDimension:preferredLayoutDimension
+                          preferredLayoutValue:preferredLayoutValue
+                                 configuration:configuration];
+    [metrics endInterval:interval event:CPCollectionViewMetricsEventMeasurement reuseIdentifier:identifier];
+    
+    return size;
 }
 
 #pragma mark - Calculating ReusableView Size
@@ -0,0 +1,34 @@
+//
+//  CPBenchmarkCase.h
+//  CPDataDrivenFlowLayout Benchmarks
+//
+//
+
+#import <XCTest/XCTest.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ 基准测试基类，每个结果输出一行 CPBENCH {"benchmark":...,"size":...,"operations":...,"ns_per_op":...,"allocations_per_op":...}
+ 用 xcodebuild test ... | grep CPBENCH 收集结果，与上一个release的结果对比即可发现规模退化
+ */
+@interface CPBenchmarkCase : XCTestCase
+
++ (NSArray<NSNumber *> *)sizes;//100 to 1M items, sizes above CP_BENCHMARK_MAX_SIZE (environment variable, default 100000) are skipped
+
+/**
+ 执行block operations次，输出平均耗时与平均分配次数
+
+ @param name       基准名称
+ @param size       数据规模
+ @param operations 执行次数
+ @param block      被测代码，operation为当前次数
+ */
+- (void)benchmark:(NSString *)name
+             size:(NSUInteger)size
+       operations:(NSUInteger)operations
+       usingBlock:(void (NS_NOESCAPE ^)(NSUInteger operation))block;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,85 @@
+//
+//  CPBenchmarkCase.m
+//  CPDataDrivenFlowLayout Benchmarks
+//
+//
+
+#import "CPBenchmarkCase.h"
+#import <mach/mach_time.h>
+#import <stdatomic.h>
+
+//exported by libsystem_malloc, called for every malloc, realloc and free of every zone
+typedef void (CPMallocLogger)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfHotFramesToSkip);
+extern CPMallocLogger *malloc_logger;
+
+static const uint32_t CPMallocLogTypeAllocate = 2;
+
+static CPMallocLogger *CPPreviousMallocLogger = NULL;
+static atomic_uint_fast64_t CPAllocationCount = 0;
+
+static void CPCountingMallocLogger(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfHotFramesToSkip) {
+    if (type & CPMallocLogTypeAllocate) {
+        atomic_fetch_add_explicit(&CPAllocationCount, 1, memory_order_relaxed);
+    }
+
+    if (CPPreviousMallocLogger) {
+        CPPreviousMallocLogger(type, arg1, arg2, arg3, result, numberOfHotFramesToSkip + 1);
+    }
+}
+
+@implementation CPBenchmarkCase
+
++ (NSArray<NSNumber *> *)sizes {
+    static NSArray *sizes = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSUInteger maximumSize = 100000;
+        NSString *value = [NSProcessInfo processInfo].environment[@"CP_BENCHMARK_MAX_SIZE"];
+        if (value.integerValue > 0) {
+            maximumSize = (NSUInteger)value.integerValue;
+        }
+
+        NSMutableArray *filteredSizes = [NSMutableArray array];
+        for (NSNumber *size in @[@100, @1000, @10000, @100000, @1000000]) {
+            if (size.unsignedIntegerValue <= maximumSize) {
+                [filteredSizes addObject:size];
+            }
+        }
+        sizes = [filteredSizes copy];
+    });
+    return sizes;
+}
+
+- (void)benchmark:(NSString *)name size:(NSUInteger)size operations:(NSUInteger)operations usingBlock:(void (NS_NOESCAPE ^)(NSUInteger))block {
+    NSParameterAssert(operations > 0);
+
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+        CPPreviousMallocLogger = malloc_logger;
+        malloc_logger = CPCountingMallocLogger;
+    });
+
+    //the count is process-wide, keep other threads idle while measuring
+    uint64_t allocations = atomic_load_explicit(&CPAllocationCount, memory_order_relaxed);
+    uint64_t start = mach_absolute_time();
+    @autoreleasepool {
+        for (NSUInteger operation = 0; operation < operations; operation++) {
+            block(operation);
+        }
+    }
+    uint64_t elapsed = mach_absolute_time() - start;
+    allocations = atomic_load_explicit(&CPAllocationCount, memory_order_relaxed) - allocations;
+
+    double nanoseconds = (double)elapsed * timebase.numer / timebase.denom;
+    NSDictionary *result = @{@"benchmark":name,
+                             @"size":@(size),
+                             @"operations":@(operations),
+                             @"ns_per_op":@(nanoseconds / operations),
+                             @"allocations_per_op":@((double)allocations / operations)};
+    NSData *json = [NSJSONSerialization dataWithJSONObject:result options:0 error:NULL];
+    printf("CPBENCH %s\n", [[NSString alloc] initWithData:json encoding:NSUTF8StringEncoding].UTF8String);
+}
+
+@end
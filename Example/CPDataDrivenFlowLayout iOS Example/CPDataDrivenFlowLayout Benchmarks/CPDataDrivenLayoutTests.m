@@ -0,0 +1,175 @@
+//
+//  CPDataDrivenLayoutTests.m
+//  CPDataDrivenFlowLayout Benchmarks
+//
+//
+
+#import <XCTest/XCTest.h>
+#import <CPDataDrivenFlowLayout/CPDataDrivenFlowLayout.h>
+
+static const CGFloat CPDataDrivenLayoutTestAccuracy = 1;//UICollectionViewFlowLayout rounds to pixels
+
+typedef NSArray<CPCollectionViewSectionInfo *> * (^CPSectionInfosFactory)(void);
+
+@interface CPDataDrivenLayoutTests : XCTestCase
+
+@end
+
+@implementation CPDataDrivenLayoutTests
+
+#pragma mark - Fixtures
+
+- (CPCollectionViewCellInfo *)cellInfoWithSize:(CGSize)size {
+    CPCollectionViewCellDescriptor *descriptor = [[CPCollectionViewCellDescriptor alloc] initWithCellClass:[UICollectionViewCell class] cellDidReuseCallback:^(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewCell * _Nonnull cell, NSIndexPath * _Nonnull indexPath, __kindof NSObject * _Nullable data) {
+    } sizeForCellCallback:^CGSize(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewLayout * _Nonnull layout, CPCollectionViewPreferredLayoutBlock  _Nonnull sizeByPreferredLayoutCalculator) {
+        return size;
+    }];
+    return [[CPCollectionViewCellInfo alloc] initWithDescriptor:descriptor data:nil];
+}
+
+- (NSArray<CPCollectionViewCellInfo *> *)cellInfosWithSizes:(NSArray<NSValue *> *)sizes {
+    NSMutableArray *cellInfos = [NSMutableArray arrayWithCapacity:sizes.count];
+    for (NSValue *size in sizes) {
+        [cellInfos addObject:[self cellInfoWithSize:size.CGSizeValue]];
+    }
+    return cellInfos;
+}
+
+- (CPCollectionViewSectionInfo *)sectionInfoWithSizes:(NSArray<NSValue *> *)sizes headerHeight:(CGFloat)headerHeight footerHeight:(CGFloat)footerHeight {
+    CPCollectionViewSectionInfo *sectionInfo = [[CPCollectionViewSectionInfo alloc] initWithCellInfos:[self cellInfosWithSizes:sizes]];
+    if (headerHeight > 0) {
+        sectionInfo.headerClass = [UICollectionReusableView class];
+        sectionInfo.headerDidReuseCallback = ^(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionReusableView * _Nonnull reusableView, NSInteger section) {
+        };
+        sectionInfo.sizeForHeaderCallback = ^CGSize(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewLayout * _Nonnull layout, CPCollectionViewPreferredLayoutBlock  _Nonnull sizeByPreferredLayoutCalculator) {
+            return CGSizeMake(collectionView.bounds.size.width, headerHeight);
+        };
+    }
+    if (footerHeight > 0) {
+        sectionInfo.footerClass = [UICollectionReusableView class];
+        sectionInfo.footerDidReuseCallback = ^(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionReusableView * _Nonnull reusableView, NSInteger section) {
+        };
+        sectionInfo.sizeForFooterCallback = ^CGSize(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewLayout * _Nonnull layout, CPCollectionViewPreferredLayoutBlock  _Nonnull sizeByPreferredLayoutCalculator) {
+            return CGSizeMake(collectionView.bounds.size.width, footerHeight);
+        };
+    }
+    return sectionInfo;
+}
+
+- (UICollectionView *)collectionViewWithLayout:(UICollectionViewLayout *)layout sectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    UICollectionView *collectionView = [[UICollectionView alloc] initWithFrame:CGRectMake(0, 0, 320, 480) collectionViewLayout:layout];
+    [collectionView cp_enableDataDrivenFlowLayout];
+    [collectionView cp_reloadWithSectionInfos:sectionInfos];
+    [collectionView layoutIfNeeded];
+    return collectionView;
+}
+
+#pragma mark - Assertions
+
+- (void)assertFrame:(CGRect)frame equalToFrame:(CGRect)expectedFrame of:(NSString *)element {
+    XCTAssertEqualWithAccuracy(frame.origin.x, expectedFrame.origin.x, CPDataDrivenLayoutTestAccuracy, @"%@: %@ vs %@", element, NSStringFromCGRect(frame), NSStringFromCGRect(expectedFrame));
+    XCTAssertEqualWithAccuracy(frame.origin.y, expectedFrame.origin.y, CPDataDrivenLayoutTestAccuracy, @"%@: %@ vs %@", element, NSStringFromCGRect(frame), NSStringFromCGRect(expectedFrame));
+    XCTAssertEqualWithAccuracy(frame.size.width, expectedFrame.size.width, CPDataDrivenLayoutTestAccuracy, @"%@: %@ vs %@", element, NSStringFromCGRect(frame), NSStringFromCGRect(expectedFrame));
+    XCTAssertEqualWithAccuracy(frame.size.height, expectedFrame.size.height, CPDataDrivenLayoutTestAccuracy, @"%@: %@ vs %@", element, NSStringFromCGRect(frame), NSStringFromCGRect(expectedFrame));
+}
+
+//section infos are built twice, a section info is shown in one collection view at a time here
+- (void)assertDataDrivenLayoutMatchesFlowLayoutWithSectionInfos:(CPSectionInfosFactory)sectionInfosFactory {
+    UICollectionViewFlowLayout *flowLayout = [UICollectionViewFlowLayout new];
+    CPDataDrivenLayout *dataDrivenLayout = [CPDataDrivenLayout new];
+    //layouts reference their collection view weakly
+    __attribute__((objc_precise_lifetime)) UICollectionView *flowCollectionView = [self collectionViewWithLayout:flowLayout sectionInfos:sectionInfosFactory()];
+    __attribute__((objc_precise_lifetime)) UICollectionView *dataDrivenCollectionView = [self collectionViewWithLayout:dataDrivenLayout sectionInfos:sectionInfosFactory()];
+
+    XCTAssertEqualWithAccuracy(dataDrivenLayout.collectionViewContentSize.height, flowLayout.collectionViewContentSize.height, CPDataDrivenLayoutTestAccuracy);
+
+    NSArray<CPCollectionViewSectionInfo *> *sectionInfos = flowCollectionView.cp_sectionInfos;
+    for (NSInteger section = 0; section < (NSInteger)sectionInfos.count; section++) {
+        for (NSInteger item = 0; item < sectionInfos[section].numberOfItems; item++) {
+            NSIndexPath *indexPath = [NSIndexPath indexPathForItem:item inSection:section];
+            [self assertFrame:[dataDrivenLayout layoutAttributesForItemAtIndexPath:indexPath].frame
+                 equalToFrame:[flowLayout layoutAttributesForItemAtIndexPath:indexPath].frame
+                           of:[NSString stringWithFormat:@"item %@", indexPath]];
+        }
+
+        NSIndexPath *indexPath = [NSIndexPath indexPathForItem:0 inSection:section];
+        for (NSString *kind in @[UICollectionElementKindSectionHeader, UICollectionElementKindSectionFooter]) {
+            //UICollectionViewFlowLayout returns zero sized attributes for missing headers and footers
+            UICollectionViewLayoutAttributes *expectedAttributes = [flowLayout layoutAttributesForSupplementaryViewOfKind:kind atIndexPath:indexPath];
+            if (!expectedAttributes || CGRectIsEmpty(expectedAttributes.frame)) {
+                continue;
+            }
+
+            [self assertFrame:[dataDrivenLayout layoutAttributesForSupplementaryViewOfKind:kind atIndexPath:indexPath].frame
+                 equalToFrame:expectedAttributes.frame
+                           of:[NSString stringWithFormat:@"%@ %ld", kind, (long)section]];
+        }
+    }
+
+    //the rect query must return the same elements as looking them up one by one
+    CGRect contentRect = (CGRect){CGPointZero, flowLayout.collectionViewContentSize};
+    NSUInteger numberOfExpectedAttributes = 0;
+    for (UICollectionViewLayoutAttributes *attributes in [flowLayout layoutAttributesForElementsInRect:contentRect]) {
+        numberOfExpectedAttributes += CGRectIsEmpty(attributes.frame) ? 0 : 1;
+    }
+    XCTAssertEqual([dataDrivenLayout layoutAttributesForElementsInRect:contentRect].count, numberOfExpectedAttributes);
+}
+
+#pragma mark - Flow
+
+- (void)testMixedSizesInsetsAndSpacings {
+    [self assertDataDrivenLayoutMatchesFlowLayoutWithSectionInfos:^NSArray<CPCollectionViewSectionInfo *> *{
+        CPCollectionViewSectionInfo *grid = [self sectionInfoWithSizes:@[[NSValue valueWithCGSize:CGSizeMake(100, 50)],
+                                                                        [NSValue valueWithCGSize:CGSizeMake(100, 70)],
+                                                                        [NSValue valueWithCGSize:CGSizeMake(100, 30)],
+                                                                        [NSValue valueWithCGSize:CGSizeMake(60, 40)],
+                                                                        [NSValue valueWithCGSize:CGSizeMake(180, 40)],
+                                                                        [NSValue valueWithCGSize:CGSizeMake(90, 20)]] headerHeight:44 footerHeight:20];
+        grid.sectionInset = UIEdgeInsetsMake(10, 15, 20, 5);
+        grid.minimumLineSpacing = 8;
+        grid.minimumInteritemSpacing = 6;
+
+        CPCollectionViewSectionInfo *list = [self sectionInfoWithSizes:@[[NSValue valueWithCGSize:CGSizeMake(320, 44)],
+                                                                        [NSValue valueWithCGSize:CGSizeMake(320, 88)],
+                                                                        [NSValue valueWithCGSize:CGSizeMake(320, 44)]] headerHeight:30 footerHeight:0];
+        list.minimumLineSpacing = 1;
+
+        CPCollectionViewSectionInfo *lastLine = [self sectionInfoWithSizes:@[[NSValue valueWithCGSize:CGSizeMake(150, 50)],
+                                                                            [NSValue valueWithCGSize:CGSizeMake(150, 50)],
+                                                                            [NSValue valueWithCGSize:CGSizeMake(150, 60)]] headerHeight:0 footerHeight:40];
+        lastLine.sectionInset = UIEdgeInsetsMake(5, 5, 5, 5);
+        lastLine.minimumInteritemSpacing = 10;
+
+        return @[grid, list, lastLine];
+    }];
+}
+
+- (void)testEmptySection {
+    [self assertDataDrivenLayoutMatchesFlowLayoutWithSectionInfos:^NSArray<CPCollectionViewSectionInfo *> *{
+        CPCollectionViewSectionInfo *before = [self sectionInfoWithSizes:@[[NSValue valueWithCGSize:CGSizeMake(100, 50)]] headerHeight:0 footerHeight:0];
+        CPCollectionViewSectionInfo *empty = [self sectionInfoWithSizes:@[] headerHeight:40 footerHeight:30];
+        empty.sectionInset = UIEdgeInsetsMake(20, 10, 20, 10);
+        empty.minimumLineSpacing = 12;
+        CPCollectionViewSectionInfo *after = [self sectionInfoWithSizes:@[[NSValue valueWithCGSize:CGSizeMake(100, 50)],
+                                                                         [NSValue valueWithCGSize:CGSizeMake(100, 50)]] headerHeight:20 footerHeight:0];
+        after.sectionInset = UIEdgeInsetsMake(8, 0, 8, 0);
+
+        return @[before, empty, after];
+    }];
+}
+
+- (void)testItemWiderThanContentWidth {
+    [self assertDataDrivenLayoutMatchesFlowLayoutWithSectionInfos:^NSArray<CPCollectionViewSectionInfo *> *{
+        CPCollectionViewSectionInfo *sectionInfo = [self sectionInfoWithSizes:@[[NSValue valueWithCGSize:CGSizeMake(100, 50)],
+                                                                               [NSValue valueWithCGSize:CGSizeMake(400, 60)],
+                                                                               [NSValue valueWithCGSize:CGSizeMake(100, 50)],
+                                                                               [NSValue valueWithCGSize:CGSizeMake(100, 50)]] headerHeight:30 footerHeight:30];
+        sectionInfo.sectionInset = UIEdgeInsetsMake(10, 10, 10, 10);
+        sectionInfo.minimumLineSpacing = 5;
+        sectionInfo.minimumInteritemSpacing = 5;
+
+        return @[sectionInfo];
+    }];
+}
+
+@end
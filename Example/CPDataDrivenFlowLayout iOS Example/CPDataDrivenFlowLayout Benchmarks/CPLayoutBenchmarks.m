@@ -0,0 +1,116 @@
+//
+//  CPLayoutBenchmarks.m
+//  CPDataDrivenFlowLayout Benchmarks
+//
+//
+
+#import "CPBenchmarkCase.h"
+#import <CPDataDrivenFlowLayout/CPDataDrivenFlowLayout.h>
+
+static const NSUInteger CPLayoutBenchmarkNumberOfItemsPerSection = 10;
+static const NSUInteger CPLayoutBenchmarkLookups = 100000;
+
+@interface CPLayoutBenchmarks : CPBenchmarkCase
+
+@property (nonatomic) CPCollectionViewCellDescriptor *descriptor;
+
+@end
+
+@implementation CPLayoutBenchmarks
+
+- (void)setUp {
+    [super setUp];
+
+    self.descriptor = [[CPCollectionViewCellDescriptor alloc] initWithCellClass:[UICollectionViewCell class] cellDidReuseCallback:^(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewCell * _Nonnull cell, NSIndexPath * _Nonnull indexPath, __kindof NSObject * _Nullable data) {
+    } sizeForCellCallback:^CGSize(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewLayout * _Nonnull layout, CPCollectionViewPreferredLayoutBlock  _Nonnull sizeByPreferredLayoutCalculator) {
+        return CGSizeMake(100, 50);
+    }];
+}
+
+#pragma mark - Fixtures
+
+- (NSArray<CPCollectionViewCellInfo *> *)cellInfosWithCount:(NSUInteger)count {
+    NSMutableArray *cellInfos = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [cellInfos addObject:[[CPCollectionViewCellInfo alloc] initWithDescriptor:self.descriptor data:@(i)]];
+    }
+    return cellInfos;
+}
+
+//size is the number of items, spread over size / CPLayoutBenchmarkNumberOfItemsPerSection sections
+- (UICollectionView *)collectionViewWithNumberOfItems:(NSUInteger)numberOfItems layout:(UICollectionViewLayout *)layout {
+    NSUInteger numberOfSections = MAX(numberOfItems / CPLayoutBenchmarkNumberOfItemsPerSection, 1);
+    NSMutableArray *sectionInfos = [NSMutableArray arrayWithCapacity:numberOfSections];
+    for (NSUInteger section = 0; section < numberOfSections; section++) {
+        [sectionInfos addObject:[[CPCollectionViewSectionInfo alloc] initWithCellInfos:[self cellInfosWithCount:CPLayoutBenchmarkNumberOfItemsPerSection]]];
+    }
+
+    UICollectionView *collectionView = [[UICollectionView alloc] initWithFrame:CGRectMake(0, 0, 320, 480) collectionViewLayout:layout];
+    [collectionView cp_enableDataDrivenFlowLayout];
+    [collectionView cp_reloadWithSectionInfos:sectionInfos];
+    [collectionView layoutIfNeeded];
+    return collectionView;
+}
+
+#pragma mark - Section Geometry
+
+- (void)testSectionGeometry {
+    for (NSNumber *sizeNumber in [[self class] sizes]) {
+        NSUInteger size = sizeNumber.unsignedIntegerValue;
+        UICollectionView *collectionView = [self collectionViewWithNumberOfItems:size layout:[UICollectionViewFlowLayout new]];
+        NSUInteger numberOfSections = collectionView.cp_sectionInfos.count;
+        NSArray *cellInfos = [self cellInfosWithCount:1000];
+
+        //what every layout callback pays to read the section metrics, by index into the mirror or through the section info
+        [self benchmark:@"layout.section_geometry.lookup" size:size operations:CPLayoutBenchmarkLookups usingBlock:^(NSUInteger operation) {
+            const CPCollectionViewSectionGeometry *geometry = [collectionView cp_sectionGeometry];
+            (void)geometry->numberOfItems[(operation * 7919) % numberOfSections];
+        }];
+        [self benchmark:@"layout.section_info.lookup" size:size operations:CPLayoutBenchmarkLookups usingBlock:^(NSUInteger operation) {
+            (void)[collectionView cp_sectionInfoForSection:(operation * 7919) % numberOfSections].numberOfItems;
+        }];
+
+        //an item change refreshes one entry of the mirror, it must stay flat as the number of sections grows
+        [self benchmark:@"layout.section_geometry.after_append" size:size operations:cellInfos.count usingBlock:^(NSUInteger operation) {
+            [[collectionView cp_sectionInfoForSection:operation % numberOfSections] cp_appendCellInfos:@[cellInfos[operation]]];
+            (void)[collectionView cp_sectionGeometry];
+        }];
+        [self benchmark:@"layout.section_geometry.after_inset_change" size:size operations:cellInfos.count usingBlock:^(NSUInteger operation) {
+            [collectionView cp_sectionInfoForSection:operation % numberOfSections].sectionInset = UIEdgeInsetsMake(operation % 2, 0, 0, 0);
+            (void)[collectionView cp_sectionGeometry];
+        }];
+    }
+}
+
+#pragma mark - Layout Pass
+
+- (void)testLayoutPass {
+    for (NSNumber *sizeNumber in [[self class] sizes]) {
+        NSUInteger size = sizeNumber.unsignedIntegerValue;
+        NSUInteger operations = MAX(1000 / (size / 100), 1);
+        NSDictionary<NSString *, UICollectionViewLayout *> *layouts = @{@"flow_layout":[UICollectionViewFlowLayout new], @"data_driven_layout":[CPDataDrivenLayout new]};
+
+        [layouts enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull name, UICollectionViewLayout * _Nonnull layout, BOOL * _Nonnull stop) {
+            UICollectionView *collectionView = [self collectionViewWithNumberOfItems:size layout:layout];
+            CGRect visibleRect = collectionView.bounds;
+
+            //a full pass, e.g. after reloadData or a width change
+            [self benchmark:[NSString stringWithFormat:@"layout.%@.full_pass", name] size:size operations:operations usingBlock:^(NSUInteger operation) {
+                [layout invalidateLayout];
+                [layout prepareLayout];
+                (void)[layout layoutAttributesForElementsInRect:visibleRect];
+            }];
+
+            //infinite scrolling: items appended to the last section, then the visible rect is laid out again
+            NSInteger lastSection = collectionView.cp_sectionInfos.count - 1;
+            NSArray *cellInfos = [self cellInfosWithCount:operations];
+            [self benchmark:[NSString stringWithFormat:@"layout.%@.append_pass", name] size:size operations:operations usingBlock:^(NSUInteger operation) {
+                [collectionView cp_appendCellInfos:@[cellInfos[operation]] inSection:lastSection];
+                [collectionView layoutIfNeeded];
+                (void)[layout layoutAttributesForElementsInRect:visibleRect];
+            }];
+        }];
+    }
+}
+
+@end
@@ -0,0 +1,274 @@
+//
+//  CPModelBenchmarks.m
+//  CPDataDrivenFlowLayout Benchmarks
+//
+//
+
+#import "CPBenchmarkCase.h"
+#import <CPDataDrivenFlowLayout/CPDataDrivenFlowLayout.h>
+#import <CPDataDrivenFlowLayout/CPDiff.h>
+#import <CPDataDrivenFlowLayout/CPIndexPathSizeCache.h>
+#import <CPDataDrivenFlowLayout/CPPersistentSizeStore.h>
+
+static const NSUInteger CPBenchmarkNumberOfSections = 10;
+
+@interface CPModelBenchmarks : CPBenchmarkCase <CPFlowLayoutEngineDataSource>
+
+@property (nonatomic) CPCollectionViewCellDescriptor *descriptor;
+@property (nonatomic) NSUInteger numberOfItemsPerSection;
+
+@end
+
+@implementation CPModelBenchmarks
+
+- (void)setUp {
+    [super setUp];
+
+    self.descriptor = [[CPCollectionViewCellDescriptor alloc] initWithCellClass:[UICollectionViewCell class] cellDidReuseCallback:^(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewCell * _Nonnull cell, NSIndexPath * _Nonnull indexPath, __kindof NSObject * _Nullable data) {
+    } sizeForCellCallback:^CGSize(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewLayout * _Nonnull layout, CPCollectionViewPreferredLayoutBlock  _Nonnull sizeByPreferredLayoutCalculator) {
+        return CGSizeMake(100, 50);
+    }];
+}
+
+#pragma mark - Fixtures
+
+- (NSArray<CPCollectionViewCellInfo *> *)cellInfosWithCount:(NSUInteger)count {
+    NSMutableArray *cellInfos = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [cellInfos addObject:[[CPCollectionViewCellInfo alloc] initWithDescriptor:self.descriptor data:@(i)]];
+    }
+    return cellInfos;
+}
+
+- (NSArray<CPCollectionViewSectionInfo *> *)sectionInfosWithNumberOfItems:(NSUInteger)numberOfItems {
+    NSMutableArray *sectionInfos = [NSMutableArray arrayWithCapacity:CPBenchmarkNumberOfSections];
+    for (NSUInteger section = 0; section < CPBenchmarkNumberOfSections; section++) {
+        [sectionInfos addObject:[[CPCollectionViewSectionInfo alloc] initWithCellInfos:[self cellInfosWithCount:numberOfItems / CPBenchmarkNumberOfSections]]];
+    }
+    return sectionInfos;
+}
+
+- (UICollectionView *)collectionViewWithNumberOfItems:(NSUInteger)numberOfItems {
+    UICollectionView *collectionView = [[UICollectionView alloc] initWithFrame:CGRectMake(0, 0, 320, 480) collectionViewLayout:[UICollectionViewFlowLayout new]];
+    [collectionView cp_enableDataDrivenFlowLayout];
+    [collectionView cp_reloadWithSectionInfos:[self sectionInfosWithNumberOfItems:numberOfItems]];
+    [collectionView layoutIfNeeded];
+    return collectionView;
+}
+
+#pragma mark - Section Info
+
+- (void)testSectionInfoMutations {
+    for (NSNumber *sizeNumber in [[self class] sizes]) {
+        NSUInteger size = sizeNumber.unsignedIntegerValue;
+        NSUInteger operations = MIN(size / 2, 1000);
+        CPCollectionViewSectionInfo *sectionInfo = [[CPCollectionViewSectionInfo alloc] initWithCellInfos:[self cellInfosWithCount:size]];
+        NSArray *cellInfos = [self cellInfosWithCount:operations * 4];
+
+        [self benchmark:@"section_info.append" size:size operations:operations usingBlock:^(NSUInteger operation) {
+            [sectionInfo cp_appendCellInfos:@[cellInfos[operation]]];
+        }];
+        [self benchmark:@"section_info.delete_middle" size:size operations:operations usingBlock:^(NSUInteger operation) {
+            [sectionInfo cp_deleteCellInfosAtIndexSet:[NSIndexSet indexSetWithIndex:sectionInfo.numberOfItems / 2]];
+        }];
+        [self benchmark:@"section_info.insert_front" size:size operations:operations usingBlock:^(NSUInteger operation) {
+            [sectionInfo cp_insertCellInfos:@[cellInfos[operations + operation]] atIndexSet:[NSIndexSet indexSetWithIndex:0]];
+        }];
+        [self benchmark:@"section_info.update" size:size operations:operations usingBlock:^(NSUInteger operation) {
+            [sectionInfo cp_updateCellInfo:cellInfos[operations * 2 + operation] atIndex:(operation * 7919) % size];
+        }];
+        [self benchmark:@"section_info.index_of" size:size operations:operations usingBlock:^(NSUInteger operation) {
+            [sectionInfo cp_indexOfCellInfo:cellInfos[operations * 2 + operation]];
+        }];
+        [self benchmark:@"section_info.cell_infos_after_append" size:size operations:MIN(operations, 100) usingBlock:^(NSUInteger operation) {
+            [sectionInfo cp_appendCellInfos:@[cellInfos[operations * 3 + operation]]];
+            [sectionInfo cellInfos];
+        }];
+    }
+}
+
+#pragma mark - Collection View
+
+- (void)testReload {
+    for (NSNumber *sizeNumber in [[self class] sizes]) {
+        NSUInteger size = sizeNumber.unsignedIntegerValue;
+        UICollectionView *collectionView = [self collectionViewWithNumberOfItems:size];
+        NSArray *sectionInfos = [self sectionInfosWithNumberOfItems:size];
+
+        //every item is indexed and registered, cells sharing a reuse identifier are registered once
+        [self benchmark:@"collection_view.reload" size:size operations:10 usingBlock:^(NSUInteger operation) {
+            [collectionView cp_reloadWithSectionInfos:sectionInfos];
+        }];
+    }
+}
+
+- (void)testLookups {
+    for (NSNumber *sizeNumber in [[self class] sizes]) {
+        NSUInteger size = sizeNumber.unsignedIntegerValue;
+        NSUInteger numberOfItemsPerSection = size / CPBenchmarkNumberOfSections;
+        UICollectionView *collectionView = [self collectionViewWithNumberOfItems:size];
+        NSMutableArray *indexPaths = [NSMutableArray arrayWithCapacity:1000];
+        NSMutableArray *cellInfos = [NSMutableArray arrayWithCapacity:1000];
+        for (NSUInteger i = 0; i < 1000; i++) {
+            NSIndexPath *indexPath = [NSIndexPath indexPathForItem:(i * 7919) % numberOfItemsPerSection inSection:i % CPBenchmarkNumberOfSections];
+            [indexPaths addObject:indexPath];
+            [cellInfos addObject:[collectionView cp_cellInfoForItemAtIndexPath:indexPath]];
+        }
+
+        [self benchmark:@"collection_view.cell_info_for_index_path" size:size operations:indexPaths.count usingBlock:^(NSUInteger operation) {
+            [collectionView cp_cellInfoForItemAtIndexPath:indexPaths[operation]];
+        }];
+        [self benchmark:@"collection_view.index_path_for_cell_info" size:size operations:cellInfos.count usingBlock:^(NSUInteger operation) {
+            [collectionView cp_indexPathForCellInfo:cellInfos[operation]];
+        }];
+    }
+}
+
+- (void)testMutationSequences {
+    for (NSNumber *sizeNumber in [[self class] sizes]) {
+        NSUInteger size = sizeNumber.unsignedIntegerValue;
+        NSUInteger operations = MIN(size / CPBenchmarkNumberOfSections / 2, 100);
+        UICollectionView *collectionView = [self collectionViewWithNumberOfItems:size];
+        NSArray *cellInfos = [self cellInfosWithCount:operations * 3];
+        NSArray *batches = [self cellInfosWithCount:operations * 10];
+
+        [self benchmark:@"collection_view.append" size:size operations:operations usingBlock:^(NSUInteger operation) {
+            [collectionView cp_appendCellInfos:@[cellInfos[operation]] inSection:operation % CPBenchmarkNumberOfSections];
+        }];
+        [self benchmark:@"collection_view.append_batch_of_10" size:size operations:operations usingBlock:^(NSUInteger operation) {
+            [collectionView cp_appendCellInfos:[batches subarrayWithRange:NSMakeRange(operation * 10, 10)] inSection:operation % CPBenchmarkNumberOfSections];
+        }];
+        [self benchmark:@"collection_view.insert" size:size operations:operations usingBlock:^(NSUInteger operation) {
+            [collectionView cp_insertCellInfos:@[cellInfos[operations + operation]] atIndexPaths:@[[NSIndexPath indexPathForItem:operation inSection:operation % CPBenchmarkNumberOfSections]]];
+        }];
+        [self benchmark:@"collection_view.delete" size:size operations:operations usingBlock:^(NSUInteger operation) {
+            [collectionView cp_deleteItemAtIndexPath:[NSIndexPath indexPathForItem:operation inSection:operation % CPBenchmarkNumberOfSections]];
+        }];
+        [self benchmark:@"collection_view.batch_updates" size:size operations:operations usingBlock:^(NSUInteger operation) {
+            [collectionView cp_performBatchUpdates:^{
+                [collectionView cp_appendCellInfos:@[cellInfos[operations * 2 + operation]] inSection:0];
+                [collectionView cp_deleteItemAtIndexPath:[NSIndexPath indexPathForItem:0 inSection:1]];
+            } completion:nil];
+        }];
+    }
+}
+
+#pragma mark - Diff
+
+- (void)testDiff {
+    for (NSNumber *sizeNumber in [[self class] sizes]) {
+        NSUInteger size = sizeNumber.unsignedIntegerValue;
+        NSMutableArray *oldArray = [NSMutableArray arrayWithCapacity:size];
+        for (NSUInteger i = 0; i < size; i++) {
+            [oldArray addObject:@(i)];
+        }
+        //one move, one delete and one insert
+        NSMutableArray *newArray = [oldArray mutableCopy];
+        [newArray exchangeObjectAtIndex:0 withObjectAtIndex:size - 1];
+        [newArray removeObjectAtIndex:size / 2];
+        [newArray addObject:@(size)];
+
+        [self benchmark:@"diff.few_changes" size:size operations:10 usingBlock:^(NSUInteger operation) {
+            [CPDiff diffWithOldArray:oldArray newArray:newArray keyBlock:^id<NSObject> _Nonnull(id  _Nonnull object) {
+                return object;
+            } equalBlock:nil];
+        }];
+    }
+}
+
+#pragma mark - Flow Layout Engine
+
+- (NSUInteger)numberOfSectionsInFlowLayoutEngine:(CPFlowLayoutEngine *)engine {
+    return CPBenchmarkNumberOfSections;
+}
+
+- (NSUInteger)flowLayoutEngine:(CPFlowLayoutEngine *)engine numberOfItemsInSection:(NSUInteger)section {
+    return self.numberOfItemsPerSection;
+}
+
+- (CPFlowLayoutSectionMetrics)flowLayoutEngine:(CPFlowLayoutEngine *)engine metricsForSection:(NSUInteger)section {
+    CPFlowLayoutSectionMetrics metrics = {CPFlowLayoutInsetsMake(10, 10, 10, 10), 10, 10, 44, 0, section % 2 == 0 ? 0 : 2};
+    return metrics;
+}
+
+- (CGSize)flowLayoutEngine:(CPFlowLayoutEngine *)engine sizeForItemAtIndex:(NSUInteger)item inSection:(NSUInteger)section {
+    return CGSizeMake(100, 50 + item % 7 * 10);
+}
+
+- (void)testFlowLayoutEngine {
+    for (NSNumber *sizeNumber in [[self class] sizes]) {
+        NSUInteger size = sizeNumber.unsignedIntegerValue;
+        self.numberOfItemsPerSection = size / CPBenchmarkNumberOfSections;
+        CPFlowLayoutEngine *engine = [CPFlowLayoutEngine new];
+        engine.dataSource = self;
+        engine.containerWidth = 320;
+        [engine prepare];
+
+        [self benchmark:@"flow_layout_engine.prepare_all" size:size operations:10 usingBlock:^(NSUInteger operation) {
+            [engine invalidateAllSections];
+            [engine prepare];
+        }];
+        [self benchmark:@"flow_layout_engine.prepare_one_section" size:size operations:10 usingBlock:^(NSUInteger operation) {
+            [engine invalidateSections:[NSIndexSet indexSetWithIndex:operation % CPBenchmarkNumberOfSections]];
+            [engine prepare];
+        }];
+        [self benchmark:@"flow_layout_engine.enumerate_screen" size:size operations:1000 usingBlock:^(NSUInteger operation) {
+            CGRect rect = CGRectMake(0, operation * engine.contentSize.height / 1000, 320, 480);
+            [engine enumerateElementsInRect:rect usingBlock:^(CPFlowLayoutElementKind kind, NSUInteger section, NSUInteger item, CGRect frame, BOOL * _Nonnull stop) {
+            }];
+        }];
+    }
+}
+
+#pragma mark - Size Caches
+
+- (void)testIndexPathSizeCache {
+    for (NSNumber *sizeNumber in [[self class] sizes]) {
+        NSUInteger size = sizeNumber.unsignedIntegerValue;
+        NSUInteger numberOfItemsPerSection = size / CPBenchmarkNumberOfSections;
+        CPIndexPathSizeCache *cache = [CPIndexPathSizeCache new];
+        for (NSUInteger item = 0; item < size; item++) {
+            [cache cacheSize:CGSizeMake(100, 50) byIndexPath:[NSIndexPath indexPathForItem:item / CPBenchmarkNumberOfSections inSection:item % CPBenchmarkNumberOfSections] preferredLayoutDimension:CPPreferredLayoutDimensionWidth preferredLayoutValue:320];
+        }
+
+        [self benchmark:@"index_path_size_cache.get" size:size operations:1000 usingBlock:^(NSUInteger operation) {
+            [cache sizeForIndexPath:[NSIndexPath indexPathForItem:(operation * 7919) % numberOfItemsPerSection inSection:operation % CPBenchmarkNumberOfSections] preferredLayoutDimension:CPPreferredLayoutDimensionWidth preferredLayoutValue:320];
+        }];
+        [self benchmark:@"index_path_size_cache.insert_front" size:size operations:MIN(numberOfItemsPerSection, 100) usingBlock:^(NSUInteger operation) {
+            [cache insertItemsAtIndexPaths:@[[NSIndexPath indexPathForItem:0 inSection:operation % CPBenchmarkNumberOfSections]]];
+        }];
+        [self benchmark:@"index_path_size_cache.delete_front" size:size operations:MIN(numberOfItemsPerSection, 100) usingBlock:^(NSUInteger operation) {
+            [cache deleteItemsAtIndexPaths:@[[NSIndexPath indexPathForItem:0 inSection:operation % CPBenchmarkNumberOfSections]]];
+        }];
+    }
+}
+
+- (void)testPersistentSizeStore {
+    for (NSNumber *sizeNumber in [[self class] sizes]) {
+        NSUInteger size = sizeNumber.unsignedIntegerValue;
+        NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+        CPPersistentSizeStore *store = [[CPPersistentSizeStore alloc] initWithPath:path];
+        XCTAssertNotNil(store);
+        store.countLimit = 0;
+        NSMutableArray *fingerprints = [NSMutableArray arrayWithCapacity:size];
+        for (NSUInteger i = 0; i < size; i++) {
+            [fingerprints addObject:[NSString stringWithFormat:@"%lu", (unsigned long)i]];
+        }
+
+        [self benchmark:@"persistent_size_store.store" size:size operations:size usingBlock:^(NSUInteger operation) {
+            [store storeSize:CGSizeMake(100, 50) forReuseIdentifier:@"cell" contentFingerprint:fingerprints[operation] preferredLayoutDimension:CPPreferredLayoutDimensionWidth preferredLayoutValue:320];
+        }];
+        [self benchmark:@"persistent_size_store.synchronize" size:size operations:1 usingBlock:^(NSUInteger operation) {
+            [store synchronize];
+        }];
+        [self benchmark:@"persistent_size_store.get" size:size operations:MIN(size, 10000) usingBlock:^(NSUInteger operation) {
+            CGSize cellSize;
+            [store getSize:&cellSize forReuseIdentifier:@"cell" contentFingerprint:fingerprints[(operation * 7919) % size] preferredLayoutDimension:CPPreferredLayoutDimensionWidth preferredLayoutValue:320];
+        }];
+
+        [store removeAllSizes];
+        [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    }
+}
+
+@end
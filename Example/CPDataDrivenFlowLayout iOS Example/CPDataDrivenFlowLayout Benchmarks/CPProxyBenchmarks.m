@@ -0,0 +1,131 @@
+//
+//  CPProxyBenchmarks.m
+//  CPDataDrivenFlowLayout Benchmarks
+//
+//
+
+#import "CPBenchmarkCase.h"
+#import <CPDataDrivenFlowLayout/CPDataDrivenFlowLayout.h>
+#import <CPDataDrivenFlowLayout/CPCollectionViewDelegateFlowLayoutInterceptor.h>
+
+static const NSUInteger CPProxyBenchmarkNumberOfItems = 1000;
+static const NSUInteger CPProxyBenchmarkOperations = 100000;
+
+@interface _CPBenchmarkDelegate : NSObject <UICollectionViewDelegate>
+
+@end
+
+@implementation _CPBenchmarkDelegate
+
+- (void)scrollViewDidScroll:(UIScrollView *)scrollView {
+}
+
+@end
+
+
+
+//forwards every message through an NSInvocation, as the delegate proxy did before handlers were resolved once per selector
+@interface _CPInvocationForwardingProxy : NSProxy
+
+@property (nonatomic, weak) id target;
+@property (nonatomic, strong) id interceptor;
+
+@end
+
+@implementation _CPInvocationForwardingProxy
+
+- (BOOL)respondsToSelector:(SEL)aSelector {
+    return [_interceptor respondsToSelector:aSelector] || [_target respondsToSelector:aSelector];
+}
+
+- (NSMethodSignature *)methodSignatureForSelector:(SEL)sel {
+    NSMethodSignature *signature = [(id)_interceptor methodSignatureForSelector:sel];
+    if (signature) {
+        return signature;
+    }
+
+    signature = [(id)_target methodSignatureForSelector:sel];
+    if (signature) {
+        return signature;
+    }
+
+    return [NSMethodSignature signatureWithObjCTypes:@encode(void)];
+}
+
+- (void)forwardInvocation:(NSInvocation *)invocation {
+    if ([_interceptor respondsToSelector:invocation.selector]) {
+        [invocation invokeWithTarget:_interceptor];
+    } else if ([_target respondsToSelector:invocation.selector]) {
+        [invocation invokeWithTarget:_target];
+    }
+}
+
+@end
+
+
+
+@interface CPProxyBenchmarks : CPBenchmarkCase
+
+@end
+
+@implementation CPProxyBenchmarks
+
+- (void)testDelegateForwarding {
+    CPCollectionViewCellDescriptor *descriptor = [[CPCollectionViewCellDescriptor alloc] initWithCellClass:[UICollectionViewCell class] cellDidReuseCallback:^(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewCell * _Nonnull cell, NSIndexPath * _Nonnull indexPath, __kindof NSObject * _Nullable data) {
+    } sizeForCellCallback:^CGSize(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewLayout * _Nonnull layout, CPCollectionViewPreferredLayoutBlock  _Nonnull sizeByPreferredLayoutCalculator) {
+        return CGSizeMake(100, 50);
+    }];
+    NSMutableArray *cellInfos = [NSMutableArray arrayWithCapacity:CPProxyBenchmarkNumberOfItems];
+    for (NSUInteger i = 0; i < CPProxyBenchmarkNumberOfItems; i++) {
+        [cellInfos addObject:[[CPCollectionViewCellInfo alloc] initWithDescriptor:descriptor data:@(i)]];
+    }
+
+    UICollectionViewFlowLayout *layout = [UICollectionViewFlowLayout new];
+    UICollectionView *collectionView = [[UICollectionView alloc] initWithFrame:CGRectMake(0, 0, 320, 480) collectionViewLayout:layout];
+    _CPBenchmarkDelegate *delegate = [_CPBenchmarkDelegate new];
+    CPCollectionViewDelegateFlowLayoutInterceptor *interceptor = [CPCollectionViewDelegateFlowLayoutInterceptor new];
+    [collectionView cp_enableDataDrivenFlowLayout];
+    [collectionView cp_setDelegate:delegate interceptor:interceptor];
+    [collectionView cp_reloadWithSectionInfos:@[[[CPCollectionViewSectionInfo alloc] initWithCellInfos:cellInfos]]];
+    [collectionView layoutIfNeeded];
+
+    id<UICollectionViewDelegateFlowLayout> proxy = (id<UICollectionViewDelegateFlowLayout>)collectionView.delegate;
+    _CPInvocationForwardingProxy *invocationProxy = [_CPInvocationForwardingProxy alloc];
+    invocationProxy.target = delegate;
+    invocationProxy.interceptor = interceptor;
+    id<UICollectionViewDelegateFlowLayout> invocationForwardingProxy = (id<UICollectionViewDelegateFlowLayout>)invocationProxy;
+
+    //compare ns_per_op of direct calls, the proxy and the invocation-forwarding proxy, messages per second are 1e9 / ns_per_op
+    [self benchmark:@"proxy.scroll_view_did_scroll.direct" size:CPProxyBenchmarkNumberOfItems operations:CPProxyBenchmarkOperations usingBlock:^(NSUInteger operation) {
+        [delegate scrollViewDidScroll:collectionView];
+    }];
+    [self benchmark:@"proxy.scroll_view_did_scroll.proxy" size:CPProxyBenchmarkNumberOfItems operations:CPProxyBenchmarkOperations usingBlock:^(NSUInteger operation) {
+        [proxy scrollViewDidScroll:collectionView];
+    }];
+    [self benchmark:@"proxy.scroll_view_did_scroll.invocation" size:CPProxyBenchmarkNumberOfItems operations:CPProxyBenchmarkOperations usingBlock:^(NSUInteger operation) {
+        [invocationForwardingProxy scrollViewDidScroll:collectionView];
+    }];
+
+    NSMutableArray *indexPaths = [NSMutableArray arrayWithCapacity:CPProxyBenchmarkNumberOfItems];
+    for (NSUInteger item = 0; item < CPProxyBenchmarkNumberOfItems; item++) {
+        [indexPaths addObject:[NSIndexPath indexPathForItem:item inSection:0]];
+    }
+    [self benchmark:@"proxy.size_for_item.direct" size:CPProxyBenchmarkNumberOfItems operations:CPProxyBenchmarkOperations usingBlock:^(NSUInteger operation) {
+        [interceptor collectionView:collectionView layout:layout sizeForItemAtIndexPath:indexPaths[operation % CPProxyBenchmarkNumberOfItems]];
+    }];
+    [self benchmark:@"proxy.size_for_item.proxy" size:CPProxyBenchmarkNumberOfItems operations:CPProxyBenchmarkOperations usingBlock:^(NSUInteger operation) {
+        [proxy collectionView:collectionView layout:layout sizeForItemAtIndexPath:indexPaths[operation % CPProxyBenchmarkNumberOfItems]];
+    }];
+    [self benchmark:@"proxy.size_for_item.invocation" size:CPProxyBenchmarkNumberOfItems operations:CPProxyBenchmarkOperations usingBlock:^(NSUInteger operation) {
+        [invocationForwardingProxy collectionView:collectionView layout:layout sizeForItemAtIndexPath:indexPaths[operation % CPProxyBenchmarkNumberOfItems]];
+    }];
+
+    [self benchmark:@"proxy.responds_to_selector.proxy" size:CPProxyBenchmarkNumberOfItems operations:CPProxyBenchmarkOperations usingBlock:^(NSUInteger operation) {
+        [proxy respondsToSelector:@selector(scrollViewDidScroll:)];
+    }];
+    [self benchmark:@"proxy.responds_to_selector.invocation" size:CPProxyBenchmarkNumberOfItems operations:CPProxyBenchmarkOperations usingBlock:^(NSUInteger operation) {
+        [invocationForwardingProxy respondsToSelector:@selector(scrollViewDidScroll:)];
+    }];
+}
+
+@end
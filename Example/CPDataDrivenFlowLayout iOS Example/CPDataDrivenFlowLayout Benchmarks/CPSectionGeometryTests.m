@@ -0,0 +1,95 @@
+//
+//  CPSectionGeometryTests.m
+//  CPDataDrivenFlowLayout Benchmarks
+//
+//
+
+#import <XCTest/XCTest.h>
+#import <CPDataDrivenFlowLayout/CPDataDrivenFlowLayout.h>
+
+@interface CPSectionGeometryTests : XCTestCase
+
+@property (nonatomic) CPCollectionViewCellDescriptor *descriptor;
+
+@end
+
+@implementation CPSectionGeometryTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.descriptor = [[CPCollectionViewCellDescriptor alloc] initWithCellClass:[UICollectionViewCell class] cellDidReuseCallback:^(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewCell * _Nonnull cell, NSIndexPath * _Nonnull indexPath, __kindof NSObject * _Nullable data) {
+    } sizeForCellCallback:^CGSize(__kindof UICollectionView * _Nonnull collectionView, __kindof UICollectionViewLayout * _Nonnull layout, CPCollectionViewPreferredLayoutBlock  _Nonnull sizeByPreferredLayoutCalculator) {
+        return CGSizeMake(100, 50);
+    }];
+}
+
+#pragma mark - Fixtures
+
+- (NSArray<CPCollectionViewCellInfo *> *)cellInfosWithCount:(NSUInteger)count {
+    NSMutableArray *cellInfos = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [cellInfos addObject:[[CPCollectionViewCellInfo alloc] initWithDescriptor:self.descriptor data:@(i)]];
+    }
+    return cellInfos;
+}
+
+- (UICollectionView *)collectionViewWithSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    UICollectionView *collectionView = [[UICollectionView alloc] initWithFrame:CGRectMake(0, 0, 320, 480) collectionViewLayout:[UICollectionViewFlowLayout new]];
+    [collectionView cp_enableDataDrivenFlowLayout];
+    [collectionView cp_reloadWithSectionInfos:sectionInfos];
+    [collectionView layoutIfNeeded];
+    return collectionView;
+}
+
+- (void)assertGeometryOfCollectionView:(UICollectionView *)collectionView matchesSectionInfos:(NSArray<CPCollectionViewSectionInfo *> *)sectionInfos {
+    const CPCollectionViewSectionGeometry *geometry = [collectionView cp_sectionGeometry];
+    XCTAssertEqual(geometry->numberOfSections, (NSInteger)sectionInfos.count);
+    for (NSInteger section = 0; section < (NSInteger)sectionInfos.count; section++) {
+        CPCollectionViewSectionInfo *sectionInfo = sectionInfos[section];
+        XCTAssertEqual(geometry->numberOfItems[section], sectionInfo.numberOfItems);
+        XCTAssertEqual([collectionView.dataSource collectionView:collectionView numberOfItemsInSection:section], sectionInfo.numberOfItems);
+        XCTAssertTrue(UIEdgeInsetsEqualToEdgeInsets(geometry->sectionInsets[section], sectionInfo.sectionInset));
+        XCTAssertEqual(geometry->minimumLineSpacings[section], sectionInfo.minimumLineSpacing);
+        XCTAssertEqual(geometry->minimumInteritemSpacings[section], sectionInfo.minimumInteritemSpacing);
+    }
+}
+
+#pragma mark - Shared Section Infos
+
+- (void)testSectionInfoSharedByTwoCollectionViews {
+    CPCollectionViewSectionInfo *sharedSectionInfo = [[CPCollectionViewSectionInfo alloc] initWithCellInfos:[self cellInfosWithCount:3]];
+    CPCollectionViewSectionInfo *otherSectionInfo = [[CPCollectionViewSectionInfo alloc] initWithCellInfos:[self cellInfosWithCount:2]];
+    UICollectionView *collectionView = [self collectionViewWithSectionInfos:@[sharedSectionInfo]];
+    UICollectionView *otherCollectionView = [self collectionViewWithSectionInfos:@[otherSectionInfo, sharedSectionInfo]];
+
+    //both mirrors are built before the change, the one built last must not take the notifications of the other
+    [self assertGeometryOfCollectionView:collectionView matchesSectionInfos:@[sharedSectionInfo]];
+    [self assertGeometryOfCollectionView:otherCollectionView matchesSectionInfos:@[otherSectionInfo, sharedSectionInfo]];
+
+    [sharedSectionInfo cp_appendCellInfos:[self cellInfosWithCount:4]];
+    [self assertGeometryOfCollectionView:collectionView matchesSectionInfos:@[sharedSectionInfo]];
+    [self assertGeometryOfCollectionView:otherCollectionView matchesSectionInfos:@[otherSectionInfo, sharedSectionInfo]];
+
+    sharedSectionInfo.sectionInset = UIEdgeInsetsMake(10, 20, 30, 40);
+    sharedSectionInfo.minimumLineSpacing = 8;
+    sharedSectionInfo.minimumInteritemSpacing = 4;
+    [self assertGeometryOfCollectionView:collectionView matchesSectionInfos:@[sharedSectionInfo]];
+    [self assertGeometryOfCollectionView:otherCollectionView matchesSectionInfos:@[otherSectionInfo, sharedSectionInfo]];
+}
+
+- (void)testSectionInfoOutlivingACollectionView {
+    CPCollectionViewSectionInfo *sectionInfo = [[CPCollectionViewSectionInfo alloc] initWithCellInfos:[self cellInfosWithCount:3]];
+    @autoreleasepool {
+        UICollectionView *collectionView = [self collectionViewWithSectionInfos:@[sectionInfo]];
+        [self assertGeometryOfCollectionView:collectionView matchesSectionInfos:@[sectionInfo]];
+    }
+
+    UICollectionView *collectionView = [self collectionViewWithSectionInfos:@[sectionInfo]];
+    [self assertGeometryOfCollectionView:collectionView matchesSectionInfos:@[sectionInfo]];
+
+    [sectionInfo cp_appendCellInfos:[self cellInfosWithCount:2]];
+    [self assertGeometryOfCollectionView:collectionView matchesSectionInfos:@[sectionInfo]];
+}
+
+@end